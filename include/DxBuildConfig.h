@@ -55,6 +55,12 @@
 /* Disables the font backend. */
 /* #define DX_NON_FONT */
 
+/* Disables asynchronous loading, and the worker threads it uses. */
+/* #define DX_NON_ASYNCLOAD */
+
+/* Disables software images. */
+/* #define DX_NON_SOFTIMAGE */
+
 /* ------------------------------------------------------------------------
  * These are features not supported by DxPortLib at this time.
  * 
@@ -85,12 +91,6 @@
 /* Because we are always thread safe, this is not necessary. */
 /* #define DX_THREAD_SAFE_NETWORK_ONLY */
 
-/* Async loading is not supported. */
-#define DX_NON_ASYNCLOAD
-
-/* Software image management is not supported. */
-#define DX_NON_SOFTIMAGE
-
 /* Movie playback (and thus OGG Theora) is not supported. */
 #define DX_NON_MOVIE
 #define DX_NON_OGGTHEORA
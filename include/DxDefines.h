@@ -156,6 +156,31 @@ namespace DxLib {
 #define DX_BLENDMODE_PMA_ADD_X4         (22)
 #define DX_BLENDMODE_NUM                (23)
 
+/* Primitive types for DrawPrimitive2D. */
+#define DX_PRIMTYPE_POINTLIST           (1)
+#define DX_PRIMTYPE_LINELIST            (2)
+#define DX_PRIMTYPE_LINESTRIP           (3)
+#define DX_PRIMTYPE_TRIANGLELIST        (4)
+#define DX_PRIMTYPE_TRIANGLESTRIP       (5)
+#define DX_PRIMTYPE_TRIANGLEFAN         (6)
+
+typedef struct tagCOLOR_U8 {
+    unsigned char b, g, r, a;
+} COLOR_U8;
+
+typedef struct tagVECTOR {
+    float x, y, z;
+} VECTOR;
+
+/* Laid out the same as DxLib's. pos.z and rhw are ignored, and u/v
+ * go from 0 to 1 across the graph. */
+typedef struct tagVERTEX2D {
+    VECTOR pos;
+    float rhw;
+    COLOR_U8 dif;
+    float u, v;
+} VERTEX2D;
+
 /* Font types. Internally, we only do antialiasing though. */
 #define DX_FONTTYPE_NORMAL                      (0x00)
 #define DX_FONTTYPE_EDGE                        (0x01)
@@ -80,6 +80,42 @@ extern DXCALL int SetOutApplicationLogValidFlag(int logFlag);
 // - Sets the contents of flag to -1 when the handle is deleted.
 extern DXCALL int SetDeleteHandleFlag(int handleID, int *flag);
 
+#ifndef DX_NON_ASYNCLOAD
+// - Sets if graphs are loaded asynchronously.
+// When TRUE, LoadGraph and LoadDivGraph return their handles immediately,
+// and the image is decoded in the background. Until it has finished
+// loading, a handle draws nothing. Loads are finished off a few at
+// a time in ProcessMessage, so keep calling it.
+extern DXCALL int SetUseASyncLoadFlag(int flag);
+
+// - Gets if graphs are loaded asynchronously.
+extern DXCALL int GetUseASyncLoadFlag();
+
+// - Returns TRUE if the handle is still loading, FALSE once it has loaded,
+//   or -1 if loading it failed.
+// NOTICE: A handle that failed to load stays valid, but draws nothing,
+//   until it is deleted.
+extern DXCALL int CheckHandleASyncLoad(int handle);
+
+// - Waits until the handle has finished loading.
+//   Returns -1 if loading it failed.
+extern DXCALL int WaitHandleASyncLoad(int handle);
+
+// - Gets the number of handles still loading.
+extern DXCALL int GetASyncLoadNum();
+
+// - DxPortLib Extension. Sets how long ProcessMessage may spend
+// finishing asynchronous loads each frame, in milliseconds.
+// At least one is always finished if one is ready. Defaults to 2.
+extern DXCALL int EXT_SetASyncLoadTimeBudget(int milliseconds);
+
+// - DxPortLib Extension. Sets if asynchronous loads upload their textures
+// on a thread of their own, through a second OpenGL context, instead of
+// in ProcessMessage. Must be set before DxLib_Init.
+// Requires fence sync support; without it, this has no effect.
+extern DXCALL int EXT_SetUseLoaderThreadFlag(int flag);
+#endif /* #ifndef DX_NON_ASYNCLOAD */
+
 // - Sets the default character set used.
 // DxPortLib uses UTF8 by default.
 // It is highly recommended to build your application to use UTF8.
@@ -315,6 +351,45 @@ extern DXCALL int LoadReverseDivGraph(
                           int xCount, int yCount, int xSize, int ySize,
                           int *handleBuf);
 
+// - Makes a graph from an image file that is already in memory.
+// The image is decoded straight out of fileImage, which is not kept
+// after this returns. This always loads synchronously.
+// NOTICE: alphaFileImage is not supported, and is ignored.
+//         textureFlag is ignored.
+extern DXCALL int CreateGraphFromMem(const void *fileImage, int fileImageSize,
+                                     const void *alphaFileImage = NULL,
+                                     int alphaFileImageSize = 0,
+                                     int textureFlag = DXTRUE,
+                                     int reverseFlag = DXFALSE);
+
+// - DxPortLib Extension.
+//   Loads an atlas made by dxatlaspack, and returns a handle for it.
+//   Every sprite in it is made into a graph right away; get them by
+//   name with EXT_GetAtlasGraph. This is much faster than LoadDivGraph,
+//   as there is no image to decode. Always loads synchronously, and
+//   the transparent color is not applied.
+extern DXCALL int EXT_LoadAtlas(const DXCHAR *filename);
+// - DxPortLib Extension.
+//   Gets the graph for the sprite called name, which is its PNG's
+//   filename without the extension. Returns -1 if there isn't one.
+extern DXCALL int EXT_GetAtlasGraph(int atlasHandle, const DXCHAR *name);
+// - DxPortLib Extension.
+//   Deletes an atlas handle. Its graphs are NOT deleted; as they all
+//   share with each other, DeleteSharingGraph on any of them does that.
+extern DXCALL int EXT_DeleteAtlas(int atlasHandle);
+
+// - DxPortLib Extension.
+//   Loads every file in files, decoding them all at once on the
+//   asynchronous loading threads, and waits for them to finish.
+//   This works whether or not SetUseASyncLoadFlag is on.
+//   The files are decoded on up to one thread per CPU core, at most 16;
+//   ordinary asynchronous loads use at most 4, leaving a core free.
+//   Handles are stored in handles, in the same order; a file that
+//   could not be loaded gets -1. Returns the number that failed.
+//   If loadTime is given, the time taken in milliseconds is put in it.
+extern DXCALL int EXT_LoadGraphBatch(const DXCHAR **files, int count,
+                                     int *handles, int *loadTime = NULL);
+
 // - Deletes a Graph handle.
 extern DXCALL int DeleteGraph(int graphID);
 // - Deletes all graph handles that were based on the same graph as this.
@@ -335,6 +410,50 @@ extern DXCALL int DerivationGraph(int x, int y, int w, int h,
 //   width and height.
 extern DXCALL int GetGraphSize(int graphID, int *width, int *height);
 
+// - Changes one color in the palette of an 8-bit graph. The change
+//   shows up the next time the graph is drawn, and is shared by all
+//   graphs derived from the same image.
+// NOTICE: Only 8-bit images loaded with the OpenGL renderer keep their
+//   palette. Fails for anything else.
+extern DXCALL int SetGraphPalette(int graphID, int colorIndex, DXCOLOR color);
+// - Gets one color of the palette of an 8-bit graph.
+extern DXCALL int GetGraphPalette(int graphID, int colorIndex,
+                                  int *red, int *green, int *blue);
+// - Gets one color of the palette of an 8-bit graph, as it was loaded.
+extern DXCALL int GetGraphOriginalPalette(int graphID, int colorIndex,
+                                          int *red, int *green, int *blue);
+// - Puts the palette of an 8-bit graph back to how it was loaded.
+extern DXCALL int ResetGraphPalette(int graphID);
+
+// - Copies (x1,y1)-(x2,y2) of the current draw screen into graphID.
+// The copy is done on the GPU, without reading the screen back.
+// useClientFlag is ignored.
+extern DXCALL int GetDrawScreenGraph(int x1, int y1, int x2, int y2,
+                                     int graphID, int useClientFlag = DXTRUE);
+// - Copies (x1,y1)-(x2,y2) of a screen graph made with MakeScreen
+//   into destGraphID at (destX,destY), on the GPU.
+extern DXCALL int BltDrawValidGraph(int srcGraphID,
+                                    int x1, int y1, int x2, int y2,
+                                    int destX, int destY, int destGraphID);
+
+// - Gets the color at (x,y) of the current draw screen, in the same
+//   format as GetColor. Returns 0xffffffff if it is off the screen.
+// NOTICE: Unless the point was requested with EXT_RequestPixelRegion
+//   last frame, this waits for the GPU to finish drawing.
+extern DXCALL DXCOLOR GetPixel(int x, int y);
+// - DxPortLib Extension.
+//   Same as GetPixel, for all of (x1,y1)-(x2,y2) at once. colors must
+//   hold (x2-x1)*(y2-y1) entries, filled in row by row.
+extern DXCALL int EXT_GetPixelRegion(int x1, int y1, int x2, int y2,
+                                     DXCOLOR *colors);
+// - DxPortLib Extension.
+//   Asks for (x1,y1)-(x2,y2) of the back screen to be read back at the
+//   next ScreenFlip. During the frame after that, GetPixel and
+//   EXT_GetPixelRegion within it return what was on screen at the flip,
+//   without waiting on the GPU. Requests only last one frame, and up to
+//   32 can be made per frame.
+extern DXCALL int EXT_RequestPixelRegion(int x1, int y1, int x2, int y2);
+
 // - Sets the transparent color key to be used when loading images.
 // NOTICE: This is not valid after the image has been loaded.
 extern DXCALL int SetTransColor(int r, int g, int b);
@@ -344,6 +463,49 @@ extern DXCALL int GetTransColor(int *r, int *g, int *b);
 // Default is TRUE.
 extern DXCALL int SetUseTransColor(int flag);
 
+// - Sets the color depth of images loaded after this, either 16 or 32.
+//   At 16, images are stored as RGB565, RGBA5551 or RGBA4444 depending
+//   on their alpha channel, which halves their video memory use.
+//   0 (the default) follows the color depth passed to SetGraphMode.
+extern DXCALL int SetGraphColorBitDepth(int colorBitDepth);
+// - Gets the color depth images are currently loaded with.
+extern DXCALL int GetGraphColorBitDepth();
+// - DxPortLib Extension.
+//   TRUE if images loaded at 16-bit should be dithered, which hides
+//   banding in gradients. Default is FALSE.
+extern DXCALL int EXT_SetGraphDitherFlag(int flag);
+
+// - DxPortLib Extension.
+//   Images loaded after this that are wider or taller than size are
+//   split into tiles, which are only uploaded to the GPU while they are
+//   being drawn. Images too big for the GPU are always tiled.
+//   Tiled graphs work with DrawGraph, DrawExtendGraph, DrawRectGraph,
+//   DrawTurnGraph and the DrawRotaGraph family, but not with
+//   DrawModiGraph, DrawPrimitive2D or particle systems.
+//   A size of 0 (the default) only tiles images too big for the GPU.
+extern DXCALL int EXT_SetTiledGraphThreshold(int size);
+
+// - DxPortLib Extension.
+//   Images loaded after this are cached in directory, already decoded
+//   and converted, so loading them again on the next run skips the
+//   decoding. Entries are checked against the image file itself, so a
+//   changed image is decoded again. The directory must already exist,
+//   e.g. one from SDL_GetPrefPath. NULL (the default) turns it off.
+//   NOTICE: Cached images are stored uncompressed.
+extern DXCALL int EXT_SetGraphCacheDirectory(const DXCHAR *directory);
+
+// - DxPortLib Extension.
+//   If TRUE, loading an image that is already loaded, with the same
+//   settings, returns a new graph for the texture already there rather
+//   than loading it again. Filenames are compared as given, except
+//   that / and \ count as the same.
+//   NOTICE: Graphs sharing a texture also share its pixels and palette,
+//   so SetPaletteGraph, GetDrawScreenGraph, BltDrawValidGraph or
+//   ReCreateGraphFromSoftImage on one changes the others. Once one
+//   has been changed, later loads of the file load it afresh.
+//   Default is FALSE.
+extern DXCALL int EXT_SetShareLoadedGraphFlag(int flag);
+
 // NOTICE: For all drawing functions, the following applies:
 // - FillFlag, if TRUE, will draw a solid. Otherwise, edges only.
 // - blendFlag, if TRUE, draws with blending enabled.
@@ -384,6 +546,23 @@ extern DXCALL int DrawOval(int x, int y, int rx, int ry,
 extern DXCALL int DrawOvalF(float x, float y, float rx, float ry,
                             DXCOLOR color, int fillFlag);
 
+// - Anti-aliased versions of the above, plus rounded boxes.
+//   Fills are drawn as a few textured quads no matter the size, and
+//   outlines use posnum segments all the way around.
+//   DrawLineAA draws lines with round caps.
+extern DXCALL int DrawCircleAA(float x, float y, float r, int posnum,
+                               DXCOLOR color, int fillFlag = DXTRUE,
+                               float lineThickness = 1.0f);
+extern DXCALL int DrawOvalAA(float x, float y, float rx, float ry, int posnum,
+                             DXCOLOR color, int fillFlag = DXTRUE,
+                             float lineThickness = 1.0f);
+extern DXCALL int DrawLineAA(float x1, float y1, float x2, float y2,
+                             DXCOLOR color, float thickness = 1.0f);
+extern DXCALL int DrawRoundRectAA(float x1, float y1, float x2, float y2,
+                                  float rx, float ry, int posnum,
+                                  DXCOLOR color, int fillFlag = DXTRUE,
+                                  float lineThickness = 1.0f);
+
 // - Draws a triangle at the given coordinates.
 extern DXCALL int DrawTriangle(int x1, int y1, int x2, int y2,
                                int x3, int y3,
@@ -506,9 +685,96 @@ extern DXCALL int DrawModiGraphF(float x1, float y1, float x2, float y2,
                                  float x3, float y3, float x4, float y4,
                                  int graphID, int blendFlag);
 
+// - Draws user supplied vertices, with the graph mapped by u/v.
+//   Use DX_NONE_GRAPH to draw with vertex colors only.
+//   Polygon versions draw polygonNum triangles.
+//   Everything with the same graph and blend flag is batched together,
+//   including strips and fans.
+extern DXCALL int DrawPolygon2D(const VERTEX2D *vertexArray, int polygonNum,
+                                int graphID, int blendFlag);
+extern DXCALL int DrawPrimitive2D(const VERTEX2D *vertexArray, int vertexNum,
+                                  int primitiveType, int graphID, int blendFlag);
+extern DXCALL int DrawPolygonIndexed2D(const VERTEX2D *vertexArray, int vertexNum,
+                                       const unsigned short *indexArray, int polygonNum,
+                                       int graphID, int blendFlag);
+extern DXCALL int DrawPrimitiveIndexed2D(const VERTEX2D *vertexArray, int vertexNum,
+                                         const unsigned short *indexArray, int indexNum,
+                                         int primitiveType, int graphID, int blendFlag);
+
 // - Clips the drawable area of the screen to (x1, y1, x2, y2).
 extern DXCALL int SetDrawArea(int x1, int y1, int x2, int y2);
 
+// - DxPortLib Extension.
+//   If true, SetDrawArea no longer flushes the draw batch; sprites and
+//   filled boxes are clipped to the draw area as they are drawn, so that
+//   changing the area often (e.g. per UI panel) stays in one batch.
+//   Anything else drawn after a change still waits for the scissor.
+//   Defaults to false.
+extern DXCALL int EXT_SetUseCPUClipFlag(int flag);
+
+// - DxPortLib Extension.
+//   Draws that land entirely outside of the draw area are skipped
+//   before they reach the renderer. Returns how many have been skipped,
+//   and if resetFlag is set, starts counting again from zero.
+extern DXCALL int EXT_GetCulledDrawCount(int resetFlag = DXFALSE);
+
+// - DxPortLib Extension.
+//   A 2D transform applied to everything drawn, e.g. for a camera.
+//   Each point is drawn at (a*x + c*y + tx, b*x + d*y + ty).
+//   Translate/Scale/Rotate apply before the current transform, so they
+//   are called in the order you would call them on a camera:
+//     EXT_TranslateTransform(screenCenterX, screenCenterY);
+//     EXT_RotateTransform(angle);
+//     EXT_ScaleTransform(zoom, zoom);
+//     EXT_TranslateTransform(-cameraX, -cameraY);
+//   Changing the transform ends the current draw batch, but draws
+//   themselves cost nothing extra. Push/Pop save and restore up to 16
+//   transforms.
+extern DXCALL int EXT_PushTransform();
+extern DXCALL int EXT_PopTransform();
+extern DXCALL int EXT_SetTransform(float a, float b, float c, float d,
+                                   float tx, float ty);
+extern DXCALL int EXT_ResetTransform();
+extern DXCALL int EXT_TranslateTransform(float x, float y);
+extern DXCALL int EXT_ScaleTransform(float xScale, float yScale);
+extern DXCALL int EXT_RotateTransform(float angle);
+
+// - DxPortLib Extension.
+//   If true, opaque sprites and filled boxes (DX_BLENDMODE_NOBLEND, and
+//   a graph with no alpha channel) are held back and drawn front to back
+//   with a depth buffer, so anything covered by a later opaque draw is
+//   never shaded. This helps with stacked full-screen backgrounds on
+//   fill-rate bound GPUs. What ends up on screen is unchanged.
+//   Defaults to false.
+extern DXCALL int EXT_SetUseOpaqueLayerFlag(int flag);
+
+// - DxPortLib Extension.
+//   If true, the back screen is drawn at a lower resolution when the GPU
+//   can't keep up, and stretched to the window at ScreenFlip. The scale
+//   is picked every frame from measured GPU time, to stay within
+//   targetMilliseconds per frame, and kept between minScale and maxScale
+//   (at most 1.0). Draw coordinates are not affected.
+//   Screens should be cleared every frame while this is on, and
+//   GetDrawScreenGraph of the back screen fails while it is scaled down.
+//   Requires timer query support; returns -1 if it is not available.
+//   Defaults to false, with a range of 0.5 to 1.0 and a 16ms target.
+extern DXCALL int EXT_SetDynamicResolutionFlag(int flag);
+extern DXCALL int EXT_SetDynamicResolutionRange(float minScale, float maxScale,
+                                                float targetMilliseconds = 16.0f);
+extern DXCALL float EXT_GetDynamicResolutionScale();
+
+// - DxPortLib Extension.
+//   Limits how many frames the GPU may be behind by, from 1 to 3.
+//   Lower values cut input latency, higher values keep the GPU busier.
+//   At 1, ScreenFlip waits until the frame has been drawn.
+//   0 (the default) leaves it up to the driver.
+//   Requires fence sync support; returns -1 if it is not available.
+extern DXCALL int EXT_SetMaxFramesInFlight(int count);
+// - DxPortLib Extension.
+//   Gets the average time, in milliseconds, from ScreenFlip to the GPU
+//   finishing that frame. 0 if it can't be measured.
+extern DXCALL float EXT_GetPresentLatency();
+
 // - Sets the current texture filtering mode from DX_DRAWMODE_*
 extern DXCALL int SetDrawMode(int drawMode);
 extern DXCALL int GetDrawMode();
@@ -553,6 +819,105 @@ extern DXCALL int SaveDrawScreenToPNG(int x1, int y1, int x2, int y2,
 // - Given the three RGB components, returns a color value.
 extern DXCALL DXCOLOR GetColor(int red, int green, int blue);
 
+// ------ Particle systems
+
+// - DxPortLib Extension.
+//   Creates a particle system that holds up to maxParticles particles,
+//   all of which draw graphID centered on their position.
+extern DXCALL int EXT_MakeParticleSystem(int graphID, int maxParticles);
+// - DxPortLib Extension.
+//   Deletes a particle system handle.
+extern DXCALL int EXT_DeleteParticleSystem(int particleHandle);
+// - DxPortLib Extension.
+//   Sets the acceleration applied to every particle, in pixels/second^2.
+extern DXCALL int EXT_SetParticleSystemGravity(int particleHandle,
+                                               float gravityX, float gravityY);
+// - DxPortLib Extension.
+//   Sets the scale every particle's graph is drawn at. Default is 1.0.
+extern DXCALL int EXT_SetParticleSystemScale(int particleHandle, float scale);
+// - DxPortLib Extension.
+//   Adds a particle at (x,y) moving at (vx,vy) pixels/second, that lives
+//   for lifetime seconds. Returns -1 if the system is full.
+extern DXCALL int EXT_EmitParticle(int particleHandle,
+                                   float x, float y, float vx, float vy,
+                                   float lifetime,
+                                   DXCOLOR color, int alpha = 255);
+// - DxPortLib Extension.
+//   Moves all particles forward by deltaTime seconds, removing any
+//   that have expired.
+extern DXCALL int EXT_UpdateParticleSystem(int particleHandle, float deltaTime);
+// - DxPortLib Extension.
+//   Draws all live particles, using the current blend mode and bright.
+extern DXCALL int EXT_DrawParticleSystem(int particleHandle, int blendFlag);
+// - DxPortLib Extension.
+//   Gets the number of live particles in the system.
+extern DXCALL int EXT_GetParticleNum(int particleHandle);
+
+// -------------------------------------------------------- DxSoftImage.cpp
+#ifndef DX_NON_SOFTIMAGE
+
+// NOTICE: Soft images are always 32-bit. The palette and 16-bit
+//         formats of DxLib are not supported.
+
+// - Makes a new soft image with an alpha channel, cleared to transparent.
+extern DXCALL int MakeSoftImage(int sizeX, int sizeY);
+// - Makes a new soft image with an alpha channel.
+extern DXCALL int MakeARGB8ColorSoftImage(int sizeX, int sizeY);
+// - Makes a new soft image without an alpha channel, cleared to black.
+//   Its alpha is always 255.
+extern DXCALL int MakeXRGB8ColorSoftImage(int sizeX, int sizeY);
+// - Loads an image file into a new soft image.
+extern DXCALL int LoadSoftImage(const DXCHAR *filename);
+// - Deletes a soft image handle.
+extern DXCALL int DeleteSoftImage(int softImageHandle);
+// - Deletes ALL soft image handles.
+extern DXCALL int InitSoftImage();
+
+// - Gets the size of a soft image.
+extern DXCALL int GetSoftImageSize(int softImageHandle, int *width, int *height);
+// - Gets the soft image's pixels, as rows of ARGB8888 pixels.
+//   Each row starts GetPitchSoftImage bytes after the last.
+extern DXCALL void * GetImageAddressSoftImage(int softImageHandle);
+// - Gets the number of bytes from one row of pixels to the next.
+extern DXCALL int GetPitchSoftImage(int softImageHandle);
+
+// - Gets the color of one pixel. Any of r, g, b, a may be NULL.
+extern DXCALL int GetPixelSoftImage(int softImageHandle, int x, int y,
+                                    int *r, int *g, int *b, int *a);
+// - Sets the color of one pixel.
+extern DXCALL int DrawPixelSoftImage(int softImageHandle, int x, int y,
+                                     int r, int g, int b, int a);
+// - Fills the whole soft image with a color.
+extern DXCALL int FillSoftImage(int softImageHandle, int r, int g, int b, int a);
+// - Clears part of a soft image to transparent black.
+extern DXCALL int ClearRectSoftImage(int softImageHandle, int x, int y, int w, int h);
+
+// - Copies part of one soft image onto another, alpha included.
+extern DXCALL int BltSoftImage(int srcX, int srcY, int srcSizeX, int srcSizeY,
+                               int srcSoftImageHandle,
+                               int destX, int destY, int destSoftImageHandle);
+// - Draws part of one soft image over another, using its alpha channel
+//   scaled by opacity (0-255).
+extern DXCALL int BltSoftImageWithAlphaBlend(int srcX, int srcY,
+                                             int srcSizeX, int srcSizeY,
+                                             int srcSoftImageHandle,
+                                             int destX, int destY,
+                                             int destSoftImageHandle,
+                                             int opacity = 255);
+
+// - Makes a new graph from a soft image.
+extern DXCALL int CreateGraphFromSoftImage(int softImageHandle);
+// - Replaces a graph's image with a soft image's.
+//   The graph must be the same size as the soft image.
+extern DXCALL int ReCreateGraphFromSoftImage(int softImageHandle, int graphHandle);
+
+// - Saves a soft image as a PNG.
+// NOTICE: compressionLevel is ignored.
+extern DXCALL int SaveSoftImageToPng(const DXCHAR *filename, int softImageHandle,
+                                     int compressionLevel);
+
+#endif /* #ifndef DX_NON_SOFTIMAGE */
+
 // ------------------------------------------------------------- DxFont.cpp
 #ifndef DX_NON_FONT
 
@@ -570,6 +935,19 @@ extern DXCALL int EXT_MapFontFileToName(const DXCHAR *filename,
                                         double exRateY = 1.0
                                         );
 // - DxPortLib Extension.
+//   The same as EXT_MapFontFileToName, but for a .ttf that is already
+//   in memory. It is read straight out of fileImage, which is not
+//   copied, so keep it around until the mapping and every font handle
+//   made from it are gone.
+extern DXCALL int EXT_MapFontMemToName(const void *fileImage,
+                                       int fileImageSize,
+                                       const DXCHAR *fontname,
+                                       int thickness,
+                                       int boldFlag,
+                                       double exRateX = 1.0,
+                                       double exRateY = 1.0
+                                       );
+// - DxPortLib Extension.
 //   Deletes all existing font mappings.
 //   Will not delete font handles.
 extern DXCALL int EXT_InitFontMappings();
@@ -755,6 +1133,11 @@ extern DXCALL int LoadSoundMem(const DXCHAR *filename);
 // If this is played with DX_PLAYTYPE_LOP, only the second part will loop.
 extern DXCALL int LoadSoundMem2(const DXCHAR *filename,
                                 const DXCHAR *filename2);
+// - Loads a sound file that is already in memory, without copying it.
+// WAV files are loaded whole, but OGG files are streamed from
+// fileImage, so keep it around until the handle is deleted.
+extern DXCALL int LoadSoundMemByMemImage(const void *fileImage,
+                                         int fileImageSize);
 
 // - Deletes a sound handle.
 extern DXCALL int DeleteSoundMem(int soundID);
@@ -59,6 +59,16 @@ extern DXCALL int DxLib_SetOutApplicationLogValidFlag(int logFlag);
 
 extern DXCALL int DxLib_SetDeleteHandleFlag(int handleID, int *flag);
 
+#ifndef DX_NON_ASYNCLOAD
+extern DXCALL int DxLib_SetUseASyncLoadFlag(int flag);
+extern DXCALL int DxLib_GetUseASyncLoadFlag();
+extern DXCALL int DxLib_CheckHandleASyncLoad(int handle);
+extern DXCALL int DxLib_WaitHandleASyncLoad(int handle);
+extern DXCALL int DxLib_GetASyncLoadNum();
+extern DXCALL int DxLib_EXT_SetASyncLoadTimeBudget(int milliseconds);
+extern DXCALL int DxLib_EXT_SetUseLoaderThreadFlag(int flag);
+#endif /* #ifndef DX_NON_ASYNCLOAD */
+
 extern DXCALL int DxLib_SetUseCharSet(int charset);
 
 /* ----------------------------------------------------------- DxFile.cpp */
@@ -180,6 +190,15 @@ extern DXCALL int DxLib_LoadReverseDivGraph(
                           const DXCHAR *filename, int graphCount,
                           int xCount, int yCount, int xSize, int ySize,
                           int *handleBuf);
+extern DXCALL int DxLib_CreateGraphFromMem(const void *fileImage, int fileImageSize,
+                                           const void *alphaFileImage,
+                                           int alphaFileImageSize,
+                                           int textureFlag, int reverseFlag);
+extern DXCALL int DxLib_EXT_LoadAtlas(const DXCHAR *filename);
+extern DXCALL int DxLib_EXT_GetAtlasGraph(int atlasHandle, const DXCHAR *name);
+extern DXCALL int DxLib_EXT_DeleteAtlas(int atlasHandle);
+extern DXCALL int DxLib_EXT_LoadGraphBatch(const DXCHAR **files, int count,
+                                           int *handles, int *loadTime);
 extern DXCALL int DxLib_DeleteGraph(int graphID);
 extern DXCALL int DxLib_DeleteSharingGraph(int graphID);
 extern DXCALL int DxLib_InitGraph();
@@ -189,9 +208,32 @@ extern DXCALL int DxLib_GetGraphNum();
 
 extern DXCALL int DxLib_GetGraphSize(int graphID, int *width, int *height);
 
+extern DXCALL int DxLib_SetGraphPalette(int graphID, int colorIndex, DXCOLOR color);
+extern DXCALL int DxLib_GetGraphPalette(int graphID, int colorIndex,
+                                        int *red, int *green, int *blue);
+extern DXCALL int DxLib_GetGraphOriginalPalette(int graphID, int colorIndex,
+                                                int *red, int *green, int *blue);
+extern DXCALL int DxLib_ResetGraphPalette(int graphID);
+
+extern DXCALL int DxLib_GetDrawScreenGraph(int x1, int y1, int x2, int y2,
+                                           int graphID, int useClientFlag);
+extern DXCALL int DxLib_BltDrawValidGraph(int srcGraphID,
+                                          int x1, int y1, int x2, int y2,
+                                          int destX, int destY, int destGraphID);
+extern DXCALL DXCOLOR DxLib_GetPixel(int x, int y);
+extern DXCALL int DxLib_EXT_GetPixelRegion(int x1, int y1, int x2, int y2,
+                                           DXCOLOR *colors);
+extern DXCALL int DxLib_EXT_RequestPixelRegion(int x1, int y1, int x2, int y2);
+
 extern DXCALL int DxLib_SetTransColor(int r, int g, int b);
 extern DXCALL int DxLib_GetTransColor(int *r, int *g, int *b);
 extern DXCALL int DxLib_SetUseTransColor(int flag);
+extern DXCALL int DxLib_SetGraphColorBitDepth(int colorBitDepth);
+extern DXCALL int DxLib_GetGraphColorBitDepth();
+extern DXCALL int DxLib_EXT_SetGraphDitherFlag(int flag);
+extern DXCALL int DxLib_EXT_SetTiledGraphThreshold(int size);
+extern DXCALL int DxLib_EXT_SetGraphCacheDirectory(const DXCHAR *directory);
+extern DXCALL int DxLib_EXT_SetShareLoadedGraphFlag(int flag);
 
 extern DXCALL int DxLib_DrawPixel(int x, int y, DXCOLOR color);
 
@@ -222,6 +264,19 @@ extern DXCALL int DxLib_DrawOval(int x, int y, int rx, int ry,
 extern DXCALL int DxLib_DrawOvalF(float x, float y, float rx, float ry,
                                   DXCOLOR color, int fillFlag);
 
+extern DXCALL int DxLib_DrawCircleAA(float x, float y, float r, int posnum,
+                                     DXCOLOR color, int fillFlag,
+                                     float lineThickness);
+extern DXCALL int DxLib_DrawOvalAA(float x, float y, float rx, float ry, int posnum,
+                                   DXCOLOR color, int fillFlag,
+                                   float lineThickness);
+extern DXCALL int DxLib_DrawLineAA(float x1, float y1, float x2, float y2,
+                                   DXCOLOR color, float thickness);
+extern DXCALL int DxLib_DrawRoundRectAA(float x1, float y1, float x2, float y2,
+                                        float rx, float ry, int posnum,
+                                        DXCOLOR color, int fillFlag,
+                                        float lineThickness);
+
 extern DXCALL int DxLib_DrawTriangle(int x1, int y1, int x2, int y2,
                                      int x3, int y3,
                                      DXCOLOR color, int fillFlag);
@@ -344,7 +399,35 @@ extern DXCALL int DxLib_DrawModiGraphF(float x1, float y1, float x2, float y2,
                                        float x3, float y3, float x4, float y4,
                                        int graphID, int blendFlag);
 
+extern DXCALL int DxLib_DrawPolygon2D(const VERTEX2D *vertexArray, int polygonNum,
+                                      int graphID, int blendFlag);
+extern DXCALL int DxLib_DrawPrimitive2D(const VERTEX2D *vertexArray, int vertexNum,
+                                        int primitiveType, int graphID, int blendFlag);
+extern DXCALL int DxLib_DrawPolygonIndexed2D(const VERTEX2D *vertexArray, int vertexNum,
+                                             const unsigned short *indexArray, int polygonNum,
+                                             int graphID, int blendFlag);
+extern DXCALL int DxLib_DrawPrimitiveIndexed2D(const VERTEX2D *vertexArray, int vertexNum,
+                                               const unsigned short *indexArray, int indexNum,
+                                               int primitiveType, int graphID, int blendFlag);
+
 extern DXCALL int DxLib_SetDrawArea(int x1, int y1, int x2, int y2);
+extern DXCALL int DxLib_EXT_SetUseCPUClipFlag(int flag);
+extern DXCALL int DxLib_EXT_GetCulledDrawCount(int resetFlag);
+extern DXCALL int DxLib_EXT_PushTransform();
+extern DXCALL int DxLib_EXT_PopTransform();
+extern DXCALL int DxLib_EXT_SetTransform(float a, float b, float c, float d,
+                                         float tx, float ty);
+extern DXCALL int DxLib_EXT_ResetTransform();
+extern DXCALL int DxLib_EXT_TranslateTransform(float x, float y);
+extern DXCALL int DxLib_EXT_ScaleTransform(float xScale, float yScale);
+extern DXCALL int DxLib_EXT_RotateTransform(float angle);
+extern DXCALL int DxLib_EXT_SetUseOpaqueLayerFlag(int flag);
+extern DXCALL int DxLib_EXT_SetDynamicResolutionFlag(int flag);
+extern DXCALL int DxLib_EXT_SetDynamicResolutionRange(float minScale, float maxScale,
+                                                      float targetMilliseconds);
+extern DXCALL float DxLib_EXT_GetDynamicResolutionScale();
+extern DXCALL int DxLib_EXT_SetMaxFramesInFlight(int count);
+extern DXCALL float DxLib_EXT_GetPresentLatency();
 
 extern DXCALL int DxLib_SetDrawMode(int drawMode);
 extern DXCALL int DxLib_GetDrawMode();
@@ -375,6 +458,59 @@ extern DXCALL int DxLib_SaveDrawScreenToPNG(int x1, int y1, int x2, int y2,
 
 extern DXCALL DXCOLOR DxLib_GetColor(int red, int green, int blue);
 
+extern DXCALL int DxLib_EXT_MakeParticleSystem(int graphID, int maxParticles);
+extern DXCALL int DxLib_EXT_DeleteParticleSystem(int particleHandle);
+extern DXCALL int DxLib_EXT_SetParticleSystemGravity(int particleHandle,
+                                                     float gravityX, float gravityY);
+extern DXCALL int DxLib_EXT_SetParticleSystemScale(int particleHandle, float scale);
+extern DXCALL int DxLib_EXT_EmitParticle(int particleHandle,
+                                         float x, float y, float vx, float vy,
+                                         float lifetime,
+                                         DXCOLOR color, int alpha);
+extern DXCALL int DxLib_EXT_UpdateParticleSystem(int particleHandle, float deltaTime);
+extern DXCALL int DxLib_EXT_DrawParticleSystem(int particleHandle, int blendFlag);
+extern DXCALL int DxLib_EXT_GetParticleNum(int particleHandle);
+
+/* ------------------------------------------------------ DxSoftImage.cpp */
+#ifndef DX_NON_SOFTIMAGE
+
+extern DXCALL int DxLib_MakeSoftImage(int sizeX, int sizeY);
+extern DXCALL int DxLib_MakeARGB8ColorSoftImage(int sizeX, int sizeY);
+extern DXCALL int DxLib_MakeXRGB8ColorSoftImage(int sizeX, int sizeY);
+extern DXCALL int DxLib_LoadSoftImage(const DXCHAR *filename);
+extern DXCALL int DxLib_DeleteSoftImage(int softImageHandle);
+extern DXCALL int DxLib_InitSoftImage();
+
+extern DXCALL int DxLib_GetSoftImageSize(int softImageHandle, int *width, int *height);
+extern DXCALL void *DxLib_GetImageAddressSoftImage(int softImageHandle);
+extern DXCALL int DxLib_GetPitchSoftImage(int softImageHandle);
+
+extern DXCALL int DxLib_GetPixelSoftImage(int softImageHandle, int x, int y,
+                                          int *r, int *g, int *b, int *a);
+extern DXCALL int DxLib_DrawPixelSoftImage(int softImageHandle, int x, int y,
+                                           int r, int g, int b, int a);
+extern DXCALL int DxLib_FillSoftImage(int softImageHandle, int r, int g, int b, int a);
+extern DXCALL int DxLib_ClearRectSoftImage(int softImageHandle,
+                                           int x, int y, int w, int h);
+
+extern DXCALL int DxLib_BltSoftImage(int srcX, int srcY, int srcSizeX, int srcSizeY,
+                                     int srcSoftImageHandle,
+                                     int destX, int destY, int destSoftImageHandle);
+extern DXCALL int DxLib_BltSoftImageWithAlphaBlend(int srcX, int srcY,
+                                                   int srcSizeX, int srcSizeY,
+                                                   int srcSoftImageHandle,
+                                                   int destX, int destY,
+                                                   int destSoftImageHandle,
+                                                   int opacity);
+
+extern DXCALL int DxLib_CreateGraphFromSoftImage(int softImageHandle);
+extern DXCALL int DxLib_ReCreateGraphFromSoftImage(int softImageHandle, int graphHandle);
+
+extern DXCALL int DxLib_SaveSoftImageToPng(const DXCHAR *filename, int softImageHandle,
+                                           int compressionLevel);
+
+#endif /* #ifndef DX_NON_SOFTIMAGE */
+
 /* ----------------------------------------------------------- DxFont.cpp */
 #ifndef DX_NON_FONT
 
@@ -385,6 +521,14 @@ extern DXCALL int DxLib_EXT_MapFontFileToName(const DXCHAR *filename,
                                               double exRateX,
                                               double exRateY
                                              );
+extern DXCALL int DxLib_EXT_MapFontMemToName(const void *fileImage,
+                                             int fileImageSize,
+                                             const DXCHAR *fontname,
+                                             int thickness,
+                                             int boldFlag,
+                                             double exRateX,
+                                             double exRateY
+                                            );
 extern DXCALL int DxLib_EXT_InitFontMappings();
 
 /* Handle font functions */
@@ -507,6 +651,8 @@ extern DXCALL int DxLib_SetUseOldVolumeCalcFlag(int volumeFlag);
 extern DXCALL int DxLib_LoadSoundMem(const DXCHAR *filename);
 extern DXCALL int DxLib_LoadSoundMem2(const DXCHAR *filename,
                                       const DXCHAR *filename2);
+extern DXCALL int DxLib_LoadSoundMemByMemImage(const void *fileImage,
+                                               int fileImageSize);
 extern DXCALL int DxLib_DeleteSoundMem(int soundID);
 
 extern DXCALL int DxLib_InitSoundMem();
@@ -0,0 +1,596 @@
+/*
+  DxPortLib - A portability library for DxLib-based software.
+  Copyright (C) 2013 Patrick McCarthy <mauve@sandwich.net>
+  
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+  
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+    
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required. 
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include "DxInternal.h"
+
+#ifndef DX_NON_ASYNCLOAD
+
+/* Asynchronous loading.
+ *
+ * Like DxLib, a load started with the async flag set hands back its
+ * handle right away. The expensive CPU part of the load (decoding,
+ * conversion) is done by a small pool of worker threads, and whatever
+ * has to touch the renderer is finished later on the main thread, a few
+ * jobs at a time, from ProcessMessage.
+ *
+ * Each job keeps the list of handles waiting on it. Those only ever
+ * change on the main thread, so only the job's state needs the lock.
+ *
+ * With a loader context (EXT_SetUseLoaderThreadFlag), there is also an
+ * upload thread that makes it current, and does the renderer's part of
+ * the job as well, leaving the main thread only the bookkeeping.
+ *
+ * If the worker threads can't be started, jobs are just run on the
+ * spot, which is the same as loading synchronously.
+ *
+ * Handles whose load failed are remembered until they're deleted,
+ * so CheckHandleASyncLoad can report -1 for them, as DxLib does.
+ */
+
+/* Ordinary loads leave a core for the main thread, and use no more
+ * than ASYNCLOAD_THREAD_DEFAULT workers. A batch load has the main
+ * thread waiting, so it may add workers up to one per core, as many
+ * as ASYNCLOAD_THREAD_MAX. Workers stay until ASyncLoad ends. */
+#define ASYNCLOAD_THREAD_DEFAULT 4
+#define ASYNCLOAD_THREAD_MAX 16
+
+/* The default per-frame time spent finishing jobs, in milliseconds. */
+#define ASYNCLOAD_DEFAULT_TIME_BUDGET 2
+
+enum {
+    ASYNCLOAD_STATE_QUEUED,
+    ASYNCLOAD_STATE_DECODING,
+    ASYNCLOAD_STATE_DECODED,
+    ASYNCLOAD_STATE_UPLOADING,
+    ASYNCLOAD_STATE_DONE
+};
+
+typedef struct ASyncLoadJob {
+    int state;
+    int result;
+    
+    PL_ASyncLoadDecodeFunc decodeFunc;
+    PL_ASyncLoadUploadFunc uploadFunc;
+    PL_ASyncLoadFinishFunc finishFunc;
+    void *data;
+    
+    int *handles;
+    int handleCount;
+    int handleCapacity;
+    
+    struct ASyncLoadJob *next;
+} ASyncLoadJob;
+
+static int s_useASyncLoadFlag = DXFALSE;
+static int s_timeBudget = ASYNCLOAD_DEFAULT_TIME_BUDGET;
+
+static int s_initialized = DXFALSE;
+static int s_quitFlag = DXFALSE;
+static SDL_Thread *s_threads[ASYNCLOAD_THREAD_MAX];
+static int s_threadCount = 0;
+static SDL_Thread *s_uploadThread = NULL;
+static int s_uploadFlag = DXFALSE;
+static SDL_mutex *s_mutex = NULL;
+static SDL_cond *s_queuedCond = NULL;
+static SDL_cond *s_decodedCond = NULL;
+static SDL_cond *s_doneCond = NULL;
+
+/* All jobs in the order they were started. */
+static ASyncLoadJob *s_jobs = NULL;
+static ASyncLoadJob *s_lastJob = NULL;
+
+/* Handles whose load failed. Only touched on the main thread. */
+static int *s_failedHandles = NULL;
+static int s_failedCount = 0;
+static int s_failedCapacity = 0;
+
+static int s_WorkerThread(void *unused) {
+    ASyncLoadJob *job;
+    
+    SDL_LockMutex(s_mutex);
+    while (s_quitFlag == DXFALSE) {
+        for (job = s_jobs; job != NULL; job = job->next) {
+            if (job->state == ASYNCLOAD_STATE_QUEUED) {
+                break;
+            }
+        }
+        
+        if (job == NULL) {
+            SDL_CondWait(s_queuedCond, s_mutex);
+            continue;
+        }
+        
+        job->state = ASYNCLOAD_STATE_DECODING;
+        SDL_UnlockMutex(s_mutex);
+        
+        job->result = job->decodeFunc(job->data);
+        
+        SDL_LockMutex(s_mutex);
+        if (job->result == 0 && job->uploadFunc != NULL && s_uploadFlag == DXTRUE) {
+            job->state = ASYNCLOAD_STATE_DECODED;
+            SDL_CondSignal(s_decodedCond);
+        } else {
+            job->state = ASYNCLOAD_STATE_DONE;
+            SDL_CondBroadcast(s_doneCond);
+        }
+    }
+    SDL_UnlockMutex(s_mutex);
+    
+    return 0;
+}
+
+static int s_UploadThread(void *unused) {
+    ASyncLoadJob *job;
+    int bound = (PL_Draw_BindLoaderContext() == 0) ? DXTRUE : DXFALSE;
+    
+    SDL_LockMutex(s_mutex);
+    
+    /* If the context can't be used here, the main thread takes over. */
+    if (bound == DXFALSE) {
+        s_uploadFlag = DXFALSE;
+        for (job = s_jobs; job != NULL; job = job->next) {
+            if (job->state == ASYNCLOAD_STATE_DECODED) {
+                job->state = ASYNCLOAD_STATE_DONE;
+            }
+        }
+        SDL_CondBroadcast(s_doneCond);
+    }
+    
+    while (bound == DXTRUE && s_quitFlag == DXFALSE) {
+        for (job = s_jobs; job != NULL; job = job->next) {
+            if (job->state == ASYNCLOAD_STATE_DECODED) {
+                break;
+            }
+        }
+        
+        if (job == NULL) {
+            SDL_CondWait(s_decodedCond, s_mutex);
+            continue;
+        }
+        
+        job->state = ASYNCLOAD_STATE_UPLOADING;
+        SDL_UnlockMutex(s_mutex);
+        
+        job->uploadFunc(job->data);
+        
+        SDL_LockMutex(s_mutex);
+        job->state = ASYNCLOAD_STATE_DONE;
+        SDL_CondBroadcast(s_doneCond);
+    }
+    SDL_UnlockMutex(s_mutex);
+    
+    if (bound == DXTRUE) {
+        PL_Draw_UnbindLoaderContext();
+    }
+    
+    return 0;
+}
+
+/* Adds workers until there are threadCount of them. */
+static void s_AddWorkers(int threadCount) {
+    if (threadCount > ASYNCLOAD_THREAD_MAX) {
+        threadCount = ASYNCLOAD_THREAD_MAX;
+    }
+    
+    while (s_threadCount < threadCount) {
+        SDL_Thread *thread = SDL_CreateThread(s_WorkerThread, "DxPortLib ASyncLoad", NULL);
+        if (thread == NULL) {
+            break;
+        }
+        s_threads[s_threadCount++] = thread;
+    }
+}
+
+static int s_StartThreads() {
+    int threadCount;
+    
+    if (s_initialized == DXTRUE) {
+        return s_threadCount > 0 ? 0 : -1;
+    }
+    s_initialized = DXTRUE;
+    
+    s_mutex = SDL_CreateMutex();
+    s_queuedCond = SDL_CreateCond();
+    s_decodedCond = SDL_CreateCond();
+    s_doneCond = SDL_CreateCond();
+    if (s_mutex == NULL || s_queuedCond == NULL
+        || s_decodedCond == NULL || s_doneCond == NULL
+    ) {
+        return -1;
+    }
+    
+    /* Leave a core for the main thread. */
+    threadCount = SDL_GetCPUCount() - 1;
+    if (threadCount < 1) {
+        threadCount = 1;
+    } else if (threadCount > ASYNCLOAD_THREAD_DEFAULT) {
+        threadCount = ASYNCLOAD_THREAD_DEFAULT;
+    }
+    
+    s_quitFlag = DXFALSE;
+    
+    /* The upload thread goes first, so the workers see it from the start. */
+    if (PL_Draw_HasLoaderContext() == DXTRUE) {
+        s_uploadFlag = DXTRUE;
+        s_uploadThread = SDL_CreateThread(s_UploadThread, "DxPortLib ASyncUpload", NULL);
+        if (s_uploadThread == NULL) {
+            s_uploadFlag = DXFALSE;
+        }
+    }
+    
+    s_AddWorkers(threadCount);
+    
+    return s_threadCount > 0 ? 0 : -1;
+}
+
+/* Called before a batch of jobCount loads that will be waited on,
+ * to give it a worker per core, if it has that many files. */
+int PL_ASyncLoad_ReserveThreads(int jobCount) {
+    int threadCount = SDL_GetCPUCount();
+    
+    if (s_StartThreads() < 0) {
+        return -1;
+    }
+    
+    if (threadCount > jobCount) {
+        threadCount = jobCount;
+    }
+    s_AddWorkers(threadCount);
+    
+    return 0;
+}
+
+static ASyncLoadJob *s_FindHandleJob(int handleID) {
+    ASyncLoadJob *job;
+    int i;
+    
+    for (job = s_jobs; job != NULL; job = job->next) {
+        for (i = 0; i < job->handleCount; ++i) {
+            if (job->handles[i] == handleID) {
+                return job;
+            }
+        }
+    }
+    
+    return NULL;
+}
+
+static int s_AddJobHandle(ASyncLoadJob *job, int handleID) {
+    if (job->handleCount >= job->handleCapacity) {
+        int n = job->handleCapacity + 8;
+        int *handles = DXREALLOC(job->handles, (size_t)n * sizeof(int));
+        if (handles == NULL) {
+            return -1;
+        }
+        job->handles = handles;
+        job->handleCapacity = n;
+    }
+    
+    job->handles[job->handleCount++] = handleID;
+    
+    return 0;
+}
+
+static int s_FindFailedHandle(int handleID) {
+    int i;
+    
+    for (i = 0; i < s_failedCount; ++i) {
+        if (s_failedHandles[i] == handleID) {
+            return i;
+        }
+    }
+    
+    return -1;
+}
+
+static void s_AddFailedHandles(const int *handles, int handleCount) {
+    int i;
+    
+    for (i = 0; i < handleCount; ++i) {
+        if (s_failedCount >= s_failedCapacity) {
+            int n = s_failedCapacity + 8;
+            int *failedHandles = DXREALLOC(s_failedHandles, (size_t)n * sizeof(int));
+            if (failedHandles == NULL) {
+                return;
+            }
+            s_failedHandles = failedHandles;
+            s_failedCapacity = n;
+        }
+        
+        s_failedHandles[s_failedCount++] = handles[i];
+    }
+}
+
+static void s_FreeJob(ASyncLoadJob *job) {
+    if (job->handles != NULL) {
+        DXFREE(job->handles);
+    }
+    DXFREE(job);
+}
+
+/* Takes a done job out of the list, and finishes it. */
+static void s_FinishJob(ASyncLoadJob *job) {
+    ASyncLoadJob *prev = NULL;
+    ASyncLoadJob *current;
+    
+    SDL_LockMutex(s_mutex);
+    for (current = s_jobs; current != NULL; current = current->next) {
+        if (current == job) {
+            break;
+        }
+        prev = current;
+    }
+    if (current != NULL) {
+        if (prev != NULL) {
+            prev->next = job->next;
+        } else {
+            s_jobs = job->next;
+        }
+        if (s_lastJob == job) {
+            s_lastJob = prev;
+        }
+    }
+    SDL_UnlockMutex(s_mutex);
+    
+    if (job->finishFunc(job->data, job->result, job->handles, job->handleCount) < 0) {
+        s_AddFailedHandles(job->handles, job->handleCount);
+    }
+    
+    s_FreeJob(job);
+}
+
+static ASyncLoadJob *s_GetDoneJob() {
+    ASyncLoadJob *job;
+    
+    SDL_LockMutex(s_mutex);
+    for (job = s_jobs; job != NULL; job = job->next) {
+        if (job->state == ASYNCLOAD_STATE_DONE) {
+            break;
+        }
+    }
+    SDL_UnlockMutex(s_mutex);
+    
+    return job;
+}
+
+int PL_ASyncLoad_Start(int handleID,
+                       PL_ASyncLoadDecodeFunc decodeFunc,
+                       PL_ASyncLoadUploadFunc uploadFunc,
+                       PL_ASyncLoadFinishFunc finishFunc,
+                       void *data) {
+    ASyncLoadJob *job;
+    
+    if (s_StartThreads() < 0) {
+        /* No threads, so do it all now. Uploading is left to finishFunc,
+         * as the loader context can't be used on this thread. */
+        if (finishFunc(data, decodeFunc(data), &handleID, 1) < 0) {
+            s_AddFailedHandles(&handleID, 1);
+        }
+        return 0;
+    }
+    
+    job = DXALLOC(sizeof(ASyncLoadJob));
+    if (job == NULL) {
+        return -1;
+    }
+    job->state = ASYNCLOAD_STATE_QUEUED;
+    job->result = -1;
+    job->decodeFunc = decodeFunc;
+    job->uploadFunc = uploadFunc;
+    job->finishFunc = finishFunc;
+    job->data = data;
+    job->handles = NULL;
+    job->handleCount = 0;
+    job->handleCapacity = 0;
+    job->next = NULL;
+    
+    if (s_AddJobHandle(job, handleID) < 0) {
+        s_FreeJob(job);
+        return -1;
+    }
+    
+    SDL_LockMutex(s_mutex);
+    if (s_lastJob != NULL) {
+        s_lastJob->next = job;
+    } else {
+        s_jobs = job;
+    }
+    s_lastJob = job;
+    SDL_CondSignal(s_queuedCond);
+    SDL_UnlockMutex(s_mutex);
+    
+    return 0;
+}
+
+/* A handle made from one that is still loading (DerivationGraph)
+ * waits for the same job. */
+int PL_ASyncLoad_ShareHandle(int handleID, int newHandleID) {
+    ASyncLoadJob *job = s_FindHandleJob(handleID);
+    if (job == NULL) {
+        return -1;
+    }
+    
+    return s_AddJobHandle(job, newHandleID);
+}
+
+/* Called when a handle is deleted, whether or not its job is done. */
+int PL_ASyncLoad_ReleaseHandle(int handleID) {
+    ASyncLoadJob *job = s_FindHandleJob(handleID);
+    int i = s_FindFailedHandle(handleID);
+    
+    if (i >= 0) {
+        s_failedHandles[i] = s_failedHandles[--s_failedCount];
+    }
+    
+    if (job == NULL) {
+        return -1;
+    }
+    
+    for (i = 0; i < job->handleCount; ++i) {
+        if (job->handles[i] == handleID) {
+            job->handles[i] = job->handles[--job->handleCount];
+            break;
+        }
+    }
+    
+    return 0;
+}
+
+/* TRUE while loading, -1 if the load failed, FALSE once it's done. */
+int PL_ASyncLoad_CheckHandle(int handleID) {
+    if (s_FindHandleJob(handleID) != NULL) {
+        return DXTRUE;
+    }
+    
+    return (s_FindFailedHandle(handleID) >= 0) ? -1 : DXFALSE;
+}
+
+int PL_ASyncLoad_WaitHandle(int handleID) {
+    ASyncLoadJob *job;
+    
+    while ((job = s_FindHandleJob(handleID)) != NULL) {
+        SDL_LockMutex(s_mutex);
+        while (job->state != ASYNCLOAD_STATE_DONE) {
+            SDL_CondWait(s_doneCond, s_mutex);
+        }
+        SDL_UnlockMutex(s_mutex);
+        
+        s_FinishJob(job);
+    }
+    
+    return (s_FindFailedHandle(handleID) >= 0) ? -1 : 0;
+}
+
+int PL_ASyncLoad_GetNum() {
+    ASyncLoadJob *job;
+    int count = 0;
+    
+    for (job = s_jobs; job != NULL; job = job->next) {
+        count += job->handleCount;
+    }
+    
+    return count;
+}
+
+/* Finishes done jobs until the frame's time budget runs out.
+ * At least one is always finished, so loading can't stall. */
+int PL_ASyncLoad_Process() {
+    Uint64 start, budget;
+    ASyncLoadJob *job;
+    
+    if (s_jobs == NULL) {
+        return 0;
+    }
+    
+    start = SDL_GetPerformanceCounter();
+    budget = SDL_GetPerformanceFrequency() * (Uint64)s_timeBudget / 1000;
+    
+    while ((job = s_GetDoneJob()) != NULL) {
+        s_FinishJob(job);
+        
+        if (SDL_GetPerformanceCounter() - start >= budget) {
+            break;
+        }
+    }
+    
+    return 0;
+}
+
+int PL_ASyncLoad_SetUseFlag(int flag) {
+    s_useASyncLoadFlag = (flag == 0) ? DXFALSE : DXTRUE;
+    return 0;
+}
+int PL_ASyncLoad_GetUseFlag() {
+    return s_useASyncLoadFlag;
+}
+
+int PL_EXT_ASyncLoad_SetTimeBudget(int milliseconds) {
+    if (milliseconds < 0) {
+        return -1;
+    }
+    
+    s_timeBudget = milliseconds;
+    return 0;
+}
+
+void PL_ASyncLoad_End() {
+    ASyncLoadJob *job;
+    int i;
+    
+    if (s_initialized == DXFALSE) {
+        return;
+    }
+    
+    if (s_mutex != NULL) {
+        SDL_LockMutex(s_mutex);
+        s_quitFlag = DXTRUE;
+        SDL_CondBroadcast(s_queuedCond);
+        SDL_CondBroadcast(s_decodedCond);
+        SDL_UnlockMutex(s_mutex);
+    }
+    
+    for (i = 0; i < s_threadCount; ++i) {
+        SDL_WaitThread(s_threads[i], NULL);
+    }
+    s_threadCount = 0;
+    
+    if (s_uploadThread != NULL) {
+        SDL_WaitThread(s_uploadThread, NULL);
+        s_uploadThread = NULL;
+    }
+    s_uploadFlag = DXFALSE;
+    
+    /* Anything left over is dropped, giving the data back to its owner. */
+    while ((job = s_jobs) != NULL) {
+        s_jobs = job->next;
+        job->finishFunc(job->data, -1, NULL, 0);
+        s_FreeJob(job);
+    }
+    s_lastJob = NULL;
+    
+    if (s_failedHandles != NULL) {
+        DXFREE(s_failedHandles);
+        s_failedHandles = NULL;
+    }
+    s_failedCount = 0;
+    s_failedCapacity = 0;
+    
+    if (s_doneCond != NULL) {
+        SDL_DestroyCond(s_doneCond);
+        s_doneCond = NULL;
+    }
+    if (s_decodedCond != NULL) {
+        SDL_DestroyCond(s_decodedCond);
+        s_decodedCond = NULL;
+    }
+    if (s_queuedCond != NULL) {
+        SDL_DestroyCond(s_queuedCond);
+        s_queuedCond = NULL;
+    }
+    if (s_mutex != NULL) {
+        SDL_DestroyMutex(s_mutex);
+        s_mutex = NULL;
+    }
+    
+    s_initialized = DXFALSE;
+}
+
+#endif /* #ifndef DX_NON_ASYNCLOAD */
@@ -0,0 +1,426 @@
+/*
+  DxPortLib - A portability library for DxLib-based software.
+  Copyright (C) 2013 Patrick McCarthy <mauve@sandwich.net>
+  
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+  
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+    
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required. 
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include "DxInternal.h"
+
+/* DxPortLib extension: prepacked sprite atlases.
+ *
+ * LoadDivGraph has to decode a PNG and then make a graph per tile.
+ * An atlas is already in the form the renderer wants: each page is
+ * raw ARGB8888 that goes straight to a texture, and every sprite on it
+ * becomes a graph in one go. Sprites are looked up by name.
+ *
+ * Atlases are made by tools/dxatlaspack. Everything is little-endian.
+ *
+ *   Header, 16 bytes:
+ *     char[4] magic        "DXAT"
+ *     Uint16  version      1
+ *     Uint16  pageCount
+ *     Uint32  spriteCount
+ *     Uint32  nameTableSize
+ *   Pages, 16 bytes each:
+ *     Uint16  width, height
+ *     Uint8   format       0 = ARGB8888
+ *     Uint8   compression  0 = none, 1 = DXA LZ
+ *     Uint8   flags        1 = has alpha channel
+ *     Uint8   reserved
+ *     Uint32  dataOffset, dataSize
+ *   Sprites, 16 bytes each, sorted by name:
+ *     Uint16  page, x, y, w, h, reserved
+ *     Uint32  nameOffset   into the name table
+ *   Name table: UTF-8 names, each ending with a 0.
+ *   Page data, at the offsets given.
+ */
+
+#define ATLAS_HEADER_SIZE       16
+#define ATLAS_PAGE_SIZE         16
+#define ATLAS_SPRITE_SIZE       16
+#define ATLAS_VERSION           1
+
+#define ATLAS_FORMAT_ARGB8888   0
+
+#define ATLAS_COMPRESS_NONE     0
+#define ATLAS_COMPRESS_LZ       1
+
+#define ATLAS_FLAG_ALPHA        1
+
+/* Size of the header DXA_Decompress expects in front of LZ data. */
+#define ATLAS_LZ_HEADER_SIZE    9
+
+/* Larger pages than this aren't trusted; no renderer takes them anyway. */
+#define ATLAS_PAGE_DIM_MAX      16384
+
+typedef struct Atlas {
+    int spriteCount;
+    
+    /* All of these live in the same allocation as the Atlas. */
+    int *graphIDs;
+    Uint32 *nameOffsets;
+    char *names;
+    Uint32 nameTableSize;
+} Atlas;
+
+static Atlas *s_GetAtlas(int atlasID) {
+    return (Atlas *)PL_Handle_GetData(atlasID, DXHANDLE_ATLAS);
+}
+
+static Uint16 s_Read16(const unsigned char *p) {
+    return (Uint16)(p[0] | (p[1] << 8));
+}
+static Uint32 s_Read32(const unsigned char *p) {
+    return (Uint32)p[0] | ((Uint32)p[1] << 8)
+           | ((Uint32)p[2] << 16) | ((Uint32)p[3] << 24);
+}
+
+/* Gets the pixels for a page, decompressing them if need be.
+ * If *dAllocated is set afterwards, the caller frees it. */
+static unsigned char *s_GetPagePixels(const unsigned char *data, unsigned int size,
+                                      const unsigned char *page,
+                                      unsigned char **dAllocated) {
+    int width = s_Read16(page);
+    int height = s_Read16(page + 2);
+    Uint32 offset = s_Read32(page + 8);
+    Uint32 dataSize = s_Read32(page + 12);
+    Uint64 pixelSize64 = (Uint64)width * (Uint64)height * 4;
+    Uint32 pixelSize;
+    unsigned char *pixels;
+    
+    *dAllocated = NULL;
+    
+    if (page[4] != ATLAS_FORMAT_ARGB8888
+        || width <= 0 || height <= 0
+        || width > ATLAS_PAGE_DIM_MAX || height > ATLAS_PAGE_DIM_MAX
+        || offset > size || dataSize > size - offset
+    ) {
+        return NULL;
+    }
+    
+    /* Within the limits above, this can't overflow. */
+    pixelSize = (Uint32)pixelSize64;
+    
+    if (page[5] == ATLAS_COMPRESS_NONE) {
+        if (dataSize != pixelSize) {
+            return NULL;
+        }
+        pixels = (unsigned char *)data + offset;
+    }
+#ifndef DX_NON_DXA
+    else if (page[5] == ATLAS_COMPRESS_LZ) {
+        if (dataSize < ATLAS_LZ_HEADER_SIZE
+            || s_Read32(data + offset) != pixelSize
+            || s_Read32(data + offset + 4) > dataSize - ATLAS_LZ_HEADER_SIZE
+        ) {
+            return NULL;
+        }
+        pixels = (unsigned char *)DXALLOC(pixelSize);
+        if (pixels == NULL) {
+            return NULL;
+        }
+        if (DXA_Decompress(data + offset, dataSize, pixels, pixelSize) < 0) {
+            DXFREE(pixels);
+            return NULL;
+        }
+        *dAllocated = pixels;
+    }
+#endif /* #ifndef DX_NON_DXA */
+    else {
+        return NULL;
+    }
+
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+    {
+        /* Pixels are stored as little-endian words. If they're read
+         * straight from the file, they have to be copied first. */
+        Uint32 *p;
+        Uint32 i;
+        
+        if (*dAllocated == NULL) {
+            *dAllocated = (unsigned char *)DXALLOC(pixelSize);
+            if (*dAllocated == NULL) {
+                return NULL;
+            }
+            SDL_memcpy(*dAllocated, pixels, pixelSize);
+            pixels = *dAllocated;
+        }
+        
+        p = (Uint32 *)pixels;
+        for (i = 0; i < pixelSize / 4; ++i) {
+            p[i] = SDL_SwapLE32(p[i]);
+        }
+    }
+#endif
+    
+    return pixels;
+}
+
+/* Uploads one page, then makes graphs for all of the sprites on it. */
+static int s_LoadPage(Atlas *atlas, const unsigned char *data, unsigned int size,
+                      int pageIndex, const unsigned char *sprites,
+                      SDL_Rect *rectBuf, int *indexBuf, int *graphBuf,
+                      int *linkToGraphID) {
+    const unsigned char *page = data + ATLAS_HEADER_SIZE + pageIndex * ATLAS_PAGE_SIZE;
+    int width = s_Read16(page);
+    int height = s_Read16(page + 2);
+    unsigned char *pixels;
+    unsigned char *allocated;
+    SDL_Surface *surface;
+    int count = 0;
+    int retval;
+    int i;
+    
+    /* Collect the sprites on this page. */
+    for (i = 0; i < atlas->spriteCount; ++i) {
+        const unsigned char *sprite = sprites + i * ATLAS_SPRITE_SIZE;
+        SDL_Rect rect;
+        
+        if (s_Read16(sprite) != pageIndex) {
+            continue;
+        }
+        
+        rect.x = s_Read16(sprite + 2);
+        rect.y = s_Read16(sprite + 4);
+        rect.w = s_Read16(sprite + 6);
+        rect.h = s_Read16(sprite + 8);
+        if (rect.x + rect.w > width || rect.y + rect.h > height) {
+            return -1;
+        }
+        
+        rectBuf[count] = rect;
+        indexBuf[count] = i;
+        count += 1;
+    }
+    
+    if (count == 0) {
+        return 0;
+    }
+    
+    pixels = s_GetPagePixels(data, size, page, &allocated);
+    if (pixels == NULL) {
+        return -1;
+    }
+    
+    surface = SDL_CreateRGBSurfaceFrom(pixels, width, height, 32, width * 4,
+                                       0x00ff0000, 0x0000ff00,
+                                       0x000000ff, 0xff000000);
+    if (surface == NULL) {
+        if (allocated != NULL) {
+            DXFREE(allocated);
+        }
+        return -1;
+    }
+    
+    retval = PL_Graph_CreateDivFromSurface(
+        surface, (page[6] & ATLAS_FLAG_ALPHA) ? DXTRUE : DXFALSE,
+        rectBuf, count, *linkToGraphID, graphBuf);
+    
+    SDL_FreeSurface(surface);
+    if (allocated != NULL) {
+        DXFREE(allocated);
+    }
+    
+    if (retval < 0) {
+        return -1;
+    }
+    
+    for (i = 0; i < count; ++i) {
+        atlas->graphIDs[indexBuf[i]] = graphBuf[i];
+    }
+    *linkToGraphID = graphBuf[0];
+    
+    return 0;
+}
+
+static int s_LoadAtlas(Atlas *atlas, const unsigned char *data, unsigned int size) {
+    int pageCount = s_Read16(data + 6);
+    const unsigned char *sprites;
+    SDL_Rect *rectBuf;
+    int *indexBuf;
+    int *graphBuf;
+    int linkToGraphID = -1;
+    int retval = 0;
+    int i;
+    
+    sprites = data + ATLAS_HEADER_SIZE + pageCount * ATLAS_PAGE_SIZE;
+    
+    /* Every sprite has to be on a page, and have a name. */
+    for (i = 0; i < atlas->spriteCount; ++i) {
+        const unsigned char *sprite = sprites + i * ATLAS_SPRITE_SIZE;
+        
+        atlas->graphIDs[i] = -1;
+        atlas->nameOffsets[i] = s_Read32(sprite + 12);
+        if (s_Read16(sprite) >= pageCount
+            || atlas->nameOffsets[i] >= atlas->nameTableSize
+        ) {
+            return -1;
+        }
+    }
+    
+    rectBuf = (SDL_Rect *)DXALLOC(atlas->spriteCount * sizeof(SDL_Rect));
+    indexBuf = (int *)DXALLOC(atlas->spriteCount * sizeof(int) * 2);
+    if (rectBuf == NULL || indexBuf == NULL) {
+        if (rectBuf != NULL) {
+            DXFREE(rectBuf);
+        }
+        if (indexBuf != NULL) {
+            DXFREE(indexBuf);
+        }
+        return -1;
+    }
+    graphBuf = indexBuf + atlas->spriteCount;
+    
+    for (i = 0; i < pageCount; ++i) {
+        if (s_LoadPage(atlas, data, size, i, sprites,
+                       rectBuf, indexBuf, graphBuf, &linkToGraphID) < 0) {
+            retval = -1;
+            break;
+        }
+    }
+    
+    DXFREE(rectBuf);
+    DXFREE(indexBuf);
+    
+    /* Everything made so far is linked together. */
+    if (retval < 0 && linkToGraphID >= 0) {
+        PL_Graph_DeleteSharingGraph(linkToGraphID);
+    }
+    
+    return retval;
+}
+
+int PLEXT_Atlas_Load(const DXCHAR *filename) {
+    unsigned char *data;
+    unsigned int size;
+    int atlasID;
+    Atlas *atlas;
+    int pageCount, spriteCount;
+    Uint32 nameTableSize;
+    Uint32 tableEnd;
+    
+    if (PL_File_ReadFile(filename, &data, &size) < 0) {
+        return -1;
+    }
+    
+    if (size < ATLAS_HEADER_SIZE
+        || SDL_memcmp(data, "DXAT", 4) != 0
+        || s_Read16(data + 4) != ATLAS_VERSION
+    ) {
+        DXFREE(data);
+        return -1;
+    }
+    
+    pageCount = s_Read16(data + 6);
+    spriteCount = (int)s_Read32(data + 8);
+    nameTableSize = s_Read32(data + 12);
+    
+    tableEnd = ATLAS_HEADER_SIZE + (Uint32)pageCount * ATLAS_PAGE_SIZE;
+    if (spriteCount <= 0 || spriteCount > 0xffffff || tableEnd > size
+        || (size - tableEnd) / ATLAS_SPRITE_SIZE < (Uint32)spriteCount
+    ) {
+        DXFREE(data);
+        return -1;
+    }
+    tableEnd += (Uint32)spriteCount * ATLAS_SPRITE_SIZE;
+    if (nameTableSize > size - tableEnd
+        || nameTableSize == 0 || data[tableEnd + nameTableSize - 1] != 0
+    ) {
+        DXFREE(data);
+        return -1;
+    }
+    
+    atlasID = PL_Handle_AcquireID(DXHANDLE_ATLAS);
+    if (atlasID < 0) {
+        DXFREE(data);
+        return -1;
+    }
+    
+    atlas = (Atlas *)PL_Handle_AllocateData(
+        atlasID, sizeof(Atlas) + (size_t)spriteCount * (sizeof(int) + sizeof(Uint32))
+                 + nameTableSize);
+    atlas->spriteCount = spriteCount;
+    atlas->graphIDs = (int *)(atlas + 1);
+    atlas->nameOffsets = (Uint32 *)(atlas->graphIDs + spriteCount);
+    atlas->names = (char *)(atlas->nameOffsets + spriteCount);
+    atlas->nameTableSize = nameTableSize;
+    SDL_memcpy(atlas->names, data + tableEnd, nameTableSize);
+    
+    if (s_LoadAtlas(atlas, data, size) < 0) {
+        PL_Handle_ReleaseID(atlasID, DXTRUE);
+        DXFREE(data);
+        return -1;
+    }
+    
+    DXFREE(data);
+    
+    return atlasID;
+}
+
+int PLEXT_Atlas_GetGraph(int atlasID, const DXCHAR *name) {
+    Atlas *atlas = s_GetAtlas(atlasID);
+    char nameBuf[1024];
+    int low, high;
+    
+    if (atlas == NULL
+        || PL_Text_DxStringToString(name, nameBuf, 1024, DX_CHARSET_EXT_UTF8) <= 0
+    ) {
+        return -1;
+    }
+    
+    /* The packer sorts sprites by name. */
+    low = 0;
+    high = atlas->spriteCount - 1;
+    while (low <= high) {
+        int mid = (low + high) / 2;
+        int cmp = SDL_strcmp(nameBuf, atlas->names + atlas->nameOffsets[mid]);
+        
+        if (cmp == 0) {
+            return atlas->graphIDs[mid];
+        } else if (cmp < 0) {
+            high = mid - 1;
+        } else {
+            low = mid + 1;
+        }
+    }
+    
+    return -1;
+}
+
+/* The graphs are left alone. They belong to the caller, same as the
+ * ones LoadDivGraph makes. */
+int PLEXT_Atlas_Delete(int atlasID) {
+    Atlas *atlas = s_GetAtlas(atlasID);
+    if (atlas == NULL) {
+        return -1;
+    }
+    
+    PL_Handle_ReleaseID(atlasID, DXTRUE);
+    
+    return 0;
+}
+
+int PLEXT_Atlas_InitAtlases() {
+    int atlasID;
+    
+    while ((atlasID = PL_Handle_GetFirstIDOf(DXHANDLE_ATLAS)) >= 0) {
+        PLEXT_Atlas_Delete(atlasID);
+    }
+    
+    return 0;
+}
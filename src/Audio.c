@@ -639,21 +639,20 @@ static void s_AudioClose() {
 
 /* ------------------------------------------------------ DXLIB INTERFACE */
 
-static int s_LoadSound(const DXCHAR *filename) {
-    SDL_RWops *rwops;
+/* Takes ownership of rwops. */
+static int s_LoadSoundRW(SDL_RWops *rwops) {
     char buf[4];
     int soundID;
     Sound *sound;
     
-    s_AudioOpen();
-    
-    if (s_audioOpened == DXFALSE) {
+    if (rwops == NULL) {
         return -1;
     }
     
-    rwops = PL_File_OpenStream(filename);
+    s_AudioOpen();
     
-    if (rwops == NULL || SDL_RWread(rwops, buf, 4, 1) < 0) {
+    if (s_audioOpened == DXFALSE || SDL_RWread(rwops, buf, 4, 1) < 1) {
+        SDL_RWclose(rwops);
         return -1;
     }
     
@@ -691,6 +690,10 @@ static int s_LoadSound(const DXCHAR *filename) {
     return -1;
 }
 
+static int s_LoadSound(const DXCHAR *filename) {
+    return s_LoadSoundRW(PL_File_OpenStream(filename));
+}
+
 static void s_RestartSound(Sound *sound) {
     if (sound->soundType == SOUNDTYPE_STREAM) {
         s_AudioStreamRestart(sound);
@@ -732,6 +735,18 @@ int PL_LoadSoundMem(const DXCHAR *filename) {
     return s_LoadSound(filename);
 }
 
+/* Reads the sound straight out of data, which isn't copied.
+ * WAV files are decoded into their own buffer right away, but OGG
+ * files are streamed, so data has to stay around until the handle
+ * is deleted. */
+int PL_LoadSoundMemByMemImage(const void *data, unsigned int size) {
+    if (data == NULL || size == 0) {
+        return -1;
+    }
+    
+    return s_LoadSoundRW(SDL_RWFromConstMem(data, (int)size));
+}
+
 int PL_LoadSoundMem2(const DXCHAR *filename, const DXCHAR *filename2) {
     int soundIDA = s_LoadSound(filename);
     
@@ -157,8 +157,6 @@ typedef struct DXArchiveSearchInfo {
 static int DXA_ReadAndDecode(DXArchive *archive, unsigned long long position, void *dest, unsigned long long length);
 static void DXA_Decode(DXArchive *archive, const void *src, void *dest, unsigned long long length, unsigned long long offset);
 
-static int DXA_Decompress(const void *src, void *dest, unsigned long long dest_len);
-
 static unsigned long long DXA_GetFileAddress(DXArchive *archive, const DXCHAR *filename);
 
 static void DXA_GetFileInfo(DXArchive *archive, unsigned long long address, DXArchiveFileInfo *info);
@@ -258,29 +256,40 @@ static unsigned long long DXA_GetFileAddress(DXArchive *archive, const DXCHAR *f
 static int DXA_ReadCompressedFile(
     DXArchive *archive, DXArchiveFileInfo *fileInfo, unsigned char **dData, unsigned int *dSize
 ) {
-    unsigned char *data = (unsigned char *)DXALLOC((size_t)fileInfo->CompressedDataSize);
+    unsigned char *data = NULL;
+    const unsigned char *src;
     unsigned char *decompressed;
     unsigned long long address = archive->DataAddress + fileInfo->DataAddress;
     
+    /* Preloaded data is already decoded, so it's decompressed from
+     * where it sits. */
     if (archive->PreloadData != NULL) {
         if ((address + fileInfo->CompressedDataSize) > archive->PreloadSize) {
+            return -1;
+        }
+        src = archive->PreloadData + address;
+    } else {
+        data = (unsigned char *)DXALLOC((size_t)fileInfo->CompressedDataSize);
+        if (DXA_ReadAndDecode(archive, address, data, fileInfo->CompressedDataSize) < 0) {
             DXFREE(data);
             return -1;
         }
-        SDL_memcpy(data, archive->PreloadData + address, (size_t)fileInfo->CompressedDataSize);
-    } else if (DXA_ReadAndDecode(archive, address, data, fileInfo->CompressedDataSize) < 0) {
-        DXFREE(data);
-        return -1;
+        src = data;
     }
     
     decompressed = (unsigned char *)DXALLOC((size_t)fileInfo->DataSize);
-    if (DXA_Decompress(data, decompressed, fileInfo->DataSize) < 0) {
+    if (DXA_Decompress(src, fileInfo->CompressedDataSize,
+                       decompressed, fileInfo->DataSize) < 0) {
         DXFREE(decompressed);
-        DXFREE(data);
+        if (data != NULL) {
+            DXFREE(data);
+        }
         return -1;
     }
     
-    DXFREE(data);
+    if (data != NULL) {
+        DXFREE(data);
+    }
     
     *dData = decompressed;
     *dSize = (unsigned int)fileInfo->DataSize;
@@ -321,6 +330,40 @@ int DXA_ReadFile(DXArchive *archive, const DXCHAR *filename, unsigned char **dDa
     }
 }
 
+/* Points straight at a file's data in a preloaded archive, without
+ * copying it. This only works for files that aren't compressed, and
+ * the data goes away when the archive is closed. */
+int DXA_BorrowFile(DXArchive *archive, const DXCHAR *filename,
+                   const unsigned char **dData, unsigned int *dSize) {
+    unsigned long long index;
+    unsigned long long address;
+    DXArchiveFileInfo fileInfo;
+    
+    if (archive->PreloadData == NULL) {
+        return -1;
+    }
+    
+    index = DXA_GetFileAddress(archive, filename);
+    if (index == 0) {
+        return -1;
+    }
+    
+    DXA_GetFileInfo(archive, index, &fileInfo);
+    if (fileInfo.CompressedDataSize != 0xffffffff) {
+        return -1;
+    }
+    
+    address = archive->DataAddress + fileInfo.DataAddress;
+    if ((address + fileInfo.DataSize) > archive->PreloadSize) {
+        return -1;
+    }
+    
+    *dData = archive->PreloadData + address;
+    *dSize = (unsigned int)fileInfo.DataSize;
+    
+    return 0;
+}
+
 int DXA_TestFile(DXArchive *archive, const DXCHAR *filename) {
     unsigned long long index = DXA_GetFileAddress(archive, filename);
     if (index == 0) {
@@ -628,22 +671,41 @@ void DXA_SetArchiveKeyRaw(DXArchive *archive, const unsigned char *key) {
     }
 }
 
-static int DXA_Decompress(const void *vSrc, void *vDest, unsigned long long dest_len) {
+/* Every read and write is bounds checked, as atlas pages come through
+ * here too, and a corrupt file must not write past dest.
+ * src_size is how much data there really is, header included.
+ * Returns -1 if the data is broken, or doesn't fill dest exactly. */
+int DXA_Decompress(const void *vSrc, unsigned long long src_size,
+                   void *vDest, unsigned long long dest_len) {
     /* DXA LZ decompression. */
     const unsigned char *src = (const unsigned char *)vSrc;
-    unsigned int src_len = *(unsigned int *)(src + 4);
+    unsigned int src_len;
     const unsigned char *src_end;
-    unsigned char *dest = (unsigned char *)vDest;
+    unsigned char *dest_start = (unsigned char *)vDest;
+    unsigned char *dest = dest_start;
     unsigned char *dest_end = dest + dest_len;
-    unsigned char code = src[8];
-
+    unsigned char code;
+    
+    if (src_size < 9) {
+        return -1;
+    }
+    
+    src_len = (unsigned int)src[4] | ((unsigned int)src[5] << 8)
+              | ((unsigned int)src[6] << 16) | ((unsigned int)src[7] << 24);
+    code = src[8];
+    
     src += 9;
+    src_size -= 9;
+    if (src_len > src_size) {
+        src_len = (unsigned int)src_size;
+    }
     src_end = src + src_len;
 
     while (src < src_end && dest < dest_end) {
-        unsigned char control;
+        unsigned int control;
         unsigned int count;
         unsigned int d_index;
+        unsigned int index_size;
         
         /* - If this is not the control code, it's an uncompressed byte. */
         if (*src != code) {
@@ -652,6 +714,9 @@ static int DXA_Decompress(const void *vSrc, void *vDest, unsigned long long dest
         }
         
         /* - Read the control byte. If so, it's a single uncompressed byte. */
+        if (src_end - src < 2) {
+            return -1;
+        }
         control = *(src + 1);
         src += 2;
         if (control == code) {
@@ -669,36 +734,38 @@ static int DXA_Decompress(const void *vSrc, void *vDest, unsigned long long dest
         
         /* - If the 0x4 flag is set on the control byte, the next byte makes up the top 8 bits of the count. */
         if (control & 4) {
+            if (src >= src_end) {
+                return -1;
+            }
             count |= (unsigned int)(*src++ << 5);
         }
         
-        /* - Read the dictionary index, using the bottom 2 control bits to determine size/type. */
+        /* - Read the dictionary index, using the bottom 2 control bits to determine size/type.
+         *   It's little-endian, whatever this machine is. */
         control &= 3;
         count += 4;
         
-        d_index = 0;
+        index_size = (control == 3) ? 4 : control + 1;
+        if ((unsigned int)(src_end - src) < index_size) {
+            return -1;
+        }
         
-        switch(control) {
-            case 0:
-                d_index = *src++;
-                break;
-            case 1:
-                d_index = *((unsigned short *)src);
-                src += 2;
-                break;
-            case 2:
-                d_index = *((unsigned short *)src);
-                src += 2;
-                d_index |= (unsigned int)((*src++)<<16);
-                break;
-            default:
-                d_index = *((unsigned int *)src);
-                src += 4;
-                break;
+        d_index = 0;
+        while (index_size-- > 0) {
+            d_index |= (unsigned int)src[index_size] << (index_size * 8);
         }
+        src += (control == 3) ? 4 : control + 1;
         
         d_index += 1;
         
+        /* - The match has to start inside what's been written,
+         *   and end inside dest. */
+        if (d_index == 0 || d_index > (unsigned long long)(dest - dest_start)
+            || count > (unsigned long long)(dest_end - dest)
+        ) {
+            return -1;
+        }
+        
         /* - Copy from dictionary position. */
         if (d_index < count) {
             unsigned char *a = dest - d_index;
@@ -706,13 +773,13 @@ static int DXA_Decompress(const void *vSrc, void *vDest, unsigned long long dest
                 *dest++ = *a++;
             }
         } else {
-            memcpy(dest, dest - d_index, count);
+            SDL_memcpy(dest, dest - d_index, count);
             
             dest += count;
         }
     }
     
-    return 0;
+    return (dest == dest_end) ? 0 : -1;
 }
 
 /* ------------------------------------------------------------ DXARCHIVE RWOPS STREAMING */
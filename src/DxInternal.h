@@ -101,6 +101,9 @@ typedef enum {
     DXHANDLE_SOUND,
     DXHANDLE_FILE,
     DXHANDLE_FRAMEBUFFER,
+    DXHANDLE_PARTICLE,
+    DXHANDLE_ATLAS,
+    DXHANDLE_SOFTIMAGE,
     DXHANDLE_END
 } HandleType;
 
@@ -131,6 +134,7 @@ extern int PL_Window_ProcessMessages();
 
 extern int PL_Window_SetFullscreen(int isFullscreen);
 extern int PL_Window_SetDimensions(int width, int height, int colorDepth, int refreshRate);
+extern int PL_Window_GetColorDepth();
 extern int PL_Window_SetTitle(const DXCHAR *titleString);
 
 extern int PL_Window_SetWindowResizeFlag(int flag);
@@ -159,6 +163,27 @@ extern int PL_EXT_Draw_RectGraphFastF(
                             float dx, float dy, float dw, float dh,
                             int sx, int sy, int sw, int sh,
                             int graphID, int blendFlag);
+extern int PL_EXT_Draw_ParticleQuads(int graphID, int blendFlag,
+                                     const float *xArray, const float *yArray,
+                                     const Uint32 *colorArray,
+                                     int count, float scale);
+extern int PL_EXT_Draw_SetUseCPUClipFlag(int flag);
+extern int PL_EXT_Draw_GetCulledCount(int resetFlag);
+extern int PL_EXT_Draw_PushTransform();
+extern int PL_EXT_Draw_PopTransform();
+extern int PL_EXT_Draw_SetTransform(float a, float b, float c, float d, float tx, float ty);
+extern int PL_EXT_Draw_ResetTransform();
+extern int PL_EXT_Draw_TranslateTransform(float x, float y);
+extern int PL_EXT_Draw_ScaleTransform(float xScale, float yScale);
+extern int PL_EXT_Draw_RotateTransform(float angle);
+extern int PL_EXT_Draw_SetUseOpaqueLayerFlag(int flag);
+extern int PL_EXT_Draw_SetDynamicResolutionFlag(int flag);
+extern int PL_EXT_Draw_SetDynamicResolutionRange(float minScale, float maxScale,
+                                                 float targetMilliseconds);
+extern float PL_EXT_Draw_GetDynamicResolutionScale();
+extern int PL_EXT_Draw_SetMaxFramesInFlight(int count);
+extern float PL_EXT_Draw_GetPresentLatency();
+extern int PL_EXT_Draw_SetLoaderContextFlag(int flag);
 
 extern int PL_Draw_Pixel(int x, int y, DXCOLOR color);
 
@@ -173,6 +198,14 @@ extern int PL_Draw_CircleF(float x, float y, float r, DXCOLOR color, int fillFla
 extern int PL_Draw_Oval(int x, int y, int rx, int ry, DXCOLOR color, int fillFlag);
 extern int PL_Draw_OvalF(float x, float y, float rx, float ry, DXCOLOR color, int fillFlag);
 
+extern int PL_Draw_OvalAAF(float x, float y, float rx, float ry, int posnum,
+                           DXCOLOR color, int fillFlag, float lineThickness);
+extern int PL_Draw_LineAAF(float x1, float y1, float x2, float y2,
+                           DXCOLOR color, float thickness);
+extern int PL_Draw_RoundRectAAF(float x1, float y1, float x2, float y2,
+                                float rx, float ry, int posnum,
+                                DXCOLOR color, int fillFlag, float lineThickness);
+
 extern int PL_Draw_Triangle(int x1, int y1, int x2, int y2,
                             int x3, int y3, DXCOLOR color, int fillFlag);
 extern int PL_Draw_TriangleF(float x1, float y1, float x2, float y2,
@@ -259,6 +292,10 @@ extern int PL_Draw_ModiGraphF(float x1, float y1, float x2, float y2,
                               float x3, float y3, float x4, float y4,
                               int graphID, int blendFlag);
 
+extern int PL_Draw_Primitive2D(const VERTEX2D *vertices, int vertexNum,
+                               const unsigned short *indices, int indexNum,
+                               int primitiveType, int graphID, int blendFlag);
+
 extern int PL_Draw_SetDrawArea(int x1, int y1, int x2, int y2);
 
 extern int PL_Draw_SetDrawMode(int drawMode);
@@ -277,18 +314,35 @@ extern void PL_Draw_Refresh(SDL_Window *window, const SDL_Rect *targetRect);
 extern void PL_Draw_SwapBuffers(SDL_Window *window, const SDL_Rect *targetRect);
 extern void PL_Draw_Init(SDL_Window *window, int width, int height, int vsyncFlag);
 extern void PL_Draw_End();
+extern int PL_Draw_HasLoaderContext();
+extern int PL_Draw_BindLoaderContext();
+extern void PL_Draw_UnbindLoaderContext();
 extern int PL_Draw_ResetSettings();
 
 extern int PL_Draw_SetDrawScreen(int drawScreen);
 extern int PL_Draw_GetDrawScreen();
+extern int PL_Draw_GetDrawScreenGraph(int x1, int y1, int x2, int y2, int destGraphID);
+extern int PL_Draw_BltDrawValidGraph(int srcGraphID, int x1, int y1, int x2, int y2,
+                                     int destX, int destY, int destGraphID);
+extern DXCOLOR PL_Draw_GetPixel(int x, int y);
+extern int PL_Draw_GetPixelRegion(int x1, int y1, int x2, int y2, DXCOLOR *colors);
+extern int PL_Draw_GetScreenSurface(int x1, int y1, int x2, int y2, SDL_Surface **dSurface);
+extern int PL_EXT_Draw_RequestPixelRegion(int x1, int y1, int x2, int y2);
 
 /* ------------------------------------------------------------- Graph.c */
 extern int PL_Graph_MakeScreen(int width, int height, int hasAlphaChannel);
 extern int PL_Graph_Load(const DXCHAR *filename, int flipFlag);
+extern void PL_Graph_StopSharing(int graphID);
+extern int PL_Graph_CreateFromMem(const void *data, unsigned int size, int flipFlag);
+extern int PL_Graph_LoadBatch(const DXCHAR **filenames, int count, int *handleBuf,
+                              int *dLoadTime);
 extern int PL_Graph_LoadDiv(const DXCHAR *filename, int graphCount,
                             int xCount, int yCount, int xSize, int ySize,
                             int *handleBuf, int textureFlag, int flipFlag);
 extern int PL_Graph_CreateFromSurface(SDL_Surface *surface, int hasAlphaChannel);
+extern int PL_Graph_CreateDivFromSurface(SDL_Surface *surface, int hasAlphaChannel,
+                                         const SDL_Rect *rects, int count,
+                                         int linkToGraphID, int *handleBuf);
 extern int PL_Graph_FromTexture(int textureID, SDL_Rect rect);
 extern int PL_Graph_Delete(int graphID);
 extern int PL_Graph_DeleteSharingGraph(int graphID);
@@ -296,9 +350,18 @@ extern int PL_Graph_GetSize(int graphID, int *w, int *h);
 extern int PL_Graph_Derivation(int x, int y, int w, int h, int srcGraphID);
 extern int PL_Graph_GetNum();
 
+extern int PL_Graph_SetPalette(int graphID, int colorIndex, DXCOLOR color);
+extern int PL_Graph_GetPalette(int graphID, int colorIndex, int originalFlag,
+                               int *r, int *g, int *b);
+extern int PL_Graph_ResetPalette(int graphID);
+
 extern int PL_Graph_SetTransColor(int r, int g, int b);
 extern int PL_Graph_GetTransColor(int *r, int *g, int *b);
 extern int PL_Graph_SetUseTransColor(int flag);
+extern int PL_Graph_SetColorBitDepth(int colorBitDepth);
+extern int PL_Graph_GetColorBitDepth();
+extern int PL_EXT_Graph_SetDitherFlag(int flag);
+extern int PL_EXT_Graph_SetShareLoadedFlag(int flag);
 
 extern int PL_Graph_InitGraph();
 
@@ -317,8 +380,134 @@ extern int PL_Texture_BlitSurface(int textureID, SDL_Surface *surface, const SDL
 extern int PL_Texture_AddRef(int textureID);
 extern int PL_Texture_Release(int textureID);
 
+extern int PL_Texture_HasPaletteSupport();
+extern int PL_Texture_SetPaletteColor(int textureID, int index, Uint32 color);
+extern int PL_Texture_GetPaletteColor(int textureID, int index, int originalFlag, Uint32 *color);
+extern int PL_Texture_ResetPalette(int textureID);
+
+extern int PL_EXT_Texture_SetTiledGraphThreshold(int size);
+
+typedef struct PreparedTexture PreparedTexture;
+extern PreparedTexture *PL_Texture_PrepareFromSurface(SDL_Surface *surface, int hasAlphaChannel);
+extern int PL_Texture_CreateFromPrepared(PreparedTexture *prepared);
+extern void PL_Texture_ReleasePrepared(PreparedTexture *prepared);
+
 extern int PL_Framebuffer_GetSurface(const SDL_Rect *rect, SDL_Surface **dSurface);
 
+/* ----------------------------------------------------------- Surface.c */
+extern SDL_Surface *PL_Surface_ConvertTo16Bit(SDL_Surface *surface, int hasAlphaChannel,
+                                              int ditherFlag);
+extern int PL_Surface_ApplyColorKey(SDL_Surface *surface, Uint32 key);
+extern int PL_Surface_FlipHorizontal(SDL_Surface *surface);
+extern void PL_Surface_FillRow(Uint32 *dest, int n, Uint32 color);
+extern void PL_Surface_OpaqueRow(Uint32 *dest, const Uint32 *src, int n);
+extern void PL_Surface_SwapRedBlueRow(Uint32 *dest, const Uint32 *src, int n);
+extern void PL_Surface_BlendRow(Uint32 *dest, const Uint32 *src, int n, unsigned int opacity);
+
+/* The kernels PL_Surface_SetSIMDLevel can limit Surface.c to. */
+#define PL_SURFACE_SIMD_NONE 0
+#define PL_SURFACE_SIMD_BASE 1
+#define PL_SURFACE_SIMD_AVX2 2
+extern int PL_Surface_SetSIMDLevel(int level);
+
+/* --------------------------------------------------------- ASyncLoad.c */
+/* Runs on a worker thread. Returns 0 on success. */
+typedef int (*PL_ASyncLoadDecodeFunc)(void *data);
+/* Runs on the upload thread, with the loader context current,
+ * after a successful decode. Optional. */
+typedef void (*PL_ASyncLoadUploadFunc)(void *data);
+/* Runs on the main thread, once the decode is done, with the handles
+ * still waiting on it. Always frees data. Returns -1 if the handles
+ * were left without their data, so they're reported as failed. */
+typedef int (*PL_ASyncLoadFinishFunc)(void *data, int result,
+                                      const int *handles, int handleCount);
+
+extern int PL_ASyncLoad_Start(int handleID,
+                              PL_ASyncLoadDecodeFunc decodeFunc,
+                              PL_ASyncLoadUploadFunc uploadFunc,
+                              PL_ASyncLoadFinishFunc finishFunc,
+                              void *data);
+extern int PL_ASyncLoad_ShareHandle(int handleID, int newHandleID);
+extern int PL_ASyncLoad_ReleaseHandle(int handleID);
+extern int PL_ASyncLoad_CheckHandle(int handleID);
+extern int PL_ASyncLoad_WaitHandle(int handleID);
+extern int PL_ASyncLoad_GetNum();
+extern int PL_ASyncLoad_Process();
+extern int PL_ASyncLoad_ReserveThreads(int jobCount);
+
+extern int PL_ASyncLoad_SetUseFlag(int flag);
+extern int PL_ASyncLoad_GetUseFlag();
+extern int PL_EXT_ASyncLoad_SetTimeBudget(int milliseconds);
+
+extern void PL_ASyncLoad_End();
+
+/* -------------------------------------------------------- GraphCache.c */
+typedef struct GraphCacheKey {
+    /* The source's path, and the settings it was loaded with. */
+    Uint64 nameHash;
+    
+    /* The source file itself. */
+    Uint64 contentHash;
+    Uint32 contentSize;
+} GraphCacheKey;
+
+extern Uint64 PL_GraphCache_Hash(const void *data, size_t size, Uint64 hash);
+extern SDL_Surface *PL_GraphCache_Load(const GraphCacheKey *key, int *dHasAlphaChannel);
+extern int PL_GraphCache_Save(const GraphCacheKey *key, SDL_Surface *surface,
+                              int hasAlphaChannel);
+extern int PL_GraphCache_IsEnabled();
+extern int PL_EXT_GraphCache_SetDirectory(const DXCHAR *directory);
+
+/* --------------------------------------------------------------- QOI.c */
+extern int PL_QOI_IsQOI(const unsigned char *data, unsigned int size);
+extern SDL_Surface *PL_QOI_Decode(const unsigned char *data, unsigned int size,
+                                  int *dHasAlphaChannel);
+extern int PL_QOI_IsQOI_RW(SDL_RWops *file);
+extern SDL_Surface *PL_QOI_Load_RW(SDL_RWops *file, int freeSrc, int *dHasAlphaChannel);
+
+/* ---------------------------------------------------------- Particle.c */
+extern int PLEXT_Particle_Create(int graphID, int maxParticles);
+extern int PLEXT_Particle_Delete(int particleID);
+extern int PLEXT_Particle_SetGravity(int particleID, float gravityX, float gravityY);
+extern int PLEXT_Particle_SetScale(int particleID, float scale);
+extern int PLEXT_Particle_Emit(int particleID, float x, float y, float vx, float vy,
+                               float lifetime, DXCOLOR color, int alpha);
+extern int PLEXT_Particle_Update(int particleID, float deltaTime);
+extern int PLEXT_Particle_Draw(int particleID, int blendFlag);
+extern int PLEXT_Particle_GetNum(int particleID);
+extern int PLEXT_Particle_InitParticleSystems();
+
+/* ------------------------------------------------------------- Atlas.c */
+extern int PLEXT_Atlas_Load(const DXCHAR *filename);
+extern int PLEXT_Atlas_GetGraph(int atlasID, const DXCHAR *name);
+extern int PLEXT_Atlas_Delete(int atlasID);
+extern int PLEXT_Atlas_InitAtlases();
+
+/* --------------------------------------------------------- SoftImage.c */
+extern int PL_SoftImage_Make(int width, int height, int hasAlphaChannel);
+extern int PL_SoftImage_Load(const DXCHAR *filename);
+extern int PL_SoftImage_Delete(int softImageID);
+extern int PL_SoftImage_InitSoftImage();
+extern int PL_SoftImage_GetSize(int softImageID, int *width, int *height);
+extern void *PL_SoftImage_GetImageAddress(int softImageID);
+extern int PL_SoftImage_GetPitch(int softImageID);
+extern int PL_SoftImage_GetPixel(int softImageID, int x, int y,
+                                 int *r, int *g, int *b, int *a);
+extern int PL_SoftImage_DrawPixel(int softImageID, int x, int y,
+                                  int r, int g, int b, int a);
+extern int PL_SoftImage_Fill(int softImageID, int r, int g, int b, int a);
+extern int PL_SoftImage_ClearRect(int softImageID, int x, int y, int w, int h);
+extern int PL_SoftImage_Blt(int srcX, int srcY, int srcSizeX, int srcSizeY,
+                            int srcSoftImageID, int destX, int destY,
+                            int destSoftImageID);
+extern int PL_SoftImage_BltAlphaBlend(int srcX, int srcY, int srcSizeX, int srcSizeY,
+                                      int srcSoftImageID, int destX, int destY,
+                                      int destSoftImageID, int opacity);
+extern int PL_SoftImage_CreateGraph(int softImageID);
+extern int PL_SoftImage_ReCreateGraph(int softImageID, int graphID);
+extern int PL_SoftImage_SaveToPNG(const DXCHAR *filename, int softImageID,
+                                  int compressionLevel);
+
 /* -------------------------------------------------------- SaveScreen.c */
 extern int PL_SaveDrawScreenToBMP(int x1, int y1, int x2, int y2,
                                   const DXCHAR *filename);
@@ -387,6 +576,11 @@ extern int PLEXT_Font_MapFontFileToName(const DXCHAR *filename,
                                    int thickness, int boldFlag,
                                    double exRateX, double exRateY
                                   );
+extern int PLEXT_Font_MapFontMemToName(const void *fileData, unsigned int fileSize,
+                                       const DXCHAR *fontname,
+                                       int thickness, int boldFlag,
+                                       double exRateX, double exRateY
+                                      );
 extern int PLEXT_Font_InitFontMappings();
 
 extern void PL_Font_Init();
@@ -408,10 +602,17 @@ extern void DXA_SetArchiveKey(DXArchive *archive, const char *keystring);
 extern void DXA_SetArchiveKeyRaw(DXArchive *archive, const unsigned char *key);
 
 extern int DXA_ReadFile(DXArchive *archive, const DXCHAR *filename, unsigned char **dDest, unsigned int *dSize);
+extern int DXA_BorrowFile(DXArchive *archive, const DXCHAR *filename,
+                          const unsigned char **dData, unsigned int *dSize);
 extern int DXA_TestFile(DXArchive *archive, const DXCHAR *filename);
 
 extern SDL_RWops *DXA_OpenStream(DXArchive *archive, const DXCHAR *filename);
 
+/* DxLib's LZ format. Also used outside of archives, by atlas pages,
+ * so it's bounds checked. Returns -1 on broken data. */
+extern int DXA_Decompress(const void *src, unsigned long long src_size,
+                          void *dest, unsigned long long dest_len);
+
 #else /* #ifndef DX_NOT_DXA */
 
 typedef int DXArchive;
@@ -424,6 +625,8 @@ extern SDL_RWops *PL_File_OpenDirectStream(const DXCHAR *filename);
 extern SDL_RWops *PL_File_OpenStream(const DXCHAR *filename);
 
 extern int PL_File_ReadFile(const DXCHAR *filename, unsigned char **dData, unsigned int *dSize);
+extern int PL_File_BorrowFile(const DXCHAR *filename,
+                              const unsigned char **dData, unsigned int *dSize);
 
 extern int PL_File_SetDXArchiveKeyString(const DXCHAR *keyString);
 extern int PL_File_SetDXArchiveExtension(const DXCHAR *extension);
@@ -502,6 +705,7 @@ extern int PL_Random_Seed(int randomSeed);
 #ifndef DX_NON_SOUND
 
 extern int PL_LoadSoundMem(const DXCHAR *filename);
+extern int PL_LoadSoundMemByMemImage(const void *data, unsigned int size);
 extern int PL_LoadSoundMem2(const DXCHAR *filename, const DXCHAR *filename2);
 extern int PL_DeleteSoundMem(int soundID);
 extern int PL_PlaySoundMem(int soundID, int playType, int startPositionFlag);
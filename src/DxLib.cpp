@@ -76,6 +76,30 @@ int SetDeleteHandleFlag(int handleID, int *flag) {
     return ::DxLib_SetDeleteHandleFlag(handleID, flag);
 }
 
+#ifndef DX_NON_ASYNCLOAD
+int SetUseASyncLoadFlag(int flag) {
+    return ::DxLib_SetUseASyncLoadFlag(flag);
+}
+int GetUseASyncLoadFlag() {
+    return ::DxLib_GetUseASyncLoadFlag();
+}
+int CheckHandleASyncLoad(int handle) {
+    return ::DxLib_CheckHandleASyncLoad(handle);
+}
+int WaitHandleASyncLoad(int handle) {
+    return ::DxLib_WaitHandleASyncLoad(handle);
+}
+int GetASyncLoadNum() {
+    return ::DxLib_GetASyncLoadNum();
+}
+int EXT_SetASyncLoadTimeBudget(int milliseconds) {
+    return ::DxLib_EXT_SetASyncLoadTimeBudget(milliseconds);
+}
+int EXT_SetUseLoaderThreadFlag(int flag) {
+    return ::DxLib_EXT_SetUseLoaderThreadFlag(flag);
+}
+#endif /* #ifndef DX_NON_ASYNCLOAD */
+
 int SetUseCharSet(int charset) {
     return ::DxLib_SetUseCharSet(charset);
 }
@@ -312,6 +336,26 @@ int LoadReverseDivGraph(const DXCHAR *filename, int graphCount,
     return ::DxLib_LoadReverseDivGraph(filename, graphCount, xCount, yCount,
                                        xSize, ySize, handleBuf);
 }
+int CreateGraphFromMem(const void *fileImage, int fileImageSize,
+                       const void *alphaFileImage, int alphaFileImageSize,
+                       int textureFlag, int reverseFlag) {
+    return ::DxLib_CreateGraphFromMem(fileImage, fileImageSize,
+                                      alphaFileImage, alphaFileImageSize,
+                                      textureFlag, reverseFlag);
+}
+int EXT_LoadAtlas(const DXCHAR *filename) {
+    return ::DxLib_EXT_LoadAtlas(filename);
+}
+int EXT_GetAtlasGraph(int atlasHandle, const DXCHAR *name) {
+    return ::DxLib_EXT_GetAtlasGraph(atlasHandle, name);
+}
+int EXT_DeleteAtlas(int atlasHandle) {
+    return ::DxLib_EXT_DeleteAtlas(atlasHandle);
+}
+int EXT_LoadGraphBatch(const DXCHAR **files, int count,
+                       int *handles, int *loadTime) {
+    return ::DxLib_EXT_LoadGraphBatch(files, count, handles, loadTime);
+}
 int DeleteGraph(int graphID) {
     return ::DxLib_DeleteGraph(graphID);
 }
@@ -332,6 +376,42 @@ int GetGraphSize(int graphID, int *width, int *height) {
     return ::DxLib_GetGraphSize(graphID, width, height);
 }
 
+int SetGraphPalette(int graphID, int colorIndex, DXCOLOR color) {
+    return ::DxLib_SetGraphPalette(graphID, colorIndex, color);
+}
+int GetGraphPalette(int graphID, int colorIndex,
+                    int *red, int *green, int *blue) {
+    return ::DxLib_GetGraphPalette(graphID, colorIndex, red, green, blue);
+}
+int GetGraphOriginalPalette(int graphID, int colorIndex,
+                            int *red, int *green, int *blue) {
+    return ::DxLib_GetGraphOriginalPalette(graphID, colorIndex, red, green, blue);
+}
+int ResetGraphPalette(int graphID) {
+    return ::DxLib_ResetGraphPalette(graphID);
+}
+
+int GetDrawScreenGraph(int x1, int y1, int x2, int y2,
+                       int graphID, int useClientFlag) {
+    return ::DxLib_GetDrawScreenGraph(x1, y1, x2, y2, graphID, useClientFlag);
+}
+int BltDrawValidGraph(int srcGraphID,
+                      int x1, int y1, int x2, int y2,
+                      int destX, int destY, int destGraphID) {
+    return ::DxLib_BltDrawValidGraph(srcGraphID, x1, y1, x2, y2,
+                                     destX, destY, destGraphID);
+}
+DXCOLOR GetPixel(int x, int y) {
+    return ::DxLib_GetPixel(x, y);
+}
+int EXT_GetPixelRegion(int x1, int y1, int x2, int y2,
+                       DXCOLOR *colors) {
+    return ::DxLib_EXT_GetPixelRegion(x1, y1, x2, y2, colors);
+}
+int EXT_RequestPixelRegion(int x1, int y1, int x2, int y2) {
+    return ::DxLib_EXT_RequestPixelRegion(x1, y1, x2, y2);
+}
+
 int SetTransColor(int r, int g, int b) {
     return ::DxLib_SetTransColor(r, g, b);
 }
@@ -341,6 +421,24 @@ int GetTransColor(int *r, int *g, int *b) {
 int SetUseTransColor(int flag) {
     return ::DxLib_SetUseTransColor(flag);
 }
+int SetGraphColorBitDepth(int colorBitDepth) {
+    return ::DxLib_SetGraphColorBitDepth(colorBitDepth);
+}
+int GetGraphColorBitDepth() {
+    return ::DxLib_GetGraphColorBitDepth();
+}
+int EXT_SetGraphDitherFlag(int flag) {
+    return ::DxLib_EXT_SetGraphDitherFlag(flag);
+}
+int EXT_SetTiledGraphThreshold(int size) {
+    return ::DxLib_EXT_SetTiledGraphThreshold(size);
+}
+int EXT_SetGraphCacheDirectory(const DXCHAR *directory) {
+    return ::DxLib_EXT_SetGraphCacheDirectory(directory);
+}
+int EXT_SetShareLoadedGraphFlag(int flag) {
+    return ::DxLib_EXT_SetShareLoadedGraphFlag(flag);
+}
 
 int DrawPixel(int x, int y, DXCOLOR color) {
     return ::DxLib_DrawPixel(x, y, color);
@@ -385,6 +483,25 @@ int DrawOvalF(float x, float y, float rx, float ry, DXCOLOR color, int fillFlag)
     return ::DxLib_DrawOvalF(x, y, rx, ry, color, fillFlag);
 }
 
+int DrawCircleAA(float x, float y, float r, int posnum,
+                 DXCOLOR color, int fillFlag, float lineThickness) {
+    return ::DxLib_DrawCircleAA(x, y, r, posnum, color, fillFlag, lineThickness);
+}
+int DrawOvalAA(float x, float y, float rx, float ry, int posnum,
+               DXCOLOR color, int fillFlag, float lineThickness) {
+    return ::DxLib_DrawOvalAA(x, y, rx, ry, posnum, color, fillFlag, lineThickness);
+}
+int DrawLineAA(float x1, float y1, float x2, float y2,
+               DXCOLOR color, float thickness) {
+    return ::DxLib_DrawLineAA(x1, y1, x2, y2, color, thickness);
+}
+int DrawRoundRectAA(float x1, float y1, float x2, float y2,
+                    float rx, float ry, int posnum,
+                    DXCOLOR color, int fillFlag, float lineThickness) {
+    return ::DxLib_DrawRoundRectAA(x1, y1, x2, y2, rx, ry, posnum,
+                                   color, fillFlag, lineThickness);
+}
+
 int DrawTriangle(int x1, int y1, int x2, int y2,
                        int x3, int y3,
                        DXCOLOR color, int fillFlag) {
@@ -567,9 +684,77 @@ int DrawModiGraphF(float x1, float y1, float x2, float y2,
     return ::DxLib_DrawModiGraphF(x1, y1, x2, y2, x3, y3, x4, y4, graphID, blendFlag);
 }
 
+int DrawPolygon2D(const VERTEX2D *vertexArray, int polygonNum,
+                  int graphID, int blendFlag) {
+    return ::DxLib_DrawPolygon2D(vertexArray, polygonNum, graphID, blendFlag);
+}
+int DrawPrimitive2D(const VERTEX2D *vertexArray, int vertexNum,
+                    int primitiveType, int graphID, int blendFlag) {
+    return ::DxLib_DrawPrimitive2D(vertexArray, vertexNum, primitiveType, graphID, blendFlag);
+}
+int DrawPolygonIndexed2D(const VERTEX2D *vertexArray, int vertexNum,
+                         const unsigned short *indexArray, int polygonNum,
+                         int graphID, int blendFlag) {
+    return ::DxLib_DrawPolygonIndexed2D(vertexArray, vertexNum, indexArray, polygonNum,
+                                        graphID, blendFlag);
+}
+int DrawPrimitiveIndexed2D(const VERTEX2D *vertexArray, int vertexNum,
+                           const unsigned short *indexArray, int indexNum,
+                           int primitiveType, int graphID, int blendFlag) {
+    return ::DxLib_DrawPrimitiveIndexed2D(vertexArray, vertexNum, indexArray, indexNum,
+                                          primitiveType, graphID, blendFlag);
+}
+
 int SetDrawArea(int x1, int y1, int x2, int y2) {
     return ::DxLib_SetDrawArea(x1, y1, x2, y2);
 }
+int EXT_SetUseCPUClipFlag(int flag) {
+    return ::DxLib_EXT_SetUseCPUClipFlag(flag);
+}
+int EXT_GetCulledDrawCount(int resetFlag) {
+    return ::DxLib_EXT_GetCulledDrawCount(resetFlag);
+}
+int EXT_PushTransform() {
+    return ::DxLib_EXT_PushTransform();
+}
+int EXT_PopTransform() {
+    return ::DxLib_EXT_PopTransform();
+}
+int EXT_SetTransform(float a, float b, float c, float d,
+                     float tx, float ty) {
+    return ::DxLib_EXT_SetTransform(a, b, c, d, tx, ty);
+}
+int EXT_ResetTransform() {
+    return ::DxLib_EXT_ResetTransform();
+}
+int EXT_TranslateTransform(float x, float y) {
+    return ::DxLib_EXT_TranslateTransform(x, y);
+}
+int EXT_ScaleTransform(float xScale, float yScale) {
+    return ::DxLib_EXT_ScaleTransform(xScale, yScale);
+}
+int EXT_RotateTransform(float angle) {
+    return ::DxLib_EXT_RotateTransform(angle);
+}
+int EXT_SetUseOpaqueLayerFlag(int flag) {
+    return ::DxLib_EXT_SetUseOpaqueLayerFlag(flag);
+}
+int EXT_SetDynamicResolutionFlag(int flag) {
+    return ::DxLib_EXT_SetDynamicResolutionFlag(flag);
+}
+int EXT_SetDynamicResolutionRange(float minScale, float maxScale,
+                                  float targetMilliseconds) {
+    return ::DxLib_EXT_SetDynamicResolutionRange(minScale, maxScale, targetMilliseconds);
+}
+float EXT_GetDynamicResolutionScale() {
+    return ::DxLib_EXT_GetDynamicResolutionScale();
+}
+int EXT_SetMaxFramesInFlight(int count) {
+    return ::DxLib_EXT_SetMaxFramesInFlight(count);
+}
+float EXT_GetPresentLatency() {
+    return ::DxLib_EXT_GetPresentLatency();
+}
 
 int SetDrawMode(int drawMode) {
     return ::DxLib_SetDrawMode(drawMode);
@@ -630,6 +815,113 @@ DXCOLOR GetColor(int red, int green, int blue) {
     return red | (green << 8) | (blue << 16);
 }
 
+int EXT_MakeParticleSystem(int graphID, int maxParticles) {
+    return ::DxLib_EXT_MakeParticleSystem(graphID, maxParticles);
+}
+int EXT_DeleteParticleSystem(int particleHandle) {
+    return ::DxLib_EXT_DeleteParticleSystem(particleHandle);
+}
+int EXT_SetParticleSystemGravity(int particleHandle,
+                                 float gravityX, float gravityY) {
+    return ::DxLib_EXT_SetParticleSystemGravity(particleHandle, gravityX, gravityY);
+}
+int EXT_SetParticleSystemScale(int particleHandle, float scale) {
+    return ::DxLib_EXT_SetParticleSystemScale(particleHandle, scale);
+}
+int EXT_EmitParticle(int particleHandle,
+                     float x, float y, float vx, float vy,
+                     float lifetime,
+                     DXCOLOR color, int alpha) {
+    return ::DxLib_EXT_EmitParticle(particleHandle, x, y, vx, vy,
+                                    lifetime, color, alpha);
+}
+int EXT_UpdateParticleSystem(int particleHandle, float deltaTime) {
+    return ::DxLib_EXT_UpdateParticleSystem(particleHandle, deltaTime);
+}
+int EXT_DrawParticleSystem(int particleHandle, int blendFlag) {
+    return ::DxLib_EXT_DrawParticleSystem(particleHandle, blendFlag);
+}
+int EXT_GetParticleNum(int particleHandle) {
+    return ::DxLib_EXT_GetParticleNum(particleHandle);
+}
+
+// ----------------------------------------------- DxSoftImage.cpp
+#ifndef DX_NON_SOFTIMAGE
+
+int MakeSoftImage(int sizeX, int sizeY) {
+    return ::DxLib_MakeSoftImage(sizeX, sizeY);
+}
+int MakeARGB8ColorSoftImage(int sizeX, int sizeY) {
+    return ::DxLib_MakeARGB8ColorSoftImage(sizeX, sizeY);
+}
+int MakeXRGB8ColorSoftImage(int sizeX, int sizeY) {
+    return ::DxLib_MakeXRGB8ColorSoftImage(sizeX, sizeY);
+}
+int LoadSoftImage(const DXCHAR *filename) {
+    return ::DxLib_LoadSoftImage(filename);
+}
+int DeleteSoftImage(int softImageHandle) {
+    return ::DxLib_DeleteSoftImage(softImageHandle);
+}
+int InitSoftImage() {
+    return ::DxLib_InitSoftImage();
+}
+
+int GetSoftImageSize(int softImageHandle, int *width, int *height) {
+    return ::DxLib_GetSoftImageSize(softImageHandle, width, height);
+}
+void *GetImageAddressSoftImage(int softImageHandle) {
+    return ::DxLib_GetImageAddressSoftImage(softImageHandle);
+}
+int GetPitchSoftImage(int softImageHandle) {
+    return ::DxLib_GetPitchSoftImage(softImageHandle);
+}
+
+int GetPixelSoftImage(int softImageHandle, int x, int y,
+                      int *r, int *g, int *b, int *a) {
+    return ::DxLib_GetPixelSoftImage(softImageHandle, x, y, r, g, b, a);
+}
+int DrawPixelSoftImage(int softImageHandle, int x, int y,
+                       int r, int g, int b, int a) {
+    return ::DxLib_DrawPixelSoftImage(softImageHandle, x, y, r, g, b, a);
+}
+int FillSoftImage(int softImageHandle, int r, int g, int b, int a) {
+    return ::DxLib_FillSoftImage(softImageHandle, r, g, b, a);
+}
+int ClearRectSoftImage(int softImageHandle, int x, int y, int w, int h) {
+    return ::DxLib_ClearRectSoftImage(softImageHandle, x, y, w, h);
+}
+
+int BltSoftImage(int srcX, int srcY, int srcSizeX, int srcSizeY,
+                 int srcSoftImageHandle,
+                 int destX, int destY, int destSoftImageHandle) {
+    return ::DxLib_BltSoftImage(srcX, srcY, srcSizeX, srcSizeY, srcSoftImageHandle,
+                                destX, destY, destSoftImageHandle);
+}
+int BltSoftImageWithAlphaBlend(int srcX, int srcY, int srcSizeX, int srcSizeY,
+                               int srcSoftImageHandle,
+                               int destX, int destY, int destSoftImageHandle,
+                               int opacity) {
+    return ::DxLib_BltSoftImageWithAlphaBlend(srcX, srcY, srcSizeX, srcSizeY,
+                                              srcSoftImageHandle,
+                                              destX, destY, destSoftImageHandle,
+                                              opacity);
+}
+
+int CreateGraphFromSoftImage(int softImageHandle) {
+    return ::DxLib_CreateGraphFromSoftImage(softImageHandle);
+}
+int ReCreateGraphFromSoftImage(int softImageHandle, int graphHandle) {
+    return ::DxLib_ReCreateGraphFromSoftImage(softImageHandle, graphHandle);
+}
+
+int SaveSoftImageToPng(const DXCHAR *filename, int softImageHandle,
+                       int compressionLevel) {
+    return ::DxLib_SaveSoftImageToPng(filename, softImageHandle, compressionLevel);
+}
+
+#endif /* #ifndef DX_NON_SOFTIMAGE */
+
 // ---------------------------------------------------- DxFont.cpp
 #ifndef DX_NON_FONT
 
@@ -646,6 +938,20 @@ int EXT_MapFontFileToName(const DXCHAR *filename,
                                          exRateX, exRateY
                                         );
 }
+int EXT_MapFontMemToName(const void *fileImage,
+                         int fileImageSize,
+                         const DXCHAR *fontname,
+                         int thickness,
+                         int boldFlag,
+                         double exRateX,
+                         double exRateY
+                        ) {
+    return ::DxLib_EXT_MapFontMemToName(fileImage, fileImageSize,
+                                        fontname,
+                                        thickness, boldFlag,
+                                        exRateX, exRateY
+                                       );
+}
 int EXT_InitFontMappings() {
     return ::DxLib_EXT_InitFontMappings();
 }
@@ -860,6 +1166,9 @@ int LoadSoundMem(const DXCHAR *filename) {
 int LoadSoundMem2(const DXCHAR *filename, const DXCHAR *filename2) {
     return ::DxLib_LoadSoundMem2(filename, filename2);
 }
+int LoadSoundMemByMemImage(const void *fileImage, int fileImageSize) {
+    return ::DxLib_LoadSoundMemByMemImage(fileImage, fileImageSize);
+}
 int DeleteSoundMem(int soundID) {
     return ::DxLib_DeleteSoundMem(soundID);
 }
@@ -99,6 +99,14 @@ int DxLib_DxLib_End(void) {
 #ifndef DX_NON_SOUND
     PL_Audio_End();
 #endif /* #ifndef DX_NON_SOUND */
+    PLEXT_Particle_InitParticleSystems();
+    PLEXT_Atlas_InitAtlases();
+#ifndef DX_NON_SOFTIMAGE
+    PL_SoftImage_InitSoftImage();
+#endif /* #ifndef DX_NON_SOFTIMAGE */
+#ifndef DX_NON_ASYNCLOAD
+    PL_ASyncLoad_End();
+#endif /* #ifndef DX_NON_ASYNCLOAD */
     PL_Window_End();
 #ifndef DX_NON_INPUT
     PL_Input_End();
@@ -185,6 +193,30 @@ int DxLib_SetDeleteHandleFlag(int handleID, int *flag) {
     return PL_Handle_SetDeleteFlag(handleID, flag);
 }
 
+#ifndef DX_NON_ASYNCLOAD
+int DxLib_SetUseASyncLoadFlag(int flag) {
+    return PL_ASyncLoad_SetUseFlag(flag);
+}
+int DxLib_GetUseASyncLoadFlag() {
+    return PL_ASyncLoad_GetUseFlag();
+}
+int DxLib_CheckHandleASyncLoad(int handle) {
+    return PL_ASyncLoad_CheckHandle(handle);
+}
+int DxLib_WaitHandleASyncLoad(int handle) {
+    return PL_ASyncLoad_WaitHandle(handle);
+}
+int DxLib_GetASyncLoadNum() {
+    return PL_ASyncLoad_GetNum();
+}
+int DxLib_EXT_SetASyncLoadTimeBudget(int milliseconds) {
+    return PL_EXT_ASyncLoad_SetTimeBudget(milliseconds);
+}
+int DxLib_EXT_SetUseLoaderThreadFlag(int flag) {
+    return PL_EXT_Draw_SetLoaderContextFlag(flag);
+}
+#endif /* #ifndef DX_NON_ASYNCLOAD */
+
 int DxLib_SetUseCharSet(int charset) {
     return PL_Text_SetUseCharSet(charset);
 }
@@ -425,6 +457,27 @@ int DxLib_LoadReverseDivGraph(const DXCHAR *filename, int graphCount,
                             xSize, ySize, handleBuf,
                             DXFALSE, DXTRUE);
 }
+int DxLib_CreateGraphFromMem(const void *fileImage, int fileImageSize,
+                             const void *alphaFileImage, int alphaFileImageSize,
+                             int textureFlag, int reverseFlag) {
+    if (fileImageSize <= 0) {
+        return -1;
+    }
+    return PL_Graph_CreateFromMem(fileImage, (unsigned int)fileImageSize, reverseFlag);
+}
+int DxLib_EXT_LoadAtlas(const DXCHAR *filename) {
+    return PLEXT_Atlas_Load(filename);
+}
+int DxLib_EXT_GetAtlasGraph(int atlasHandle, const DXCHAR *name) {
+    return PLEXT_Atlas_GetGraph(atlasHandle, name);
+}
+int DxLib_EXT_DeleteAtlas(int atlasHandle) {
+    return PLEXT_Atlas_Delete(atlasHandle);
+}
+int DxLib_EXT_LoadGraphBatch(const DXCHAR **files, int count,
+                             int *handles, int *loadTime) {
+    return PL_Graph_LoadBatch(files, count, handles, loadTime);
+}
 int DxLib_DeleteGraph(int graphID) {
     return PL_Graph_Delete(graphID);
 }
@@ -445,6 +498,42 @@ int DxLib_GetGraphSize(int graphID, int *width, int *height) {
     return PL_Graph_GetSize(graphID, width, height);
 }
 
+int DxLib_SetGraphPalette(int graphID, int colorIndex, DXCOLOR color) {
+    return PL_Graph_SetPalette(graphID, colorIndex, color);
+}
+int DxLib_GetGraphPalette(int graphID, int colorIndex,
+                          int *red, int *green, int *blue) {
+    return PL_Graph_GetPalette(graphID, colorIndex, DXFALSE, red, green, blue);
+}
+int DxLib_GetGraphOriginalPalette(int graphID, int colorIndex,
+                                  int *red, int *green, int *blue) {
+    return PL_Graph_GetPalette(graphID, colorIndex, DXTRUE, red, green, blue);
+}
+int DxLib_ResetGraphPalette(int graphID) {
+    return PL_Graph_ResetPalette(graphID);
+}
+
+int DxLib_GetDrawScreenGraph(int x1, int y1, int x2, int y2,
+                             int graphID, int useClientFlag) {
+    return PL_Draw_GetDrawScreenGraph(x1, y1, x2, y2, graphID);
+}
+int DxLib_BltDrawValidGraph(int srcGraphID,
+                            int x1, int y1, int x2, int y2,
+                            int destX, int destY, int destGraphID) {
+    return PL_Draw_BltDrawValidGraph(srcGraphID, x1, y1, x2, y2,
+                                     destX, destY, destGraphID);
+}
+DXCOLOR DxLib_GetPixel(int x, int y) {
+    return PL_Draw_GetPixel(x, y);
+}
+int DxLib_EXT_GetPixelRegion(int x1, int y1, int x2, int y2,
+                             DXCOLOR *colors) {
+    return PL_Draw_GetPixelRegion(x1, y1, x2, y2, colors);
+}
+int DxLib_EXT_RequestPixelRegion(int x1, int y1, int x2, int y2) {
+    return PL_EXT_Draw_RequestPixelRegion(x1, y1, x2, y2);
+}
+
 int DxLib_SetTransColor(int r, int g, int b) {
     return PL_Graph_SetTransColor(r, g, b);
 }
@@ -454,6 +543,24 @@ int DxLib_GetTransColor(int *r, int *g, int *b) {
 int DxLib_SetUseTransColor(int flag) {
     return PL_Graph_SetUseTransColor(flag);
 }
+int DxLib_SetGraphColorBitDepth(int colorBitDepth) {
+    return PL_Graph_SetColorBitDepth(colorBitDepth);
+}
+int DxLib_GetGraphColorBitDepth() {
+    return PL_Graph_GetColorBitDepth();
+}
+int DxLib_EXT_SetGraphDitherFlag(int flag) {
+    return PL_EXT_Graph_SetDitherFlag(flag);
+}
+int DxLib_EXT_SetTiledGraphThreshold(int size) {
+    return PL_EXT_Texture_SetTiledGraphThreshold(size);
+}
+int DxLib_EXT_SetGraphCacheDirectory(const DXCHAR *directory) {
+    return PL_EXT_GraphCache_SetDirectory(directory);
+}
+int DxLib_EXT_SetShareLoadedGraphFlag(int flag) {
+    return PL_EXT_Graph_SetShareLoadedFlag(flag);
+}
 
 int DxLib_DrawPixel(int x, int y, DXCOLOR color) {
     return PL_Draw_Pixel(x, y, color);
@@ -498,6 +605,25 @@ int DxLib_DrawOvalF(float x, float y, float rx, float ry, DXCOLOR color, int fil
     return PL_Draw_OvalF(x, y, rx, ry, color, fillFlag);
 }
 
+int DxLib_DrawCircleAA(float x, float y, float r, int posnum,
+                       DXCOLOR color, int fillFlag, float lineThickness) {
+    return PL_Draw_OvalAAF(x, y, r, r, posnum, color, fillFlag, lineThickness);
+}
+int DxLib_DrawOvalAA(float x, float y, float rx, float ry, int posnum,
+                     DXCOLOR color, int fillFlag, float lineThickness) {
+    return PL_Draw_OvalAAF(x, y, rx, ry, posnum, color, fillFlag, lineThickness);
+}
+int DxLib_DrawLineAA(float x1, float y1, float x2, float y2,
+                     DXCOLOR color, float thickness) {
+    return PL_Draw_LineAAF(x1, y1, x2, y2, color, thickness);
+}
+int DxLib_DrawRoundRectAA(float x1, float y1, float x2, float y2,
+                          float rx, float ry, int posnum,
+                          DXCOLOR color, int fillFlag, float lineThickness) {
+    return PL_Draw_RoundRectAAF(x1, y1, x2, y2, rx, ry, posnum,
+                                color, fillFlag, lineThickness);
+}
+
 int DxLib_DrawTriangle(int x1, int y1, int x2, int y2,
                        int x3, int y3,
                        DXCOLOR color, int fillFlag) {
@@ -680,9 +806,79 @@ int DxLib_DrawModiGraphF(float x1, float y1, float x2, float y2,
     return PL_Draw_ModiGraphF(x1, y1, x2, y2, x3, y3, x4, y4, graphID, blendFlag);
 }
 
+int DxLib_DrawPolygon2D(const VERTEX2D *vertexArray, int polygonNum,
+                        int graphID, int blendFlag) {
+    return PL_Draw_Primitive2D(vertexArray, polygonNum * 3, NULL, 0,
+                               DX_PRIMTYPE_TRIANGLELIST, graphID, blendFlag);
+}
+int DxLib_DrawPrimitive2D(const VERTEX2D *vertexArray, int vertexNum,
+                          int primitiveType, int graphID, int blendFlag) {
+    return PL_Draw_Primitive2D(vertexArray, vertexNum, NULL, 0,
+                               primitiveType, graphID, blendFlag);
+}
+int DxLib_DrawPolygonIndexed2D(const VERTEX2D *vertexArray, int vertexNum,
+                               const unsigned short *indexArray, int polygonNum,
+                               int graphID, int blendFlag) {
+    return PL_Draw_Primitive2D(vertexArray, vertexNum, indexArray, polygonNum * 3,
+                               DX_PRIMTYPE_TRIANGLELIST, graphID, blendFlag);
+}
+int DxLib_DrawPrimitiveIndexed2D(const VERTEX2D *vertexArray, int vertexNum,
+                                 const unsigned short *indexArray, int indexNum,
+                                 int primitiveType, int graphID, int blendFlag) {
+    return PL_Draw_Primitive2D(vertexArray, vertexNum, indexArray, indexNum,
+                               primitiveType, graphID, blendFlag);
+}
+
 int DxLib_SetDrawArea(int x1, int y1, int x2, int y2) {
     return PL_Draw_SetDrawArea(x1, y1, x2, y2);
 }
+int DxLib_EXT_SetUseCPUClipFlag(int flag) {
+    return PL_EXT_Draw_SetUseCPUClipFlag(flag);
+}
+int DxLib_EXT_GetCulledDrawCount(int resetFlag) {
+    return PL_EXT_Draw_GetCulledCount(resetFlag);
+}
+int DxLib_EXT_PushTransform() {
+    return PL_EXT_Draw_PushTransform();
+}
+int DxLib_EXT_PopTransform() {
+    return PL_EXT_Draw_PopTransform();
+}
+int DxLib_EXT_SetTransform(float a, float b, float c, float d,
+                           float tx, float ty) {
+    return PL_EXT_Draw_SetTransform(a, b, c, d, tx, ty);
+}
+int DxLib_EXT_ResetTransform() {
+    return PL_EXT_Draw_ResetTransform();
+}
+int DxLib_EXT_TranslateTransform(float x, float y) {
+    return PL_EXT_Draw_TranslateTransform(x, y);
+}
+int DxLib_EXT_ScaleTransform(float xScale, float yScale) {
+    return PL_EXT_Draw_ScaleTransform(xScale, yScale);
+}
+int DxLib_EXT_RotateTransform(float angle) {
+    return PL_EXT_Draw_RotateTransform(angle);
+}
+int DxLib_EXT_SetUseOpaqueLayerFlag(int flag) {
+    return PL_EXT_Draw_SetUseOpaqueLayerFlag(flag);
+}
+int DxLib_EXT_SetDynamicResolutionFlag(int flag) {
+    return PL_EXT_Draw_SetDynamicResolutionFlag(flag);
+}
+int DxLib_EXT_SetDynamicResolutionRange(float minScale, float maxScale,
+                                        float targetMilliseconds) {
+    return PL_EXT_Draw_SetDynamicResolutionRange(minScale, maxScale, targetMilliseconds);
+}
+float DxLib_EXT_GetDynamicResolutionScale() {
+    return PL_EXT_Draw_GetDynamicResolutionScale();
+}
+int DxLib_EXT_SetMaxFramesInFlight(int count) {
+    return PL_EXT_Draw_SetMaxFramesInFlight(count);
+}
+float DxLib_EXT_GetPresentLatency() {
+    return PL_EXT_Draw_GetPresentLatency();
+}
 
 int DxLib_SetDrawMode(int drawMode) {
     return PL_Draw_SetDrawMode(drawMode);
@@ -753,6 +949,112 @@ DXCOLOR DxLib_GetColor(int red, int green, int blue) {
     return red | (green << 8) | (blue << 16);
 }
 
+int DxLib_EXT_MakeParticleSystem(int graphID, int maxParticles) {
+    return PLEXT_Particle_Create(graphID, maxParticles);
+}
+int DxLib_EXT_DeleteParticleSystem(int particleHandle) {
+    return PLEXT_Particle_Delete(particleHandle);
+}
+int DxLib_EXT_SetParticleSystemGravity(int particleHandle,
+                                       float gravityX, float gravityY) {
+    return PLEXT_Particle_SetGravity(particleHandle, gravityX, gravityY);
+}
+int DxLib_EXT_SetParticleSystemScale(int particleHandle, float scale) {
+    return PLEXT_Particle_SetScale(particleHandle, scale);
+}
+int DxLib_EXT_EmitParticle(int particleHandle,
+                           float x, float y, float vx, float vy,
+                           float lifetime,
+                           DXCOLOR color, int alpha) {
+    return PLEXT_Particle_Emit(particleHandle, x, y, vx, vy,
+                               lifetime, color, alpha);
+}
+int DxLib_EXT_UpdateParticleSystem(int particleHandle, float deltaTime) {
+    return PLEXT_Particle_Update(particleHandle, deltaTime);
+}
+int DxLib_EXT_DrawParticleSystem(int particleHandle, int blendFlag) {
+    return PLEXT_Particle_Draw(particleHandle, blendFlag);
+}
+int DxLib_EXT_GetParticleNum(int particleHandle) {
+    return PLEXT_Particle_GetNum(particleHandle);
+}
+
+/* ----------------------------------------------- DxSoftImage.cpp */
+#ifndef DX_NON_SOFTIMAGE
+
+int DxLib_MakeSoftImage(int sizeX, int sizeY) {
+    return PL_SoftImage_Make(sizeX, sizeY, DXTRUE);
+}
+int DxLib_MakeARGB8ColorSoftImage(int sizeX, int sizeY) {
+    return PL_SoftImage_Make(sizeX, sizeY, DXTRUE);
+}
+int DxLib_MakeXRGB8ColorSoftImage(int sizeX, int sizeY) {
+    return PL_SoftImage_Make(sizeX, sizeY, DXFALSE);
+}
+int DxLib_LoadSoftImage(const DXCHAR *filename) {
+    return PL_SoftImage_Load(filename);
+}
+int DxLib_DeleteSoftImage(int softImageHandle) {
+    return PL_SoftImage_Delete(softImageHandle);
+}
+int DxLib_InitSoftImage() {
+    return PL_SoftImage_InitSoftImage();
+}
+
+int DxLib_GetSoftImageSize(int softImageHandle, int *width, int *height) {
+    return PL_SoftImage_GetSize(softImageHandle, width, height);
+}
+void *DxLib_GetImageAddressSoftImage(int softImageHandle) {
+    return PL_SoftImage_GetImageAddress(softImageHandle);
+}
+int DxLib_GetPitchSoftImage(int softImageHandle) {
+    return PL_SoftImage_GetPitch(softImageHandle);
+}
+
+int DxLib_GetPixelSoftImage(int softImageHandle, int x, int y,
+                            int *r, int *g, int *b, int *a) {
+    return PL_SoftImage_GetPixel(softImageHandle, x, y, r, g, b, a);
+}
+int DxLib_DrawPixelSoftImage(int softImageHandle, int x, int y,
+                             int r, int g, int b, int a) {
+    return PL_SoftImage_DrawPixel(softImageHandle, x, y, r, g, b, a);
+}
+int DxLib_FillSoftImage(int softImageHandle, int r, int g, int b, int a) {
+    return PL_SoftImage_Fill(softImageHandle, r, g, b, a);
+}
+int DxLib_ClearRectSoftImage(int softImageHandle, int x, int y, int w, int h) {
+    return PL_SoftImage_ClearRect(softImageHandle, x, y, w, h);
+}
+
+int DxLib_BltSoftImage(int srcX, int srcY, int srcSizeX, int srcSizeY,
+                       int srcSoftImageHandle,
+                       int destX, int destY, int destSoftImageHandle) {
+    return PL_SoftImage_Blt(srcX, srcY, srcSizeX, srcSizeY, srcSoftImageHandle,
+                            destX, destY, destSoftImageHandle);
+}
+int DxLib_BltSoftImageWithAlphaBlend(int srcX, int srcY, int srcSizeX, int srcSizeY,
+                                     int srcSoftImageHandle,
+                                     int destX, int destY, int destSoftImageHandle,
+                                     int opacity) {
+    return PL_SoftImage_BltAlphaBlend(srcX, srcY, srcSizeX, srcSizeY,
+                                      srcSoftImageHandle,
+                                      destX, destY, destSoftImageHandle, opacity);
+}
+
+int DxLib_CreateGraphFromSoftImage(int softImageHandle) {
+    return PL_SoftImage_CreateGraph(softImageHandle);
+}
+int DxLib_ReCreateGraphFromSoftImage(int softImageHandle, int graphHandle) {
+    return PL_SoftImage_ReCreateGraph(softImageHandle, graphHandle);
+}
+
+int DxLib_SaveSoftImageToPng(const DXCHAR *filename, int softImageHandle,
+                             int compressionLevel) {
+    return PL_SoftImage_SaveToPNG(filename, softImageHandle, compressionLevel);
+}
+
+#endif /* #ifndef DX_NON_SOFTIMAGE */
+
 /* ---------------------------------------------------- DxFont.cpp */
 #ifndef DX_NON_FONT
 
@@ -767,6 +1069,21 @@ int DxLib_EXT_MapFontFileToName(const DXCHAR *filename,
                                    fontname, thickness, boldFlag,
                                    exRateX, exRateY);
 }
+int DxLib_EXT_MapFontMemToName(const void *fileImage,
+                               int fileImageSize,
+                               const DXCHAR *fontname,
+                               int thickness,
+                               int boldFlag,
+                               double exRateX,
+                               double exRateY
+                              ) {
+    if (fileImageSize <= 0) {
+        return -1;
+    }
+    return PLEXT_Font_MapFontMemToName(fileImage, (unsigned int)fileImageSize,
+                                       fontname, thickness, boldFlag,
+                                       exRateX, exRateY);
+}
 int DxLib_EXT_InitFontMappings() {
     return PLEXT_Font_InitFontMappings();
 }
@@ -981,6 +1298,12 @@ int DxLib_LoadSoundMem(const DXCHAR *filename) {
 int DxLib_LoadSoundMem2(const DXCHAR *filename, const DXCHAR *filename2) {
     return PL_LoadSoundMem2(filename, filename2);
 }
+int DxLib_LoadSoundMemByMemImage(const void *fileImage, int fileImageSize) {
+    if (fileImageSize <= 0) {
+        return -1;
+    }
+    return PL_LoadSoundMemByMemImage(fileImage, (unsigned int)fileImageSize);
+}
 int DxLib_DeleteSoundMem(int soundID) {
     return PL_DeleteSoundMem(soundID);
 }
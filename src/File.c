@@ -245,6 +245,41 @@ int PL_File_ReadFile(const DXCHAR *filename, unsigned char **dData, unsigned int
     return retval;
 }
 
+/* Gets a file's data without copying it, if it would be read from a
+ * preloaded archive and isn't compressed there. The data belongs to the
+ * archive, and is only good until it's released.
+ * Returns -1 if the file has to be read the usual way. */
+int PL_File_BorrowFile(const DXCHAR *filename,
+                       const unsigned char **dData, unsigned int *dSize) {
+    DXCHAR buf[2048];
+    const DXCHAR *end;
+    DXArchive *archive;
+    
+    if (s_useArchiveFlag == DXFALSE) {
+        return -1;
+    }
+    
+    /* A loose file would win, so don't hand out the archive's copy. */
+    if (s_filePriorityFlag == DXTRUE) {
+        SDL_RWops *rwops = PL_File_OpenDirectStream(filename);
+        if (rwops != NULL) {
+            SDL_RWclose(rwops);
+            return -1;
+        }
+    }
+    
+    if (s_GetArchiveFilename(filename, buf, 2048, &end) <= 0) {
+        return -1;
+    }
+    
+    archive = s_GetArchive(buf);
+    if (archive == NULL) {
+        return -1;
+    }
+    
+    return DXA_BorrowFile(archive, end + 1, dData, dSize);
+}
+
 /* ------------------------------------------------------------ PUBLIC INTERFACE */
 /* Sets the "encryption" key to use for the packfile. */
 int PL_File_SetDXArchiveKeyString(const DXCHAR *keyString) {
@@ -58,6 +58,10 @@ typedef struct FontMapping {
     DXCHAR *filename;
     int directFileAccessOnly;
     
+    /* Set instead of filename for fonts mapped from memory. */
+    const void *fileData;
+    unsigned int fileSize;
+    
     DXCHAR *fontname;
     
     int thickness;
@@ -267,6 +271,47 @@ int PLEXT_Font_MapFontFileToName(
     mapping->filename = DXSTRDUP(filename);
     mapping->fontname = DXSTRDUP(fontname);
     mapping->directFileAccessOnly = !PL_File_GetUseDXArchiveFlag();
+    mapping->fileData = NULL;
+    mapping->fileSize = 0;
+    mapping->thickness = thickness;
+    mapping->boldFlag = boldFlag;
+    mapping->next = s_fontMappings;
+    mapping->exRateX = exRateX;
+    mapping->exRateY = exRateY;
+    
+    s_fontMappings = mapping;
+    
+    return 0;
+}
+
+/* Like PLEXT_Font_MapFontFileToName, but for a font file that's
+ * already in memory. Fonts are read straight out of fileData, which
+ * isn't copied, so it has to stay around for as long as the mapping
+ * and any font handles made from it do. */
+int PLEXT_Font_MapFontMemToName(
+    const void *fileData,
+    unsigned int fileSize,
+    const DXCHAR *fontname,
+    int thickness,
+    int boldFlag,
+    double exRateX,
+    double exRateY
+) {
+    FontMapping *mapping;
+    
+    if (fileData == NULL || fileSize == 0) {
+        return -1;
+    }
+    
+    s_Initialize();
+    
+    mapping = DXALLOC(sizeof(FontMapping));
+    
+    mapping->filename = NULL;
+    mapping->fontname = DXSTRDUP(fontname);
+    mapping->directFileAccessOnly = DXFALSE;
+    mapping->fileData = fileData;
+    mapping->fileSize = fileSize;
     mapping->thickness = thickness;
     mapping->boldFlag = boldFlag;
     mapping->next = s_fontMappings;
@@ -284,7 +329,9 @@ int PLEXT_Font_InitFontMappings() {
     mapping = s_fontMappings;
     while (mapping != NULL) {
         FontMapping *nextMapping = mapping->next;
-        DXFREE(mapping->filename);
+        if (mapping->filename != NULL) {
+            DXFREE(mapping->filename);
+        }
         DXFREE(mapping->fontname);
         DXFREE(mapping);
         mapping = nextMapping;
@@ -1133,7 +1180,11 @@ int PL_Font_CreateFontToHandle(const DXCHAR *fontname,
         return -1;
     }
     
-    if (bestMapping->directFileAccessOnly) {
+    if (bestMapping->fileData != NULL) {
+        fontID = s_LoadFontRW(SDL_RWFromConstMem(bestMapping->fileData,
+                                                 (int)bestMapping->fileSize),
+                              bestMapping, size);
+    } else if (bestMapping->directFileAccessOnly) {
         fontID = s_LoadFontFileDirect(bestMapping->filename, bestMapping, size);
     } else {
         fontID = s_LoadFontFile(bestMapping->filename, bestMapping, size);
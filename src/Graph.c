@@ -31,6 +31,9 @@
  */
 static unsigned int s_transparentColor = 0x000000;
 static int s_useTransparency = DXTRUE;
+static int s_graphColorBitDepth = 0;
+static int s_graphDitherFlag = DXFALSE;
+static int s_shareLoadedGraphFlag = DXFALSE;
 static int s_graphCount = 0;
 
 typedef struct Graph {
@@ -79,11 +82,14 @@ static int s_AllocateGraphID(int textureRefID, SDL_Rect rect, int linkToGraphID)
     return graphID;
 }
 
-static int s_ApplyTransparentColor(SDL_Surface *surface) {
+/* The transparency settings are passed in, rather than read here,
+ * so that asynchronous loads use the ones from when they started. */
+static int s_ApplyTransparentColor(SDL_Surface *surface, int useTransparency,
+                                   unsigned int transparentColor) {
     SDL_PixelFormat *format;
     int hasAlphaChannel = DXFALSE;
    
-    if (s_useTransparency == DXFALSE) {
+    if (useTransparency == DXFALSE) {
         return DXFALSE;
     }
     
@@ -96,9 +102,9 @@ static int s_ApplyTransparentColor(SDL_Surface *surface) {
         int ncolors = palette->ncolors;
         int i;
         
-        transColor.r = (s_transparentColor >> 16) & 0xff;
-        transColor.g = (s_transparentColor >> 8) & 0xff;
-        transColor.b = (s_transparentColor) & 0xff;
+        transColor.r = (transparentColor >> 16) & 0xff;
+        transColor.g = (transparentColor >> 8) & 0xff;
+        transColor.b = (transparentColor) & 0xff;
         transColor.a = 255;
         
         for (i = 0; i < ncolors; ++i) {
@@ -115,38 +121,58 @@ static int s_ApplyTransparentColor(SDL_Surface *surface) {
             
         }
     } else if (surface->format->BitsPerPixel == 32) {
-        unsigned int *pixels = surface->pixels;
-        unsigned int transColor;
-        int width = surface->w;
-        int height = surface->h;
-        int pitch = surface->pitch / 4;
-        int x, y;
-
-        transColor = (s_transparentColor >> 16) << format->Rshift
-                     | (s_transparentColor >> 8) << format->Gshift
-                     | (s_transparentColor) << format->Bshift
-                     | (unsigned int)(0xff) << format->Ashift;
+        Uint32 transColor;
         
-        for (y = 0; y < height; ++y) {
-            for (x = 0; x < width; ++x) {
-                if (pixels[x] == transColor) {
-                    pixels[x] = 0;
-                    hasAlphaChannel = DXTRUE;
-                }
-            }
-            pixels += pitch;
-        }
+        transColor = ((transparentColor >> 16) & 0xff) << format->Rshift
+                     | ((transparentColor >> 8) & 0xff) << format->Gshift
+                     | (transparentColor & 0xff) << format->Bshift
+                     | (Uint32)(0xff) << format->Ashift;
+        
+        hasAlphaChannel = PL_Surface_ApplyColorKey(surface, transColor);
     }
     
     return hasAlphaChannel;
 }
 
+/* At 16-bit, pack the pixels down before the renderer sees them.
+ * Returns NULL if the original should be used, which is also what
+ * happens if packing fails for whatever reason.
+ * 8-bit images that can stay 8-bit are already smaller. */
+static SDL_Surface *s_PackSurface(SDL_Surface *surface, int hasAlphaChannel,
+                                  int colorBitDepth, int ditherFlag) {
+    if (colorBitDepth != 16
+        || (surface->format->format == SDL_PIXELFORMAT_INDEX8
+            && PL_Texture_HasPaletteSupport() == DXTRUE)
+    ) {
+        return NULL;
+    }
+    
+    return PL_Surface_ConvertTo16Bit(surface, hasAlphaChannel, ditherFlag);
+}
+
+static int s_CreateTextureFromSurface(SDL_Surface *surface, int hasAlphaChannel) {
+    int textureRefID;
+    SDL_Surface *packedSurface;
+    
+    packedSurface = s_PackSurface(surface, hasAlphaChannel,
+                                  PL_Graph_GetColorBitDepth(), s_graphDitherFlag);
+    
+    if (packedSurface != NULL) {
+        textureRefID = PL_Texture_CreateFromSurface(packedSurface, hasAlphaChannel);
+        SDL_FreeSurface(packedSurface);
+    } else {
+        textureRefID = PL_Texture_CreateFromSurface(surface, hasAlphaChannel);
+    }
+    
+    return textureRefID;
+}
+
 int PL_Graph_CreateFromSurface(SDL_Surface *surface, int hasAlphaChannel) {
     int textureRefID;
     int graphID;
     SDL_Rect rect;
     
-    textureRefID = PL_Texture_CreateFromSurface(surface, hasAlphaChannel);
+    textureRefID = s_CreateTextureFromSurface(surface, hasAlphaChannel);
     if (textureRefID < 0) {
         return -1;
     }
@@ -165,6 +191,47 @@ int PL_Graph_CreateFromSurface(SDL_Surface *surface, int hasAlphaChannel) {
     return graphID;
 }
 
+/* Makes a single texture out of surface, and a graph for each of rects,
+ * without going through a graph for the whole thing first.
+ * The new graphs are linked to each other, and to linkToGraphID if it's
+ * given, so DeleteSharingGraph gets rid of all of them at once. */
+int PL_Graph_CreateDivFromSurface(SDL_Surface *surface, int hasAlphaChannel,
+                                  const SDL_Rect *rects, int count,
+                                  int linkToGraphID, int *handleBuf) {
+    int textureRefID;
+    int i;
+    
+    if (count <= 0) {
+        return -1;
+    }
+    
+    textureRefID = s_CreateTextureFromSurface(surface, hasAlphaChannel);
+    if (textureRefID < 0) {
+        return -1;
+    }
+    
+    for (i = 0; i < count; ++i) {
+        handleBuf[i] = s_AllocateGraphID(textureRefID, rects[i], linkToGraphID);
+        if (handleBuf[i] < 0) {
+            break;
+        }
+        linkToGraphID = handleBuf[i];
+    }
+    
+    if (i < count) {
+        /* The last graph to go takes the texture with it. */
+        if (i == 0) {
+            PL_Texture_Release(textureRefID);
+        }
+        while (i-- > 0) {
+            PL_Graph_Delete(handleBuf[i]);
+        }
+        return -1;
+    }
+    
+    return 0;
+}
+
 int PL_Graph_MakeScreen(int width, int height, int hasAlphaChannel) {
     int textureRefID;
     int graphID;
@@ -189,73 +256,40 @@ int PL_Graph_MakeScreen(int width, int height, int hasAlphaChannel) {
     return graphID;
 }
 
-
-int s_FlipSurface(SDL_Surface *surface) {
-    int w = surface->w;
-    int h = surface->h;
-    int pitch = surface->pitch;
-    int x, y;
-    unsigned char *pixels = surface->pixels;
-    
-    /* Unrolled because we want this fast-ish. */
-    switch(surface->format->BytesPerPixel) {
-        case 1:
-            for (y = h; y > 0; --y) {
-                unsigned char *dest = pixels;
-                unsigned char *src = pixels + w - 1;
-                for (x = w; x >= 0; --x) {
-                    dest[w-x] = src[x];
-                }
-                
-                pixels += pitch;
-            } 
-            break;
-        case 2:
-            for (y = h; y > 0; --y) {
-                unsigned short *dest = (unsigned short *)pixels;
-                unsigned short *src = (unsigned short *)pixels + (w - 1);
-                for (x = w - 1; x >= 0; --x) {
-                    dest[w-x] = src[x];
-                }
-                
-                pixels += pitch;
-            } 
-            break;
-        case 3:
-            for (y = h; y > 0; --y) {
-                unsigned char *dest = pixels;
-                unsigned char *src = pixels + ((w - 1) * 3);
-                for (x = w; x > 0; --x) {
-                    dest[0] = src[0]; dest[1] = src[1]; dest[2] = src[2];
-                    dest += 3; src -= 3;
-                }
-                
-                pixels += pitch;
-            } 
-            break;
-        case 4:
-            for (y = h; y > 0; --y) {
-                unsigned int *dest = (unsigned int *)pixels;
-                unsigned int *src = (unsigned int *)pixels + (w - 1);
-                for (x = w - 1; x >= 0; --x) {
-                    dest[w-x] = src[x];
-                }
-                
-                pixels += pitch;
-            } 
-            break;
+/* Decodes an image file, trying the built-in formats before SDL2_image.
+ * Frees file. dOpaqueFlag is set for 32bpp surfaces that have no alpha
+ * of their own, which the transparent color still applies to. */
+static SDL_Surface *s_LoadImage_RW(SDL_RWops *file, int *dOpaqueFlag) {
+    int hasAlphaChannel = DXTRUE;
+    SDL_Surface *surface;
+    
+    if (PL_QOI_IsQOI_RW(file)) {
+        surface = PL_QOI_Load_RW(file, SDL_TRUE, &hasAlphaChannel);
+    } else {
+        surface = IMG_Load_RW(file, SDL_TRUE);
     }
     
-    return 0;
+    *dOpaqueFlag = hasAlphaChannel ? DXFALSE : DXTRUE;
+    
+    return surface;
 }
 
-static int s_GenericGraphLoad(SDL_Surface *surface, int flipFlag) {
-    int graphID;
+/* Gets a freshly loaded surface ready to become a texture.
+ * Takes ownership of surface, and returns the one to use instead,
+ * or NULL on failure. */
+static SDL_Surface *s_PrepareSurface(SDL_Surface *surface, int flipFlag, int opaqueFlag,
+                                     int useTransparency, unsigned int transparentColor,
+                                     int *dHasAlphaChannel) {
     int hasAlphaChannel = DXFALSE;
     
     /* Convert to 32bpp from 24bpp. */
     if (surface->format->BitsPerPixel == 32) {
-        hasAlphaChannel = DXTRUE;
+        if (opaqueFlag) {
+            hasAlphaChannel = s_ApplyTransparentColor(surface, useTransparency,
+                                                      transparentColor);
+        } else {
+            hasAlphaChannel = DXTRUE;
+        }
     } else if (surface->format->BitsPerPixel == 24) {
         SDL_Surface *newSurface;
         newSurface = SDL_ConvertSurfaceFormat(
@@ -263,17 +297,34 @@ static int s_GenericGraphLoad(SDL_Surface *surface, int flipFlag) {
         SDL_FreeSurface(surface);
         
         if (newSurface == NULL) {
-            return -1;
+            return NULL;
         }
         
         surface = newSurface;
-        hasAlphaChannel = s_ApplyTransparentColor(surface);
+        hasAlphaChannel = s_ApplyTransparentColor(surface, useTransparency,
+                                                  transparentColor);
     } else if (surface->format->BitsPerPixel == 8) {
-        hasAlphaChannel = s_ApplyTransparentColor(surface);
+        hasAlphaChannel = s_ApplyTransparentColor(surface, useTransparency,
+                                                  transparentColor);
     }
     
     if (flipFlag) {
-        s_FlipSurface(surface);
+        PL_Surface_FlipHorizontal(surface);
+    }
+    
+    *dHasAlphaChannel = hasAlphaChannel;
+    
+    return surface;
+}
+
+static int s_GenericGraphLoad(SDL_Surface *surface, int flipFlag, int opaqueFlag) {
+    int graphID;
+    int hasAlphaChannel = DXFALSE;
+    
+    surface = s_PrepareSurface(surface, flipFlag, opaqueFlag, s_useTransparency,
+                               s_transparentColor, &hasAlphaChannel);
+    if (surface == NULL) {
+        return -1;
     }
     
     graphID = PL_Graph_CreateFromSurface(surface, hasAlphaChannel);
@@ -283,9 +334,443 @@ static int s_GenericGraphLoad(SDL_Surface *surface, int flipFlag) {
     return graphID;
 }
 
-int PL_Graph_Load(const DXCHAR *filename, int flipFlag) {
+/* Everything that can change what an image file turns into.
+ * These are captured when a load starts. */
+typedef struct GraphLoadSettings {
+    int flipFlag;
+    int useTransparency;
+    unsigned int transparentColor;
+    int colorBitDepth;
+    int ditherFlag;
+    
+    /* Names the graph cache entry, if there is a cache. */
+    Uint64 cacheNameHash;
+} GraphLoadSettings;
+
+static void s_GetLoadSettings(GraphLoadSettings *settings,
+                              const DXCHAR *filename, int flipFlag) {
+    settings->flipFlag = flipFlag;
+    settings->useTransparency = s_useTransparency;
+    settings->transparentColor = s_transparentColor;
+    settings->colorBitDepth = PL_Graph_GetColorBitDepth();
+    settings->ditherFlag = s_graphDitherFlag;
+    settings->cacheNameHash = 0;
+    
+    /* Images from memory have no name, so they aren't cached. */
+    if (PL_GraphCache_IsEnabled() && filename != NULL) {
+        char utf8Buf[2048];
+        Uint32 values[6];
+        int len;
+        
+        len = PL_Text_DxStringToString(filename, utf8Buf, 2048, DX_CHARSET_EXT_UTF8);
+        
+        values[0] = (Uint32)flipFlag;
+        values[1] = (Uint32)s_useTransparency;
+        values[2] = s_transparentColor;
+        values[3] = (Uint32)settings->colorBitDepth;
+        values[4] = (Uint32)s_graphDitherFlag;
+        values[5] = (Uint32)PL_Texture_HasPaletteSupport();
+        
+        settings->cacheNameHash = PL_GraphCache_Hash(
+            values, sizeof(values), PL_GraphCache_Hash(utf8Buf, (size_t)len, 0));
+    }
+}
+
+/* Loading a file that's already loaded, with the same settings, just
+ * makes another graph for the same texture, as textures are refcounted
+ * anyway. Entries go away along with their textures. */
+typedef struct SharedGraph {
+    DXCHAR *filename;
+    GraphLoadSettings settings;
+    
+    int textureRefID;
+    int width;
+    int height;
+    
+    struct SharedGraph *next;
+} SharedGraph;
+
+static SharedGraph *s_sharedGraphs = NULL;
+
+/* Filenames are compared as given, except that / and \ are the same,
+ * and so are runs of them. Nothing else about the path is resolved. */
+static int s_IsSameFilename(const DXCHAR *a, const DXCHAR *b) {
+    unsigned int chA, chB;
+    
+    do {
+        chA = PL_Text_ReadDxChar(&a);
+        chB = PL_Text_ReadDxChar(&b);
+        
+        if (chA == '\\') {
+            chA = '/';
+        }
+        if (chB == '\\') {
+            chB = '/';
+        }
+        if (chA != chB) {
+            return DXFALSE;
+        }
+        
+        if (chA == '/') {
+            while (*a == '/' || *a == '\\') {
+                PL_Text_ReadDxChar(&a);
+            }
+            while (*b == '/' || *b == '\\') {
+                PL_Text_ReadDxChar(&b);
+            }
+        }
+    } while (chA != 0);
+    
+    return DXTRUE;
+}
+
+static SharedGraph *s_FindSharedGraph(const DXCHAR *filename,
+                                      const GraphLoadSettings *settings) {
+    SharedGraph *shared;
+    
+    for (shared = s_sharedGraphs; shared != NULL; shared = shared->next) {
+        if (shared->settings.flipFlag == settings->flipFlag
+            && shared->settings.useTransparency == settings->useTransparency
+            && shared->settings.transparentColor == settings->transparentColor
+            && shared->settings.colorBitDepth == settings->colorBitDepth
+            && shared->settings.ditherFlag == settings->ditherFlag
+            && s_IsSameFilename(shared->filename, filename)
+        ) {
+            return shared;
+        }
+    }
+    
+    return NULL;
+}
+
+static void s_AddSharedGraph(const DXCHAR *filename, const GraphLoadSettings *settings,
+                             int textureRefID, int width, int height) {
+    SharedGraph *shared;
+    
+    if (s_FindSharedGraph(filename, settings) != NULL) {
+        return;
+    }
+    
+    shared = (SharedGraph *)DXALLOC(sizeof(SharedGraph));
+    if (shared == NULL) {
+        return;
+    }
+    
+    shared->filename = DXSTRDUP(filename);
+    shared->settings = *settings;
+    shared->textureRefID = textureRefID;
+    shared->width = width;
+    shared->height = height;
+    shared->next = s_sharedGraphs;
+    s_sharedGraphs = shared;
+}
+
+/* Called once a texture is gone, before its ID can be reused. */
+static void s_RemoveSharedGraphs(int textureRefID) {
+    SharedGraph **link = &s_sharedGraphs;
+    
+    while (*link != NULL) {
+        SharedGraph *shared = *link;
+        
+        if (shared->textureRefID == textureRefID) {
+            *link = shared->next;
+            DXFREE(shared->filename);
+            DXFREE(shared);
+        } else {
+            link = &shared->next;
+        }
+    }
+}
+
+/* Turns a whole image file into the surface its texture is made from:
+ * decoded, keyed, flipped and packed. With a graph cache, all of that
+ * only happens the first time. ASyncLoad's workers use this too. */
+static SDL_Surface *s_DecodeGraphData(const unsigned char *fileData, unsigned int fileSize,
+                                      const GraphLoadSettings *settings,
+                                      int *dHasAlphaChannel) {
+    GraphCacheKey key;
     SDL_RWops *file;
+    SDL_Surface *surface, *packedSurface;
+    int hasAlphaChannel = DXFALSE;
+    int opaqueFlag = DXFALSE;
+    int useCache = (PL_GraphCache_IsEnabled() && settings->cacheNameHash != 0);
+    
+    if (useCache) {
+        key.nameHash = settings->cacheNameHash;
+        key.contentHash = PL_GraphCache_Hash(fileData, fileSize, 0);
+        key.contentSize = fileSize;
+        
+        surface = PL_GraphCache_Load(&key, dHasAlphaChannel);
+        if (surface != NULL) {
+            return surface;
+        }
+    }
+    
+    /* QOI is decoded straight from memory, without a stream. */
+    if (PL_QOI_IsQOI(fileData, fileSize)) {
+        surface = PL_QOI_Decode(fileData, fileSize, &hasAlphaChannel);
+        opaqueFlag = hasAlphaChannel ? DXFALSE : DXTRUE;
+    } else {
+        file = SDL_RWFromConstMem(fileData, (int)fileSize);
+        if (file == NULL) {
+            return NULL;
+        }
+        
+        surface = IMG_Load_RW(file, SDL_TRUE);
+    }
+    if (surface == NULL) {
+        return NULL;
+    }
+    
+    surface = s_PrepareSurface(surface, settings->flipFlag, opaqueFlag,
+                               settings->useTransparency, settings->transparentColor,
+                               &hasAlphaChannel);
+    if (surface == NULL) {
+        return NULL;
+    }
+    
+    packedSurface = s_PackSurface(surface, hasAlphaChannel,
+                                  settings->colorBitDepth, settings->ditherFlag);
+    if (packedSurface != NULL) {
+        SDL_FreeSurface(surface);
+        surface = packedSurface;
+    }
+    
+    if (useCache) {
+        PL_GraphCache_Save(&key, surface, hasAlphaChannel);
+    }
+    
+    *dHasAlphaChannel = hasAlphaChannel;
+    
+    return surface;
+}
+
+/* Makes a graph out of a whole image file that's already in memory. */
+static int s_GraphFromData(const unsigned char *fileData, unsigned int fileSize,
+                           const GraphLoadSettings *settings) {
     SDL_Surface *surface;
+    int hasAlphaChannel = DXFALSE;
+    int textureRefID;
+    int graphID;
+    SDL_Rect rect;
+    
+    surface = s_DecodeGraphData(fileData, fileSize, settings, &hasAlphaChannel);
+    if (surface == NULL) {
+        return -1;
+    }
+    
+    /* Already packed, so this goes straight to the texture. */
+    textureRefID = PL_Texture_CreateFromSurface(surface, hasAlphaChannel);
+    rect.x = 0;
+    rect.y = 0;
+    rect.w = surface->w;
+    rect.h = surface->h;
+    SDL_FreeSurface(surface);
+    if (textureRefID < 0) {
+        return -1;
+    }
+    
+    graphID = s_AllocateGraphID(textureRefID, rect, -1);
+    if (graphID < 0) {
+        PL_Texture_Release(textureRefID);
+    }
+    
+    return graphID;
+}
+
+/* With a graph cache, the whole file is needed up front to check
+ * it against the cache entry. */
+static int s_CachedGraphLoad(const DXCHAR *filename, int flipFlag) {
+    GraphLoadSettings settings;
+    const unsigned char *borrowedData;
+    unsigned char *fileData;
+    unsigned int fileSize;
+    int graphID;
+    
+    s_GetLoadSettings(&settings, filename, flipFlag);
+    
+    if (PL_File_BorrowFile(filename, &borrowedData, &fileSize) == 0) {
+        return s_GraphFromData(borrowedData, fileSize, &settings);
+    }
+    
+    if (PL_File_ReadFile(filename, &fileData, &fileSize) < 0) {
+        return -1;
+    }
+    
+    graphID = s_GraphFromData(fileData, fileSize, &settings);
+    DXFREE(fileData);
+    
+    return graphID;
+}
+
+#ifndef DX_NON_ASYNCLOAD
+/* An asynchronous load reads the whole file in first, on the main thread,
+ * as archive streams can't be shared between threads. Everything from
+ * there up to the texture upload is done by ASyncLoad's workers, and
+ * with a loader context, the upload too. */
+typedef struct GraphASyncLoad {
+    unsigned char *fileData;
+    unsigned int fileSize;
+    
+    GraphLoadSettings settings;
+    
+    /* Set if the texture should be shared with later loads. */
+    DXCHAR *filename;
+    
+    SDL_Surface *surface;
+    int hasAlphaChannel;
+    
+    PreparedTexture *prepared;
+} GraphASyncLoad;
+
+static int s_imageLoadersReady = DXFALSE;
+
+static int s_ASyncGraphDecode(void *data) {
+    GraphASyncLoad *load = (GraphASyncLoad *)data;
+    
+    load->surface = s_DecodeGraphData(load->fileData, load->fileSize,
+                                      &load->settings, &load->hasAlphaChannel);
+    
+    return (load->surface != NULL) ? 0 : -1;
+}
+
+static void s_ASyncGraphUpload(void *data) {
+    GraphASyncLoad *load = (GraphASyncLoad *)data;
+    
+    /* If this can't be done here, finishing will do it the usual way. */
+    load->prepared = PL_Texture_PrepareFromSurface(load->surface, load->hasAlphaChannel);
+}
+
+static int s_ASyncGraphFinish(void *data, int result,
+                              const int *handles, int handleCount) {
+    GraphASyncLoad *load = (GraphASyncLoad *)data;
+    int textureRefID = -1;
+    int i;
+    
+    /* The surface has already been packed, if it was going to be. */
+    if (load->prepared != NULL) {
+        if (handleCount > 0) {
+            textureRefID = PL_Texture_CreateFromPrepared(load->prepared);
+        } else {
+            PL_Texture_ReleasePrepared(load->prepared);
+        }
+    } else if (result == 0 && handleCount > 0) {
+        textureRefID = PL_Texture_CreateFromSurface(load->surface, load->hasAlphaChannel);
+    }
+    
+    if (textureRefID >= 0) {
+        for (i = 0; i < handleCount; ++i) {
+            Graph *graph = s_GetGraph(handles[i]);
+            if (graph == NULL) {
+                continue;
+            }
+            
+            /* Only the graph from LoadGraph itself still has no size.
+             * Ones derived from it already have theirs. */
+            if (graph->rect.w == 0 && graph->rect.h == 0) {
+                graph->rect.w = load->surface->w;
+                graph->rect.h = load->surface->h;
+            }
+            graph->textureRefID = textureRefID;
+            PL_Texture_AddRef(textureRefID);
+        }
+        
+        if (load->filename != NULL) {
+            s_AddSharedGraph(load->filename, &load->settings, textureRefID,
+                             load->surface->w, load->surface->h);
+        }
+    }
+    
+    if (load->surface != NULL) {
+        SDL_FreeSurface(load->surface);
+    }
+    if (load->filename != NULL) {
+        DXFREE(load->filename);
+    }
+    DXFREE(load->fileData);
+    DXFREE(load);
+    
+    return (textureRefID >= 0 || handleCount == 0) ? 0 : -1;
+}
+
+/* The graph handed back has no texture, and so draws nothing,
+ * until ASyncLoad finishes it. */
+static int s_ASyncGraphLoad(const DXCHAR *filename, int flipFlag) {
+    GraphASyncLoad *load;
+    int graphID;
+    SDL_Rect rect;
+    
+    load = DXALLOC(sizeof(GraphASyncLoad));
+    if (load == NULL) {
+        return -1;
+    }
+    
+    if (PL_File_ReadFile(filename, &load->fileData, &load->fileSize) < 0) {
+        DXFREE(load);
+        return -1;
+    }
+    
+    s_GetLoadSettings(&load->settings, filename, flipFlag);
+    load->filename = s_shareLoadedGraphFlag ? DXSTRDUP(filename) : NULL;
+    load->surface = NULL;
+    load->hasAlphaChannel = DXFALSE;
+    load->prepared = NULL;
+    
+    /* IMG_Init isn't safe to race, so do it here before any worker can. */
+    if (s_imageLoadersReady == DXFALSE) {
+        IMG_Init(IMG_INIT_JPG | IMG_INIT_PNG | IMG_INIT_TIF | IMG_INIT_WEBP);
+        s_imageLoadersReady = DXTRUE;
+    }
+    
+    rect.x = 0;
+    rect.y = 0;
+    rect.w = 0;
+    rect.h = 0;
+    graphID = s_AllocateGraphID(-1, rect, -1);
+    if (graphID < 0
+        || PL_ASyncLoad_Start(graphID, s_ASyncGraphDecode, s_ASyncGraphUpload,
+                              s_ASyncGraphFinish, load) < 0
+    ) {
+        if (graphID >= 0) {
+            PL_Graph_Delete(graphID);
+        }
+        if (load->filename != NULL) {
+            DXFREE(load->filename);
+        }
+        DXFREE(load->fileData);
+        DXFREE(load);
+        return -1;
+    }
+    
+    return graphID;
+}
+#endif /* #ifndef DX_NON_ASYNCLOAD */
+
+static int s_LoadGraph(const DXCHAR *filename, int flipFlag, int asyncFlag) {
+    SDL_RWops *file;
+    SDL_Surface *surface;
+    const unsigned char *fileData;
+    unsigned int fileSize;
+    int opaqueFlag;
+    
+#ifndef DX_NON_ASYNCLOAD
+    if (asyncFlag == DXTRUE) {
+        return s_ASyncGraphLoad(filename, flipFlag);
+    }
+#endif
+    
+    if (PL_GraphCache_IsEnabled()) {
+        return s_CachedGraphLoad(filename, flipFlag);
+    }
+    
+    /* Files in preloaded archives are decoded right where they are. */
+    if (PL_File_BorrowFile(filename, &fileData, &fileSize) == 0) {
+        GraphLoadSettings settings;
+        
+        s_GetLoadSettings(&settings, filename, flipFlag);
+        
+        return s_GraphFromData(fileData, fileSize, &settings);
+    }
     
     /* Open file stream. */
     file = PL_File_OpenStream(filename);
@@ -293,13 +778,136 @@ int PL_Graph_Load(const DXCHAR *filename, int flipFlag) {
         return -1;
     }
 
-    /* Attempt to load surface via SDL2_image */
-    surface = IMG_Load_RW(file, SDL_TRUE);
+    /* Attempt to load surface via the built-in decoders or SDL2_image */
+    surface = s_LoadImage_RW(file, &opaqueFlag);
     if (surface == NULL) {
         return -1;
     }
     
-    return s_GenericGraphLoad(surface, flipFlag);
+    return s_GenericGraphLoad(surface, flipFlag, opaqueFlag);
+}
+
+static int s_LoadSharedGraph(const DXCHAR *filename, int flipFlag, int asyncFlag) {
+    GraphLoadSettings settings;
+    SharedGraph *shared;
+    Graph *graph;
+    int graphID;
+    
+    if (s_shareLoadedGraphFlag == DXFALSE) {
+        return s_LoadGraph(filename, flipFlag, asyncFlag);
+    }
+    
+    s_GetLoadSettings(&settings, filename, flipFlag);
+    
+    shared = s_FindSharedGraph(filename, &settings);
+    if (shared != NULL) {
+        SDL_Rect rect;
+        
+        rect.x = 0;
+        rect.y = 0;
+        rect.w = shared->width;
+        rect.h = shared->height;
+        
+        return s_AllocateGraphID(shared->textureRefID, rect, -1);
+    }
+    
+    graphID = s_LoadGraph(filename, flipFlag, asyncFlag);
+    
+    /* Asynchronous loads add theirs once they're done. */
+    graph = s_GetGraph(graphID);
+    if (graph != NULL && graph->textureRefID >= 0) {
+        s_AddSharedGraph(filename, &settings, graph->textureRefID,
+                         graph->rect.w, graph->rect.h);
+    }
+    
+    return graphID;
+}
+
+int PL_Graph_Load(const DXCHAR *filename, int flipFlag) {
+    int asyncFlag = DXFALSE;
+
+#ifndef DX_NON_ASYNCLOAD
+    asyncFlag = PL_ASyncLoad_GetUseFlag();
+#endif
+    
+    return s_LoadSharedGraph(filename, flipFlag, asyncFlag);
+}
+
+/* Makes a graph from a whole image file in memory, decoding it
+ * right where it is. data is not kept, and isn't copied either.
+ * This is always synchronous, as the caller's buffer isn't
+ * promised to outlive the call. */
+int PL_Graph_CreateFromMem(const void *data, unsigned int size, int flipFlag) {
+    GraphLoadSettings settings;
+    
+    if (data == NULL || size == 0) {
+        return -1;
+    }
+    
+    s_GetLoadSettings(&settings, NULL, flipFlag);
+    
+    return s_GraphFromData((const unsigned char *)data, size, &settings);
+}
+
+/* Every file is started as an asynchronous load, whether or not those
+ * are turned on, so ASyncLoad's workers decode them all at once.
+ * The files themselves are still read here, as archive streams can't
+ * be shared between threads. Then they're waited on in order, so the
+ * textures are made in the same order as the list.
+ * Returns how many failed; their handles are set to -1. */
+int PL_Graph_LoadBatch(const DXCHAR **filenames, int count, int *handleBuf,
+                       int *dLoadTime) {
+    Uint64 start = SDL_GetPerformanceCounter();
+    int failedCount = 0;
+    int i;
+    
+    if (count < 0 || (count > 0 && (filenames == NULL || handleBuf == NULL))) {
+        return -1;
+    }
+    
+#ifndef DX_NON_ASYNCLOAD
+    PL_ASyncLoad_ReserveThreads(count);
+#endif
+    
+    for (i = 0; i < count; ++i) {
+        handleBuf[i] = s_LoadSharedGraph(filenames[i], DXFALSE, DXTRUE);
+    }
+    
+    for (i = 0; i < count; ++i) {
+        Graph *graph;
+
+#ifndef DX_NON_ASYNCLOAD
+        PL_ASyncLoad_WaitHandle(handleBuf[i]);
+#endif
+        
+        /* A failed decode leaves the graph without a texture. */
+        graph = s_GetGraph(handleBuf[i]);
+        if (graph == NULL || graph->textureRefID < 0) {
+            if (graph != NULL) {
+                PL_Graph_Delete(handleBuf[i]);
+            }
+            handleBuf[i] = -1;
+            failedCount += 1;
+        }
+    }
+    
+    if (dLoadTime != NULL) {
+        *dLoadTime = (int)((SDL_GetPerformanceCounter() - start) * 1000
+                           / SDL_GetPerformanceFrequency());
+    }
+    
+    return failedCount;
+}
+
+/* Called before anything writes into a graph's texture, so later loads
+ * of its file don't pick up the changed pixels. Graphs already sharing
+ * the texture still see the change. */
+void PL_Graph_StopSharing(int graphID) {
+    Graph *graph = s_GetGraph(graphID);
+    
+    if (graph != NULL && graph->textureRefID >= 0) {
+        s_RemoveSharedGraphs(graph->textureRefID);
+    }
 }
 
 int PL_Graph_FromTexture(int textureRefID, SDL_Rect rect) {
@@ -327,6 +935,15 @@ int PL_Graph_Delete(int graphID) {
     }
     
     PL_Texture_Release(graph->textureRefID);
+    if (graph->textureRefID >= 0
+        && PL_Handle_GetData(graph->textureRefID, DXHANDLE_TEXTURE) == NULL
+    ) {
+        s_RemoveSharedGraphs(graph->textureRefID);
+    }
+    
+#ifndef DX_NON_ASYNCLOAD
+    PL_ASyncLoad_ReleaseHandle(graphID);
+#endif
     
     PL_Handle_ReleaseID(graphID, DXTRUE);
     
@@ -378,6 +995,7 @@ int PL_Graph_GetSize(int graphID, int *w, int *h) {
 int PL_Graph_Derivation(int x, int y, int w, int h, int srcGraphID) {
     Graph *srcGraph;
     SDL_Rect rect;
+    int graphID;
     
     srcGraph = s_GetGraph(srcGraphID);
     if (srcGraph == NULL) {
@@ -390,7 +1008,16 @@ int PL_Graph_Derivation(int x, int y, int w, int h, int srcGraphID) {
     rect.w = w;
     rect.h = h;
     
-    return s_AllocateGraphID(srcGraph->textureRefID, rect, srcGraphID);
+    graphID = s_AllocateGraphID(srcGraph->textureRefID, rect, srcGraphID);
+
+#ifndef DX_NON_ASYNCLOAD
+    /* Still loading? Then this one gets its texture at the same time. */
+    if (graphID >= 0 && srcGraph->textureRefID < 0) {
+        PL_ASyncLoad_ShareHandle(srcGraphID, graphID);
+    }
+#endif
+    
+    return graphID;
 }
 
 int PL_Graph_LoadDiv(const DXCHAR *filename, int graphCount,
@@ -416,6 +1043,53 @@ int PL_Graph_LoadDiv(const DXCHAR *filename, int graphCount,
     return 0;
 }
 
+/* Palettes only exist for 8-bit images the renderer kept as 8-bit.
+ * Graphs derived from the same image share the same palette. */
+int PL_Graph_SetPalette(int graphID, int colorIndex, DXCOLOR color) {
+    Graph *graph = s_GetGraph(graphID);
+    Uint32 rgb;
+    if (graph == NULL) {
+        return -1;
+    }
+    
+    rgb = ((color & 0xff) << 16) | (color & 0xff00) | ((color >> 16) & 0xff);
+    
+    PL_Graph_StopSharing(graphID);
+    
+    return PL_Texture_SetPaletteColor(graph->textureRefID, colorIndex, rgb);
+}
+
+int PL_Graph_GetPalette(int graphID, int colorIndex, int originalFlag,
+                        int *r, int *g, int *b) {
+    Graph *graph = s_GetGraph(graphID);
+    Uint32 rgb;
+    if (graph == NULL) {
+        return -1;
+    }
+    
+    if (PL_Texture_GetPaletteColor(graph->textureRefID, colorIndex,
+                                   originalFlag, &rgb) < 0) {
+        return -1;
+    }
+    
+    *r = (rgb >> 16) & 0xff;
+    *g = (rgb >> 8) & 0xff;
+    *b = rgb & 0xff;
+    
+    return 0;
+}
+
+int PL_Graph_ResetPalette(int graphID) {
+    Graph *graph = s_GetGraph(graphID);
+    if (graph == NULL) {
+        return -1;
+    }
+    
+    PL_Graph_StopSharing(graphID);
+    
+    return PL_Texture_ResetPalette(graph->textureRefID);
+}
+
 int PL_Graph_InitGraph() {
     int graphID;
     
@@ -442,9 +1116,40 @@ int PL_Graph_SetUseTransColor(int flag) {
     return 0;
 }
 
+int PL_Graph_SetColorBitDepth(int colorBitDepth) {
+    if (colorBitDepth != 0 && colorBitDepth != 16 && colorBitDepth != 32) {
+        return -1;
+    }
+    
+    s_graphColorBitDepth = colorBitDepth;
+    return 0;
+}
+int PL_Graph_GetColorBitDepth() {
+    /* 0 means to follow the screen. */
+    if (s_graphColorBitDepth == 0) {
+        return PL_Window_GetColorDepth();
+    }
+    return s_graphColorBitDepth;
+}
+
+int PL_EXT_Graph_SetDitherFlag(int flag) {
+    s_graphDitherFlag = (flag == 0) ? DXFALSE : DXTRUE;
+    return 0;
+}
+
+int PL_EXT_Graph_SetShareLoadedFlag(int flag) {
+    s_shareLoadedGraphFlag = (flag == 0) ? DXFALSE : DXTRUE;
+    return 0;
+}
+
 int PL_Graph_ResetSettings() {
     s_transparentColor = 0x000000;
     s_useTransparency = DXTRUE;
+    s_graphColorBitDepth = 0;
+    s_graphDitherFlag = DXFALSE;
+    s_shareLoadedGraphFlag = DXFALSE;
+    
+    PL_EXT_GraphCache_SetDirectory(NULL);
     
     return 0;
 }
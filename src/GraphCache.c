@@ -0,0 +1,339 @@
+/*
+  DxPortLib - A portability library for DxLib-based software.
+  Copyright (C) 2013 Patrick McCarthy <mauve@sandwich.net>
+  
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+  
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+    
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required. 
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include "DxInternal.h"
+
+/* DxPortLib extension: on-disk cache of decoded images.
+ *
+ * Decoding PNGs and JPEGs is most of what LoadGraph spends its time on,
+ * and it's the same work every launch. With a cache directory set, the
+ * surface that would have been uploaded (keyed, flipped and packed) is
+ * written out as-is, and read straight back into a surface next time.
+ *
+ * Each entry is named after the image's path and the load settings.
+ * Its header holds a hash of the source file, so an entry for a file
+ * that has since changed is just a miss, and gets written over.
+ * SDL has no way to get file times, and archive entries don't have
+ * them anyway, so the file contents are what's checked.
+ *
+ * Entries are written in place, with the magic number going in last,
+ * so one that was never finished is also just a miss.
+ *
+ * ASyncLoad's workers load and save entries too, and two of them can be
+ * decoding the same file at once. So each entry is only ever opened
+ * under its lock, one of a small set picked by the entry's name; that
+ * way one worker can't truncate an entry another is writing or reading.
+ */
+
+#define GRAPHCACHE_VERSION      1
+#define GRAPHCACHE_PATH_MAX     2048
+#define GRAPHCACHE_LOCK_COUNT   16
+
+typedef struct GraphCacheHeader {
+    char magic[4];
+    Uint32 version;
+    
+    Uint64 contentHash;
+    Uint32 contentSize;
+    
+    Uint32 format;
+    Uint32 width;
+    Uint32 height;
+    Uint32 hasAlphaChannel;
+    Uint32 hasColorKey;
+    Uint32 colorKey;
+    Uint32 paletteCount;
+} GraphCacheHeader;
+
+static char s_directory[GRAPHCACHE_PATH_MAX];
+static int s_enabled = DXFALSE;
+
+/* Made the first time the cache is turned on, and kept from then on,
+ * as workers may still be holding them. */
+static SDL_mutex *s_locks[GRAPHCACHE_LOCK_COUNT];
+
+static SDL_mutex *s_GetLock(const GraphCacheKey *key) {
+    return s_locks[key->nameHash % GRAPHCACHE_LOCK_COUNT];
+}
+
+/* 64-bit FNV-1a. Pass the result back in as hash to continue it. */
+Uint64 PL_GraphCache_Hash(const void *data, size_t size, Uint64 hash) {
+    const unsigned char *p = (const unsigned char *)data;
+    const Uint64 prime = ((Uint64)0x100 << 32) | 0x1b3;
+    size_t i;
+    
+    if (hash == 0) {
+        hash = ((Uint64)0xcbf29ce4 << 32) | 0x84222325;
+    }
+    
+    for (i = 0; i < size; ++i) {
+        hash = (hash ^ p[i]) * prime;
+    }
+    
+    return hash;
+}
+
+static int s_GetEntryPath(const GraphCacheKey *key, char *buffer, int maxLen) {
+    int len = SDL_snprintf(buffer, (size_t)maxLen, "%s/%08x%08x.dxgc", s_directory,
+                           (unsigned int)(key->nameHash >> 32),
+                           (unsigned int)(key->nameHash & 0xffffffff));
+    
+    return (len < 0 || len >= maxLen) ? -1 : 0;
+}
+
+/* Only whole-byte formats are cached, which is everything Graph makes. */
+static int s_GetRowSize(Uint32 format, int width) {
+    int bytesPerPixel = SDL_BYTESPERPIXEL(format);
+    
+    if (SDL_BITSPERPIXEL(format) < 8 || bytesPerPixel < 1 || bytesPerPixel > 4) {
+        return -1;
+    }
+    
+    return width * bytesPerPixel;
+}
+
+/* Reads the palette and pixels, straight into the surface. */
+static int s_ReadSurface(SDL_RWops *file, SDL_Surface *surface,
+                         const GraphCacheHeader *header, int rowSize) {
+    Uint8 *row = (Uint8 *)surface->pixels;
+    Uint32 y;
+    
+    if (header->paletteCount > 0) {
+        SDL_Color colors[256];
+        
+        if (surface->format->palette == NULL
+            || SDL_RWread(file, colors, sizeof(SDL_Color) * header->paletteCount, 1) < 1
+        ) {
+            return -1;
+        }
+        SDL_SetPaletteColors(surface->format->palette, colors, 0,
+                             (int)header->paletteCount);
+    }
+    
+    if (surface->pitch == rowSize) {
+        if (header->height > 0
+            && SDL_RWread(file, row, (size_t)rowSize * header->height, 1) < 1
+        ) {
+            return -1;
+        }
+        return 0;
+    }
+    
+    for (y = 0; y < header->height; ++y) {
+        if (SDL_RWread(file, row, (size_t)rowSize, 1) < 1) {
+            return -1;
+        }
+        row += surface->pitch;
+    }
+    
+    return 0;
+}
+
+static SDL_Surface *s_LoadEntry(const GraphCacheKey *key, int *dHasAlphaChannel) {
+    char path[GRAPHCACHE_PATH_MAX + 32];
+    GraphCacheHeader header;
+    SDL_RWops *file;
+    SDL_Surface *surface;
+    Uint32 rmask, gmask, bmask, amask;
+    int bpp, rowSize;
+    
+    if (s_enabled == DXFALSE || s_GetEntryPath(key, path, sizeof(path)) < 0) {
+        return NULL;
+    }
+    
+    file = SDL_RWFromFile(path, "rb");
+    if (file == NULL) {
+        return NULL;
+    }
+    
+    if (SDL_RWread(file, &header, sizeof(header), 1) < 1
+        || SDL_memcmp(header.magic, "DXGC", 4) != 0
+        || header.version != GRAPHCACHE_VERSION
+        || header.contentHash != key->contentHash
+        || header.contentSize != key->contentSize
+        || header.paletteCount > 256
+        || (rowSize = s_GetRowSize(header.format, (int)header.width)) < 0
+        || SDL_PixelFormatEnumToMasks(header.format, &bpp,
+                                      &rmask, &gmask, &bmask, &amask) == SDL_FALSE
+    ) {
+        SDL_RWclose(file);
+        return NULL;
+    }
+    
+    surface = SDL_CreateRGBSurface(0, (int)header.width, (int)header.height, bpp,
+                                   rmask, gmask, bmask, amask);
+    if (surface == NULL) {
+        SDL_RWclose(file);
+        return NULL;
+    }
+    
+    if (s_ReadSurface(file, surface, &header, rowSize) < 0) {
+        SDL_FreeSurface(surface);
+        SDL_RWclose(file);
+        return NULL;
+    }
+    
+    SDL_RWclose(file);
+    
+    if (header.hasColorKey) {
+        SDL_SetColorKey(surface, SDL_TRUE, header.colorKey);
+    }
+    
+    *dHasAlphaChannel = header.hasAlphaChannel ? DXTRUE : DXFALSE;
+    
+    return surface;
+}
+
+static int s_SaveEntry(const GraphCacheKey *key, SDL_Surface *surface,
+                       int hasAlphaChannel) {
+    char path[GRAPHCACHE_PATH_MAX + 32];
+    GraphCacheHeader header;
+    SDL_Palette *palette = surface->format->palette;
+    SDL_RWops *file;
+    const Uint8 *row;
+    int rowSize;
+    int y;
+    
+    if (s_enabled == DXFALSE || s_GetEntryPath(key, path, sizeof(path)) < 0) {
+        return -1;
+    }
+    
+    rowSize = s_GetRowSize(surface->format->format, surface->w);
+    if (rowSize < 0) {
+        return -1;
+    }
+    
+    SDL_memset(&header, 0, sizeof(header));
+    header.version = GRAPHCACHE_VERSION;
+    header.contentHash = key->contentHash;
+    header.contentSize = key->contentSize;
+    header.format = surface->format->format;
+    header.width = (Uint32)surface->w;
+    header.height = (Uint32)surface->h;
+    header.hasAlphaChannel = hasAlphaChannel ? 1 : 0;
+    header.hasColorKey = (SDL_GetColorKey(surface, &header.colorKey) >= 0) ? 1 : 0;
+    header.paletteCount = (palette != NULL) ? (Uint32)palette->ncolors : 0;
+    
+    file = SDL_RWFromFile(path, "wb");
+    if (file == NULL) {
+        return -1;
+    }
+    
+    if (SDL_RWwrite(file, &header, sizeof(header), 1) < 1
+        || (palette != NULL
+            && SDL_RWwrite(file, palette->colors,
+                           sizeof(SDL_Color) * palette->ncolors, 1) < 1)
+    ) {
+        SDL_RWclose(file);
+        return -1;
+    }
+    
+    row = (const Uint8 *)surface->pixels;
+    for (y = 0; y < surface->h; ++y) {
+        if (SDL_RWwrite(file, row, (size_t)rowSize, 1) < 1) {
+            SDL_RWclose(file);
+            return -1;
+        }
+        row += surface->pitch;
+    }
+    
+    /* Everything is there, so now it can be marked valid. */
+    SDL_memcpy(header.magic, "DXGC", 4);
+    if (SDL_RWseek(file, 0, RW_SEEK_SET) != 0
+        || SDL_RWwrite(file, header.magic, 4, 1) < 1
+    ) {
+        SDL_RWclose(file);
+        return -1;
+    }
+    
+    SDL_RWclose(file);
+    
+    return 0;
+}
+
+SDL_Surface *PL_GraphCache_Load(const GraphCacheKey *key, int *dHasAlphaChannel) {
+    SDL_Surface *surface;
+    
+    if (s_enabled == DXFALSE) {
+        return NULL;
+    }
+    
+    SDL_LockMutex(s_GetLock(key));
+    surface = s_LoadEntry(key, dHasAlphaChannel);
+    SDL_UnlockMutex(s_GetLock(key));
+    
+    return surface;
+}
+
+int PL_GraphCache_Save(const GraphCacheKey *key, SDL_Surface *surface,
+                       int hasAlphaChannel) {
+    int retval;
+    
+    if (s_enabled == DXFALSE) {
+        return -1;
+    }
+    
+    SDL_LockMutex(s_GetLock(key));
+    retval = s_SaveEntry(key, surface, hasAlphaChannel);
+    SDL_UnlockMutex(s_GetLock(key));
+    
+    return retval;
+}
+
+int PL_GraphCache_IsEnabled() {
+    return s_enabled;
+}
+
+/* The directory has to exist already. NULL or "" turns the cache off. */
+int PL_EXT_GraphCache_SetDirectory(const DXCHAR *directory) {
+    int len;
+    int i;
+    
+    s_enabled = DXFALSE;
+    
+    if (directory == NULL || directory[0] == 0) {
+        return 0;
+    }
+    
+    for (i = 0; i < GRAPHCACHE_LOCK_COUNT; ++i) {
+        if (s_locks[i] == NULL) {
+            s_locks[i] = SDL_CreateMutex();
+            if (s_locks[i] == NULL) {
+                return -1;
+            }
+        }
+    }
+    
+    len = PL_Text_DxStringToString(directory, s_directory,
+                                   GRAPHCACHE_PATH_MAX, DX_CHARSET_EXT_UTF8);
+    if (len <= 0) {
+        return -1;
+    }
+    
+    /* Entry paths add their own separator. */
+    while (len > 1 && (s_directory[len - 1] == '/' || s_directory[len - 1] == '\\')) {
+        s_directory[--len] = '\0';
+    }
+    
+    s_enabled = DXTRUE;
+    
+    return 0;
+}
@@ -141,6 +141,492 @@ static int s_ApplyBlendMode(int blendMode, int forceBlend) {
     return 0;
 }
 
+/* -------------------------------------------------------------- SCISSOR */
+
+/* s_scissor* is the draw area given to SetDrawArea, and s_glScissor* is
+ * what GL actually has set right now.
+ *
+ * Normally these are always the same. With CPU clipping on, changing
+ * the draw area only updates s_scissor*, axis aligned quads are clipped
+ * as they are written, and GL's scissor is only brought up to date (with
+ * a flush) when something else gets drawn.
+ */
+static int s_cpuClipFlag = DXFALSE;
+static int s_cpuClipping = DXFALSE;
+
+static int s_scissorEnabled = DXFALSE;
+static int s_scissorX = 0;
+static int s_scissorY = 0;
+static int s_scissorW = 0;
+static int s_scissorH = 0;
+
+static int s_glScissorEnabled = DXFALSE;
+static int s_glScissorX = 0;
+static int s_glScissorY = 0;
+static int s_glScissorW = 0;
+static int s_glScissorH = 0;
+
+/* glScissor, for a rectangle given in draw coordinates. These only
+ * differ from the framebuffer's while dynamic resolution has shrunk
+ * the viewport, in which case the rectangle is rounded outwards. */
+static void s_ScaledScissor(int x, int y, int w, int h) {
+    if (PL_drawViewportScaleX != 1.0f || PL_drawViewportScaleY != 1.0f) {
+        int x2 = (int)SDL_ceil((x + w) * PL_drawViewportScaleX);
+        int y2 = (int)SDL_ceil((y + h) * PL_drawViewportScaleY);
+        x = (int)SDL_floor(x * PL_drawViewportScaleX);
+        y = (int)SDL_floor(y * PL_drawViewportScaleY);
+        w = x2 - x;
+        h = y2 - y;
+    }
+    
+    PL_GL.glScissor(x, y, w, h);
+}
+
+static void s_ProgramScissor(int enabled) {
+    s_glScissorEnabled = enabled;
+    s_glScissorX = s_scissorX;
+    s_glScissorY = s_scissorY;
+    s_glScissorW = s_scissorW;
+    s_glScissorH = s_scissorH;
+    
+    if (enabled == DXFALSE) {
+        PL_GL.glDisable(GL_SCISSOR_TEST);
+    } else {
+        PL_GL.glEnable(GL_SCISSOR_TEST);
+        s_ScaledScissor(s_scissorX, s_scissorY, s_scissorW, s_scissorH);
+    }
+}
+
+static void s_RefreshScissor() {
+    PL_Draw_UpdateDrawScreen();
+    s_ProgramScissor(s_scissorEnabled);
+}
+
+/* Called before vertices are added to the cache while CPU clipping is on.
+ * Quads that were already clipped are happy with no scissor at all.
+ * The draw screen is brought up to date first: doing that reprograms the
+ * scissor, and left to the flush, it would scissor every quad already
+ * queued with whatever the draw area was last. */
+static void s_SyncScissor(int cpuClipped) {
+    PL_Draw_UpdateDrawScreen();
+    
+    if (s_glScissorEnabled == s_scissorEnabled
+        && (s_scissorEnabled == DXFALSE
+            || (s_glScissorX == s_scissorX && s_glScissorY == s_scissorY
+                && s_glScissorW == s_scissorW && s_glScissorH == s_scissorH))
+    ) {
+        return;
+    }
+    if (cpuClipped && s_glScissorEnabled == DXFALSE) {
+        return;
+    }
+    
+    PL_Draw_FlushCache();
+    
+    s_ProgramScissor(cpuClipped ? DXFALSE : s_scissorEnabled);
+}
+
+/* Clips one axis of a quad to [minValue, maxValue], adjusting the
+ * texture coordinates to match. a1 may be greater than a2 if flipped.
+ * Returns DXFALSE if nothing is left. */
+static int s_ClipAxis(float *a1, float *a2, float *t1, float *t2,
+                      float minValue, float maxValue) {
+    float A1 = *a1, A2 = *a2, T1 = *t1, T2 = *t2;
+    float scale;
+    
+    if (A1 == A2) {
+        return DXFALSE;
+    }
+    
+    scale = (T2 - T1) / (A2 - A1);
+    
+    if (A1 < A2) {
+        if (A2 <= minValue || A1 >= maxValue) {
+            return DXFALSE;
+        }
+        if (A1 < minValue) { *t1 = T1 + ((minValue - A1) * scale); *a1 = minValue; }
+        if (A2 > maxValue) { *t2 = T1 + ((maxValue - A1) * scale); *a2 = maxValue; }
+    } else {
+        if (A1 <= minValue || A2 >= maxValue) {
+            return DXFALSE;
+        }
+        if (A2 < minValue) { *t2 = T1 + ((minValue - A1) * scale); *a2 = minValue; }
+        if (A1 > maxValue) { *t1 = T1 + ((maxValue - A1) * scale); *a1 = maxValue; }
+    }
+    
+    return DXTRUE;
+}
+
+/* ------------------------------------------------------------ TRANSFORM */
+
+/* DxPortLib extension: a 2D transform applied to everything drawn, done
+ * by GL's modelview matrix. Changing it flushes, but after that it costs
+ * nothing per draw.
+ *
+ * Matrices are { a, b, c, d, tx, ty }, for
+ *   x' = a*x + c*y + tx
+ *   y' = b*x + d*y + ty
+ */
+#define TRANSFORM_STACK_SIZE 16
+
+static float s_transformStack[TRANSFORM_STACK_SIZE][6];
+static int s_transformDepth = 0;
+static float s_transform[6] = { 1, 0, 0, 1, 0, 0 };
+static int s_transformIsIdentity = DXTRUE;
+static int s_transformDirty = DXTRUE;
+
+/* Loads the transform into GL, if it has changed or been reset. */
+static void s_ApplyTransform() {
+    GLfloat m[16];
+    
+    if (s_transformDirty == DXFALSE) {
+        return;
+    }
+    s_transformDirty = DXFALSE;
+    
+    SDL_memset(m, 0, sizeof(m));
+    m[0] = s_transform[0];
+    m[1] = s_transform[1];
+    m[4] = s_transform[2];
+    m[5] = s_transform[3];
+    m[10] = 1;
+    m[12] = s_transform[4];
+    m[13] = s_transform[5];
+    m[15] = 1;
+    
+    PL_GL.glMatrixMode(GL_MODELVIEW);
+    PL_GL.glLoadMatrixf(m);
+}
+
+static void s_SetTransform(float a, float b, float c, float d, float tx, float ty) {
+    PL_Draw_FlushCache();
+    
+    s_transform[0] = a;
+    s_transform[1] = b;
+    s_transform[2] = c;
+    s_transform[3] = d;
+    s_transform[4] = tx;
+    s_transform[5] = ty;
+    
+    s_transformIsIdentity = (a == 1 && b == 0 && c == 0 && d == 1 && tx == 0 && ty == 0);
+    s_transformDirty = DXTRUE;
+}
+
+int PL_EXT_Draw_PushTransform() {
+    if (s_transformDepth >= TRANSFORM_STACK_SIZE) {
+        return -1;
+    }
+    
+    SDL_memcpy(s_transformStack[s_transformDepth], s_transform, sizeof(s_transform));
+    s_transformDepth += 1;
+    
+    return 0;
+}
+
+int PL_EXT_Draw_PopTransform() {
+    const float *m;
+    
+    if (s_transformDepth <= 0) {
+        return -1;
+    }
+    
+    s_transformDepth -= 1;
+    m = s_transformStack[s_transformDepth];
+    s_SetTransform(m[0], m[1], m[2], m[3], m[4], m[5]);
+    
+    return 0;
+}
+
+int PL_EXT_Draw_SetTransform(float a, float b, float c, float d, float tx, float ty) {
+    s_SetTransform(a, b, c, d, tx, ty);
+    return 0;
+}
+
+int PL_EXT_Draw_ResetTransform() {
+    s_SetTransform(1, 0, 0, 1, 0, 0);
+    return 0;
+}
+
+/* These apply before the current transform, like glTranslatef etc. */
+int PL_EXT_Draw_TranslateTransform(float x, float y) {
+    const float *m = s_transform;
+    s_SetTransform(m[0], m[1], m[2], m[3],
+                   m[4] + (m[0] * x) + (m[2] * y),
+                   m[5] + (m[1] * x) + (m[3] * y));
+    return 0;
+}
+
+int PL_EXT_Draw_ScaleTransform(float xScale, float yScale) {
+    const float *m = s_transform;
+    s_SetTransform(m[0] * xScale, m[1] * xScale,
+                   m[2] * yScale, m[3] * yScale,
+                   m[4], m[5]);
+    return 0;
+}
+
+int PL_EXT_Draw_RotateTransform(float angle) {
+    const float *m = s_transform;
+    float fSin = SDL_sinf(angle);
+    float fCos = SDL_cosf(angle);
+    s_SetTransform((m[0] * fCos) + (m[2] * fSin), (m[1] * fCos) + (m[3] * fSin),
+                   (m[2] * fCos) - (m[0] * fSin), (m[3] * fCos) - (m[1] * fSin),
+                   m[4], m[5]);
+    return 0;
+}
+
+/* -------------------------------------------------------------- CULLING */
+
+/* Anything whose bounding box is entirely outside of the draw area (or
+ * the draw screen, if there is none) is dropped before it reaches the
+ * vertex cache, so it can't cause a flush either. */
+static int s_culledCount = 0;
+
+static int s_IsOutsideView(float minX, float minY, float maxX, float maxY) {
+    float left, top, right, bottom;
+    
+    /* Culling is done on screen, so bring the box there first. */
+    if (s_transformIsIdentity == DXFALSE) {
+        const float *m = s_transform;
+        float cx = (minX + maxX) * 0.5f;
+        float cy = (minY + maxY) * 0.5f;
+        float hw = (maxX - minX) * 0.5f;
+        float hh = (maxY - minY) * 0.5f;
+        float ex = ((float)SDL_fabs(m[0]) * hw) + ((float)SDL_fabs(m[2]) * hh);
+        float ey = ((float)SDL_fabs(m[1]) * hw) + ((float)SDL_fabs(m[3]) * hh);
+        float sx = (m[0] * cx) + (m[2] * cy) + m[4];
+        float sy = (m[1] * cx) + (m[3] * cy) + m[5];
+        
+        minX = sx - ex; maxX = sx + ex;
+        minY = sy - ey; maxY = sy + ey;
+    }
+    
+    if (s_scissorEnabled) {
+        left = (float)s_scissorX;
+        top = (float)s_scissorY;
+        right = (float)(s_scissorX + s_scissorW);
+        bottom = (float)(s_scissorY + s_scissorH);
+    } else if (PL_drawTargetWidth >= 0) {
+        left = 0;
+        top = 0;
+        right = (float)PL_drawTargetWidth;
+        bottom = (float)PL_drawTargetHeight;
+    } else {
+        return DXFALSE;
+    }
+    
+    return maxX < left || minX > right || maxY < top || minY > bottom;
+}
+
+/* Same, but counting what gets dropped. */
+static int s_IsCulled(float minX, float minY, float maxX, float maxY) {
+    if (s_IsOutsideView(minX, minY, maxX, maxY)) {
+        s_culledCount += 1;
+        return DXTRUE;
+    }
+    
+    return DXFALSE;
+}
+
+/* Same, for two opposite corners in any order. */
+static int s_IsRectCulled(float x1, float y1, float x2, float y2) {
+    return s_IsCulled(SDL_min(x1, x2), SDL_min(y1, y2),
+                      SDL_max(x1, x2), SDL_max(y1, y2));
+}
+
+/* Same, for a quad. Triangles repeat a point. */
+static int s_IsQuadCulled(float x1, float y1, float x2, float y2,
+                          float x3, float y3, float x4, float y4) {
+    return s_IsCulled(SDL_min(SDL_min(x1, x2), SDL_min(x3, x4)),
+                      SDL_min(SDL_min(y1, y2), SDL_min(y3, y4)),
+                      SDL_max(SDL_max(x1, x2), SDL_max(x3, x4)),
+                      SDL_max(SDL_max(y1, y2), SDL_max(y3, y4)));
+}
+
+int PL_EXT_Draw_GetCulledCount(int resetFlag) {
+    int count = s_culledCount;
+    
+    if (resetFlag) {
+        s_culledCount = 0;
+    }
+    
+    return count;
+}
+
+/* -------------------------------------------------------- OPAQUE LAYERS */
+
+/* DxPortLib extension: an early depth pass for opaque quads.
+ *
+ * With the flag on, axis aligned quads that can't show anything behind
+ * them (no blending, or NOBLEND with a texture that has no alpha
+ * channel) are held back here instead of going to the vertex cache.
+ * Each one gets a depth value from its position in the run, later
+ * quads being nearer, and the run is drawn nearest first with the
+ * depth test on. Whatever a later quad covers is then never shaded.
+ *
+ * Anything else drawn ends the run, so the result is exactly the same
+ * as drawing everything in order. The store and the vertex cache are
+ * never both holding something.
+ */
+#define OPAQUE_QUAD_MAX 2048
+
+typedef struct VertexPosition3Tex2Color {
+    float x, y, z;
+    float tcx, tcy;
+    Uint32 color;
+} VertexPosition3Tex2Color;
+
+static int s_opaqueLayerFlag = DXFALSE;
+static VertexPosition3Tex2Color *s_opaqueVertices = NULL;
+static int *s_opaqueTextureIDs = NULL;
+static int s_opaqueQuadCount = 0;
+
+static int s_IsOpaqueDraw(int textureRefID, int blendFlag) {
+    return blendFlag == DXFALSE
+           || (s_blendMode == DX_BLENDMODE_NOBLEND
+               && (textureRefID < 0 || PL_Texture_HasAlphaChannel(textureRefID) == DXFALSE));
+}
+
+/* Reverses the order of the quads, so that the nearest comes first. */
+static void s_ReverseOpaqueQuads() {
+    VertexPosition3Tex2Color tmpV[6];
+    int tmpID;
+    int i = 0;
+    int j = s_opaqueQuadCount - 1;
+    
+    for (; i < j; ++i, --j) {
+        SDL_memcpy(tmpV, s_opaqueVertices + (i * 6), sizeof(tmpV));
+        SDL_memcpy(s_opaqueVertices + (i * 6), s_opaqueVertices + (j * 6), sizeof(tmpV));
+        SDL_memcpy(s_opaqueVertices + (j * 6), tmpV, sizeof(tmpV));
+        
+        tmpID = s_opaqueTextureIDs[i];
+        s_opaqueTextureIDs[i] = s_opaqueTextureIDs[j];
+        s_opaqueTextureIDs[j] = tmpID;
+    }
+}
+
+static void s_FlushOpaqueQuads() {
+    int useDepth;
+    int i, start;
+    
+    if (s_opaqueQuadCount == 0) {
+        return;
+    }
+    
+    PL_Draw_UpdateDrawScreen();
+    s_ApplyTransform();
+    s_ApplyBlendMode(DX_BLENDMODE_NOBLEND, DXFALSE);
+    
+    /* Without a depth buffer (no framebuffer support) this is just
+     * a normal draw, in the order given. */
+    useDepth = (PL_Draw_AddDepthBuffer() >= 0);
+    if (useDepth) {
+        PL_GL.glClearDepth(1.0);
+        PL_GL.glDepthMask(GL_TRUE);
+        PL_GL.glClear(GL_DEPTH_BUFFER_BIT);
+        PL_GL.glEnable(GL_DEPTH_TEST);
+        PL_GL.glDepthFunc(GL_LESS);
+        
+        s_ReverseOpaqueQuads();
+    }
+    
+    PL_GL.glEnableClientState(GL_VERTEX_ARRAY);
+    PL_GL.glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    PL_GL.glEnableClientState(GL_COLOR_ARRAY);
+    PL_GL.glVertexPointer(3, GL_FLOAT, sizeof(VertexPosition3Tex2Color), &s_opaqueVertices[0].x);
+    PL_GL.glTexCoordPointer(2, GL_FLOAT, sizeof(VertexPosition3Tex2Color), &s_opaqueVertices[0].tcx);
+    PL_GL.glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(VertexPosition3Tex2Color), &s_opaqueVertices[0].color);
+    
+    if (PL_GL.glActiveTexture != 0) {
+        PL_GL.glActiveTexture(GL_TEXTURE0);
+    }
+    
+    /* One draw call per run of the same texture. */
+    for (start = 0; start < s_opaqueQuadCount; start = i) {
+        int textureRefID = s_opaqueTextureIDs[start];
+        
+        for (i = start + 1; i < s_opaqueQuadCount; ++i) {
+            if (s_opaqueTextureIDs[i] != textureRefID) {
+                break;
+            }
+        }
+        
+        PL_Texture_Bind(textureRefID, s_drawMode);
+        PL_GL.glDrawArrays(GL_TRIANGLES, start * 6, (i - start) * 6);
+        PL_Texture_Unbind(textureRefID);
+    }
+    
+    PL_GL.glDisableClientState(GL_VERTEX_ARRAY);
+    PL_GL.glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    PL_GL.glDisableClientState(GL_COLOR_ARRAY);
+    
+    if (useDepth) {
+        PL_GL.glDisable(GL_DEPTH_TEST);
+    }
+    
+    s_opaqueQuadCount = 0;
+}
+
+/* Adds a quad to the store. Anything in the vertex cache has to be
+ * drawn first, as it is behind this; the cache is always empty while
+ * the store isn't. textureRefID may be -1. */
+static void s_AddOpaqueQuad(int textureRefID, Uint32 vColor,
+                            float x1, float y1, float x2, float y2,
+                            float tx1, float ty1, float tx2, float ty2) {
+    VertexPosition3Tex2Color *v;
+    float z;
+    
+    if (s_opaqueQuadCount == 0) {
+        PL_Draw_FlushCache();
+    }
+    if (s_cpuClipFlag) {
+        s_SyncScissor(s_cpuClipping);
+    }
+    if (s_opaqueQuadCount >= OPAQUE_QUAD_MAX) {
+        s_FlushOpaqueQuads();
+    }
+    
+    /* Depth runs from just under 1 (first quad) towards 0 (last quad). */
+    z = -(1.0f - ((float)(s_opaqueQuadCount + 1) / (float)(OPAQUE_QUAD_MAX + 1)));
+    
+    v = s_opaqueVertices + (s_opaqueQuadCount * 6);
+    s_opaqueTextureIDs[s_opaqueQuadCount] = textureRefID;
+    s_opaqueQuadCount += 1;
+    
+    v[0].x = x1; v[0].y = y1; v[0].z = z; v[0].tcx = tx1; v[0].tcy = ty1; v[0].color = vColor;
+    v[1].x = x2; v[1].y = y1; v[1].z = z; v[1].tcx = tx2; v[1].tcy = ty1; v[1].color = vColor;
+    v[2].x = x1; v[2].y = y2; v[2].z = z; v[2].tcx = tx1; v[2].tcy = ty2; v[2].color = vColor;
+    v[3] = v[2];
+    v[4] = v[1];
+    v[5].x = x2; v[5].y = y2; v[5].z = z; v[5].tcx = tx2; v[5].tcy = ty2; v[5].color = vColor;
+}
+
+int PL_EXT_Draw_SetUseOpaqueLayerFlag(int flag) {
+    flag = (flag != 0) ? DXTRUE : DXFALSE;
+    
+    if (flag == s_opaqueLayerFlag) {
+        return 0;
+    }
+    
+    PL_Draw_FlushCache();
+    
+    if (flag && s_opaqueVertices == NULL) {
+        s_opaqueVertices = (VertexPosition3Tex2Color *)DXALLOC(
+            sizeof(VertexPosition3Tex2Color) * 6 * OPAQUE_QUAD_MAX);
+        s_opaqueTextureIDs = (int *)DXALLOC(sizeof(int) * OPAQUE_QUAD_MAX);
+        if (s_opaqueVertices == NULL || s_opaqueTextureIDs == NULL) {
+            DXFREE(s_opaqueVertices);
+            DXFREE(s_opaqueTextureIDs);
+            s_opaqueVertices = NULL;
+            s_opaqueTextureIDs = NULL;
+            return -1;
+        }
+    }
+    
+    s_opaqueLayerFlag = flag;
+    
+    return 0;
+}
+
 /* --------------------------------------------------------- VERTEX CACHE */
 
 enum VertexElementType {
@@ -185,6 +671,25 @@ static const VertexDefinition s_defVertexPosition2Tex2Color[] = {
     { VERTEX_COLOR, 4, GL_UNSIGNED_BYTE, offsetof(VertexPosition2Tex2Color, color) }
 };
 
+/* Packed version for pixel-aligned sprites, 12 bytes instead of 20.
+ *
+ * Fixed function GL can't normalize texture coordinates, so these hold
+ * the same values the float version would, just as integers. That works
+ * for texel coordinates on rectangle textures, and for whole power of
+ * two textures where the coordinates are exactly 0 and 1.
+ */
+typedef struct VertexPosition2Tex2ColorPacked {
+    Sint16 x, y;
+    Sint16 tcx, tcy;
+    Uint32 color;
+} VertexPosition2Tex2ColorPacked;
+
+static const VertexDefinition s_defVertexPosition2Tex2ColorPacked[] = {
+    { VERTEX_POSITION, 2, GL_SHORT, offsetof(VertexPosition2Tex2ColorPacked, x) },
+    { VERTEX_TEXCOORD0, 2, GL_SHORT, offsetof(VertexPosition2Tex2ColorPacked, tcx) },
+    { VERTEX_COLOR, 4, GL_UNSIGNED_BYTE, offsetof(VertexPosition2Tex2ColorPacked, color) }
+};
+
 typedef struct VertexCache {
     const VertexDefinition *defArray;
     int defCount;
@@ -213,6 +718,12 @@ static void *s_BeginCache(
     int vertexSize, int vertexCount,
     GLenum drawMode, int textureRefID, int blendFlag
 ) {
+    s_FlushOpaqueQuads();
+    
+    if (s_cpuClipFlag) {
+        s_SyncScissor(s_cpuClipping);
+    }
+    
     /* - If this is the same as the last definition, try to continue it. */
     if (s_cache.defArray == definitionArray
         && s_cache.drawMode == drawMode
@@ -257,22 +768,35 @@ static void *s_BeginCache(
                                sizeof(VertexType), vertexCount, \
                                drawMode, textureRefID, blendFlag)
 
+/* Texture and shader used by the anti-aliased shapes, see SHAPES below.
+ * Batches drawn with the shader have SHAPE_SHADER_REFID as their
+ * texture, as it doesn't sample one. */
+#define SHAPE_SHADER_REFID  -2
+
+static int s_shapeTextureRefID = -1;
+static GLuint s_shapeProgram = 0;
+static int s_shapeProgramFailed = DXFALSE;
+
 int PL_Draw_FlushCache() {
     int i;
     int vertexSize;
     unsigned char *vertexData;
     const VertexDefinition *def;
     
+    s_FlushOpaqueQuads();
+    
     if (s_cache.defArray == NULL || s_cache.vertexCount == 0) {
         s_cache.vertexDataPosition = 0;
         return 0;
     }
     
     PL_Draw_UpdateDrawScreen();
+    s_ApplyTransform();
     
     /* Apply blending mode */
     if (s_cache.blendFlag) {
-        s_ApplyBlendMode(s_blendMode, PL_Texture_HasAlphaChannel(s_cache.textureRefID));
+        s_ApplyBlendMode(s_blendMode, s_cache.textureRefID == SHAPE_SHADER_REFID
+                                      || PL_Texture_HasAlphaChannel(s_cache.textureRefID));
     } else {
         s_ApplyBlendMode(DX_BLENDMODE_NOBLEND, DXFALSE);
     }
@@ -301,7 +825,13 @@ int PL_Draw_FlushCache() {
     if (PL_GL.glActiveTexture != 0) {
         PL_GL.glActiveTexture(GL_TEXTURE0);
     }
-    PL_Texture_Bind(s_cache.textureRefID, s_drawMode);
+    if (s_cache.textureRefID == SHAPE_SHADER_REFID) {
+        PL_GL.glUseProgram(s_shapeProgram);
+    } else if (s_cache.textureRefID >= 0 && s_cache.textureRefID == s_shapeTextureRefID) {
+        PL_Texture_Bind(s_cache.textureRefID, DX_DRAWMODE_BILINEAR);
+    } else {
+        PL_Texture_Bind(s_cache.textureRefID, s_drawMode);
+    }
     
     /* Draw! */
     /* This could be optimized a bit by storing a list of drawMode changes,
@@ -311,7 +841,11 @@ int PL_Draw_FlushCache() {
     PL_GL.glDrawArrays(s_cache.drawMode, 0, s_cache.vertexCount);
     
     /* Clean up */
-    PL_Texture_Unbind(s_cache.textureRefID);
+    if (s_cache.textureRefID == SHAPE_SHADER_REFID) {
+        PL_GL.glUseProgram(0);
+    } else {
+        PL_Texture_Unbind(s_cache.textureRefID);
+    }
     
     def = s_cache.defArray;
     for (i = 0; i < s_cache.defCount; ++i, ++def) {
@@ -355,6 +889,23 @@ int PL_Draw_DestroyCache() {
         SDL_free(s_cache.vertexData);
     }
     
+    if (s_shapeTextureRefID >= 0) {
+        PL_Texture_Release(s_shapeTextureRefID);
+        s_shapeTextureRefID = -1;
+    }
+    if (s_shapeProgram != 0) {
+        PL_GL.glDeleteProgram(s_shapeProgram);
+        s_shapeProgram = 0;
+    }
+    s_shapeProgramFailed = DXFALSE;
+    
+    DXFREE(s_opaqueVertices);
+    DXFREE(s_opaqueTextureIDs);
+    s_opaqueVertices = NULL;
+    s_opaqueTextureIDs = NULL;
+    s_opaqueQuadCount = 0;
+    s_opaqueLayerFlag = DXFALSE;
+    
     SDL_memset(&s_cache, 0, sizeof(s_cache));
     
     return 0;
@@ -373,10 +924,187 @@ static SDL_INLINE Uint32 s_modulateColor(DXCOLOR color) {
     return s_drawColorA | r | g | b;
 }
 
+/* Applies SetDrawBright and the blend alpha to a color that is already
+ * in vertex order. */
+static SDL_INLINE Uint32 s_modulateVertexColor(Uint32 vColor) {
+    Uint32 r = ((vColor & 0xff) * s_drawColorR) / 0xff;
+    Uint32 g = ((((vColor >> 8) & 0xff) * s_drawColorG) / 0xff) << 8;
+    Uint32 b = ((((vColor >> 16) & 0xff) * s_drawColorB) / 0xff) << 16;
+    Uint32 a = (((vColor >> 24) * (s_drawColorA >> 24)) / 0xff) << 24;
+    return r | g | b | a;
+}
+
+/* Returns true if the value can be stored in a packed vertex as-is. */
+static SDL_INLINE int s_IsPackable(float value) {
+    return value >= -32768.0f && value <= 32767.0f
+           && value == (float)(Sint16)value;
+}
+
+static void s_DrawTiledQuad(int textureRefID, int blendFlag, Uint32 vColor,
+                            float x1, float y1, float x2, float y2, float x3, float y3,
+                            float tx1, float ty1, float tx2, float ty2, int axisAligned);
+
+/* Writes an axis aligned textured quad, using the packed vertex format
+ * when every coordinate is a whole number.
+ *
+ * If the cache is already holding a float batch for the same texture,
+ * we keep adding to it instead, as switching formats forces a flush.
+ */
+static void s_DrawTexturedRect(int textureRefID, int blendFlag, Uint32 vColor,
+                               float x1, float y1, float x2, float y2,
+                               float tx1, float ty1, float tx2, float ty2) {
+    if (s_IsRectCulled(x1, y1, x2, y2)) {
+        return;
+    }
+    
+    /* Tiled textures never make it into the cache, so that's a quick
+     * way to skip the lookup for the common case. */
+    if (textureRefID != s_cache.textureRefID && PL_Texture_IsTiled(textureRefID)) {
+        s_DrawTiledQuad(textureRefID, blendFlag, vColor,
+                        x1, y1, x2, y1, x1, y2, tx1, ty1, tx2, ty2, DXTRUE);
+        return;
+    }
+    
+    if (s_cpuClipFlag && s_scissorEnabled && s_transformIsIdentity) {
+        if (!s_ClipAxis(&x1, &x2, &tx1, &tx2,
+                        (float)s_scissorX, (float)(s_scissorX + s_scissorW))
+            || !s_ClipAxis(&y1, &y2, &ty1, &ty2,
+                           (float)s_scissorY, (float)(s_scissorY + s_scissorH))
+        ) {
+            return;
+        }
+    }
+    
+    s_cpuClipping = s_cpuClipFlag && s_transformIsIdentity;
+    
+    if (s_opaqueLayerFlag && s_IsOpaqueDraw(textureRefID, blendFlag)) {
+        s_AddOpaqueQuad(textureRefID, vColor, x1, y1, x2, y2, tx1, ty1, tx2, ty2);
+    } else if (s_IsPackable(x1) && s_IsPackable(y1) && s_IsPackable(x2) && s_IsPackable(y2)
+        && s_IsPackable(tx1) && s_IsPackable(ty1) && s_IsPackable(tx2) && s_IsPackable(ty2)
+        && !(s_cache.defArray == s_defVertexPosition2Tex2Color
+             && s_cache.drawMode == GL_TRIANGLES
+             && s_cache.textureRefID == textureRefID
+             && s_cache.blendFlag == blendFlag
+             && s_cache.vertexCount > 0)
+    ) {
+        START(v, VertexPosition2Tex2ColorPacked, GL_TRIANGLES, textureRefID, 6, blendFlag);
+        Sint16 px1 = (Sint16)x1, py1 = (Sint16)y1, px2 = (Sint16)x2, py2 = (Sint16)y2;
+        Sint16 ptx1 = (Sint16)tx1, pty1 = (Sint16)ty1, ptx2 = (Sint16)tx2, pty2 = (Sint16)ty2;
+        
+        v[0].x = px1; v[0].y = py1; v[0].tcx = ptx1; v[0].tcy = pty1; v[0].color = vColor;
+        v[1].x = px2; v[1].y = py1; v[1].tcx = ptx2; v[1].tcy = pty1; v[1].color = vColor;
+        v[2].x = px1; v[2].y = py2; v[2].tcx = ptx1; v[2].tcy = pty2; v[2].color = vColor;
+        v[3] = v[2];
+        v[4] = v[1];
+        v[5].x = px2; v[5].y = py2; v[5].tcx = ptx2; v[5].tcy = pty2; v[5].color = vColor;
+    } else {
+        START(v, VertexPosition2Tex2Color, GL_TRIANGLES, textureRefID, 6, blendFlag);
+        
+        v[0].x = x1; v[0].y = y1; v[0].tcx = tx1; v[0].tcy = ty1; v[0].color = vColor;
+        v[1].x = x2; v[1].y = y1; v[1].tcx = tx2; v[1].tcy = ty1; v[1].color = vColor;
+        v[2].x = x1; v[2].y = y2; v[2].tcx = tx1; v[2].tcy = ty2; v[2].color = vColor;
+        v[3] = v[2];
+        v[4] = v[1];
+        v[5].x = x2; v[5].y = y2; v[5].tcx = tx2; v[5].tcy = ty2; v[5].color = vColor;
+    }
+    
+    s_cpuClipping = DXFALSE;
+}
+
+/* Draws a textured parallelogram using a tiled texture, as one quad per
+ * tile. (x1,y1), (x2,y2) and (x3,y3) are the corners for (tx1,ty1),
+ * (tx2,ty1) and (tx1,ty2), in texels.
+ *
+ * Tiles that land outside of the view are skipped before they are ever
+ * fetched, which is what keeps only the visible ones resident.
+ */
+static void s_DrawTiledQuad(int textureRefID, int blendFlag, Uint32 vColor,
+                            float x1, float y1, float x2, float y2, float x3, float y3,
+                            float tx1, float ty1, float tx2, float ty2, int axisAligned) {
+    float tileSize = (float)PL_Texture_GetTileSize();
+    float minU = SDL_min(tx1, tx2), maxU = SDL_max(tx1, tx2);
+    float minV = SDL_min(ty1, ty2), maxV = SDL_max(ty1, ty2);
+    float uxStep, uyStep, vxStep, vyStep;
+    int tileX1, tileY1, tileX2, tileY2;
+    int tileX, tileY;
+    
+    if (tx1 == tx2 || ty1 == ty2) {
+        return;
+    }
+    
+    /* Screen movement per texel along u and v. */
+    uxStep = (x2 - x1) / (tx2 - tx1);
+    uyStep = (y2 - y1) / (tx2 - tx1);
+    vxStep = (x3 - x1) / (ty2 - ty1);
+    vyStep = (y3 - y1) / (ty2 - ty1);
+    
+    tileX1 = (int)SDL_floor(minU / tileSize);
+    tileY1 = (int)SDL_floor(minV / tileSize);
+    tileX2 = (int)SDL_ceil(maxU / tileSize);
+    tileY2 = (int)SDL_ceil(maxV / tileSize);
+    
+    for (tileY = tileY1; tileY < tileY2; ++tileY) {
+        float v1 = SDL_max(minV, (float)tileY * tileSize);
+        float v2 = SDL_min(maxV, (float)(tileY + 1) * tileSize);
+        
+        for (tileX = tileX1; tileX < tileX2; ++tileX) {
+            float u1 = SDL_max(minU, (float)tileX * tileSize);
+            float u2 = SDL_min(maxU, (float)(tileX + 1) * tileSize);
+            float ax = x1 + ((u1 - tx1) * uxStep) + ((v1 - ty1) * vxStep);
+            float ay = y1 + ((u1 - tx1) * uyStep) + ((v1 - ty1) * vyStep);
+            float bx = ax + ((u2 - u1) * uxStep), by = ay + ((u2 - u1) * uyStep);
+            float cx = ax + ((v2 - v1) * vxStep), cy = ay + ((v2 - v1) * vyStep);
+            float dx = bx + (cx - ax), dy = by + (cy - ay);
+            SDL_Rect tileRect;
+            float xMult, yMult;
+            float tu1, tv1, tu2, tv2;
+            int tileID;
+            
+            if (u2 <= u1 || v2 <= v1
+                || s_IsOutsideView(SDL_min(SDL_min(ax, bx), SDL_min(cx, dx)),
+                                   SDL_min(SDL_min(ay, by), SDL_min(cy, dy)),
+                                   SDL_max(SDL_max(ax, bx), SDL_max(cx, dx)),
+                                   SDL_max(SDL_max(ay, by), SDL_max(cy, dy)))
+            ) {
+                continue;
+            }
+            
+            tileID = PL_Texture_GetTile(textureRefID, tileX, tileY, &tileRect, &xMult, &yMult);
+            if (tileID < 0) {
+                continue;
+            }
+            
+            tu1 = (u1 - (float)tileRect.x) * xMult;
+            tv1 = (v1 - (float)tileRect.y) * yMult;
+            tu2 = (u2 - (float)tileRect.x) * xMult;
+            tv2 = (v2 - (float)tileRect.y) * yMult;
+            
+            if (axisAligned) {
+                s_DrawTexturedRect(tileID, blendFlag, vColor, ax, ay, dx, dy, tu1, tv1, tu2, tv2);
+            } else {
+                START(v, VertexPosition2Tex2Color, GL_TRIANGLES, tileID, 6, blendFlag);
+                
+                v[0].x = ax; v[0].y = ay; v[0].tcx = tu1; v[0].tcy = tv1; v[0].color = vColor;
+                v[1].x = bx; v[1].y = by; v[1].tcx = tu2; v[1].tcy = tv1; v[1].color = vColor;
+                v[2].x = cx; v[2].y = cy; v[2].tcx = tu1; v[2].tcy = tv2; v[2].color = vColor;
+                v[3] = v[2];
+                v[4] = v[1];
+                v[5].x = dx; v[5].y = dy; v[5].tcx = tu2; v[5].tcy = tv2; v[5].color = vColor;
+            }
+        }
+    }
+}
+
 int PL_Draw_PixelF(float x, float y, DXCOLOR color) {
     Uint32 vColor = s_modulateColor(color);
-    START(v, VertexPosition2Color, GL_POINTS, -1, 1, DXTRUE);
-    v[0].x = x; v[0].y = y; v[0].color = vColor;
+    if (s_IsCulled(x, y, x + 1, y + 1)) {
+        return 0;
+    }
+    
+    {
+        START(v, VertexPosition2Color, GL_POINTS, -1, 1, DXTRUE);
+        v[0].x = x; v[0].y = y; v[0].color = vColor;
+    }
     
     return 0;
 }
@@ -387,6 +1115,13 @@ int PL_Draw_Pixel(int x, int y, DXCOLOR color) {
 
 int PL_Draw_LineF(float x1, float y1, float x2, float y2, DXCOLOR color, int thickness) {
     Uint32 vColor = s_modulateColor(color);
+    float pad = (thickness > 1) ? (float)thickness * 0.5f : 1.0f;
+    
+    if (s_IsCulled(SDL_min(x1, x2) - pad, SDL_min(y1, y2) - pad,
+                   SDL_max(x1, x2) + pad, SDL_max(y1, y2) + pad)) {
+        return 0;
+    }
+    
     if (thickness <= 1) {
         START(v, VertexPosition2Color, GL_LINES, -1, 2, DXTRUE);
     
@@ -415,71 +1150,501 @@ int PL_Draw_LineF(float x1, float y1, float x2, float y2, DXCOLOR color, int thi
     return 0;
 }
 
-int PL_Draw_Line(int x1, int y1, int x2, int y2, DXCOLOR color, int thickness) {
-    return PL_Draw_LineF((float)x1, (float)y1, (float)x2, (float)y2, color, thickness);
+int PL_Draw_Line(int x1, int y1, int x2, int y2, DXCOLOR color, int thickness) {
+    return PL_Draw_LineF((float)x1, (float)y1, (float)x2, (float)y2, color, thickness);
+}
+
+int PL_Draw_OvalF(float x, float y, float rx, float ry, DXCOLOR color, int fillFlag) {
+    /* DxLib's circle/oval drawing functions are not mimiced accurately.
+     * 
+     * DxLib draws them one pixel around the circumference at a time.
+     * And filled ellipses are lines extending across the diameter.
+     * 
+     * Yes, really.
+     * 
+     * We may want to adjust the number of points based on the
+     * circumference of the ellipse.
+     */
+    Uint32 vColor = s_modulateColor(color);
+    float arx = (float)SDL_fabs(rx) + 1.0f;
+    float ary = (float)SDL_fabs(ry) + 1.0f;
+    
+    if (s_IsCulled(x - arx, y - ary, x + arx, y + ary)) {
+        return 0;
+    }
+    
+    if (fillFlag) {
+        int points = 36;
+        float amount = ((float)M_PI * 2) / (float)points;
+        START(v, VertexPosition2Color, GL_TRIANGLE_FAN, -1, points, DXTRUE);
+        int i;
+        
+        for (i = 0; i < points; ++i) {
+            v[i].x = x + (SDL_cosf((float)i * amount) * rx);
+            v[i].y = y + (SDL_sinf((float)i * amount) * ry);
+            v[i].color = vColor;
+        }
+        
+        /* we don't want triangle fan to bleed over, so clear it out now. */
+        PL_Draw_FlushCache();
+    } else {
+        int points = 36;
+        float amount = ((float)M_PI * 2) / (float)points;
+        START(v, VertexPosition2Color, GL_LINES, -1, points * 2, DXTRUE);
+        VertexPosition2Color *sv = v;
+        int i;
+        
+        v[0].x = x + rx;
+        v[0].y = y;
+        v[0].color = vColor;
+        v += 1;
+        
+        for (i = 1; i < points; ++i) {
+            v->x = x + (SDL_cosf((float)i * amount) * rx);
+            v->y = y + (SDL_sinf((float)i * amount) * ry);
+            v->color = vColor;
+            
+            v[1] = v[0];
+            v += 2;
+        }
+        
+        v[0] = sv[0];
+    }
+    return 0;
+}
+int PL_Draw_Oval(int x, int y, int rx, int ry, DXCOLOR color, int fillFlag) {
+    return PL_Draw_OvalF((float)x, (float)y, (float)rx, (float)ry, color, fillFlag);
+}
+int PL_Draw_Circle(int x, int y, int r, DXCOLOR color, int fillFlag) {
+    return PL_Draw_OvalF((float)x, (float)y, (float)r, (float)r, color, fillFlag);
+}
+int PL_Draw_CircleF(float x, float y, float r, DXCOLOR color, int fillFlag) {
+    return PL_Draw_OvalF(x, y, r, r, color, fillFlag);
+}
+
+/* --------------------------------------------------------------- SHAPES */
+
+/* Anti-aliased shapes are all rounded boxes: an inner box, which may
+ * be empty in either direction, grown by a radius in x and y. Circles
+ * and ellipses are a point grown, and capped lines are a box of no
+ * height along the line.
+ *
+ * With GLSL, a fill is the inner box's corners, middle and sides, 9
+ * quads at most. Their texture coordinates are how far past the inner
+ * box a point is, with the edge at 1, and the shader turns that into a
+ * distance in pixels, so the edge is about a pixel wide at any size.
+ *
+ * Without it, a fill is a fan out to half a pixel inside the edge, and
+ * a strip from there to half a pixel outside it, where vertex alpha
+ * fades out. Outlines are always drawn as a strip like that on each
+ * side. These sample a small white texture, so they batch together.
+ */
+#define SHAPE_TEXSIZE       4
+#define SHAPE_MIN_RADIUS    0.5f
+
+static const GLchar *s_shapeShaderSource =
+    "void main() {\n"
+    "    float f = length(gl_TexCoord[0].st) - 1.0;\n"
+    "    float d = f / max(length(vec2(dFdx(f), dFdy(f))), 0.0001);\n"
+    "    gl_FragColor = vec4(gl_Color.rgb, gl_Color.a * clamp(0.5 - d, 0.0, 1.0));\n"
+    "}\n";
+
+static int s_CreateShapeProgram() {
+    GLuint shader;
+    GLuint program;
+    GLint status;
+    
+    if (s_shapeProgram != 0) {
+        return 0;
+    }
+    if (PL_GL.hasShaderSupport == DXFALSE || s_shapeProgramFailed == DXTRUE) {
+        return -1;
+    }
+    
+    /* If this doesn't work, don't try again on every shape. */
+    s_shapeProgramFailed = DXTRUE;
+    
+    shader = PL_GL.glCreateShader(GL_FRAGMENT_SHADER);
+    PL_GL.glShaderSource(shader, 1, &s_shapeShaderSource, NULL);
+    PL_GL.glCompileShader(shader);
+    PL_GL.glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+    if (status == GL_FALSE) {
+        PL_GL.glDeleteShader(shader);
+        return -1;
+    }
+    
+    program = PL_GL.glCreateProgram();
+    PL_GL.glAttachShader(program, shader);
+    PL_GL.glLinkProgram(program);
+    PL_GL.glDeleteShader(shader);
+    PL_GL.glGetProgramiv(program, GL_LINK_STATUS, &status);
+    if (status == GL_FALSE) {
+        PL_GL.glDeleteProgram(program);
+        return -1;
+    }
+    
+    s_shapeProgram = program;
+    s_shapeProgramFailed = DXFALSE;
+    
+    return 0;
+}
+
+/* Not PL_Texture_CreateFromSurface, so it can't end up tiled. */
+static int s_CreateShapeTexture() {
+    SDL_Surface *surface;
+    int textureRefID;
+    
+    surface = SDL_CreateRGBSurface(SDL_SWSURFACE, SHAPE_TEXSIZE, SHAPE_TEXSIZE, 32,
+                                   0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000);
+    if (surface == NULL) {
+        return -1;
+    }
+    SDL_FillRect(surface, NULL, 0xffffffff);
+    
+    textureRefID = PL_Texture_CreateFromDimensions(SHAPE_TEXSIZE, SHAPE_TEXSIZE, DXTRUE);
+    if (textureRefID >= 0 && PL_Texture_BlitSurface(textureRefID, surface, NULL) < 0) {
+        PL_Texture_Release(textureRefID);
+        textureRefID = -1;
+    }
+    SDL_FreeSurface(surface);
+    
+    return textureRefID;
+}
+
+/* Gets what shapes are batched under: SHAPE_SHADER_REFID, or the
+ * texture, with uv set to its middle. */
+static int s_GetShapeBatch(float *uv) {
+    SDL_Rect texRect;
+    float xMult, yMult;
+    
+    if (s_CreateShapeProgram() == 0) {
+        *uv = 0;
+        return SHAPE_SHADER_REFID;
+    }
+    
+    if (s_shapeTextureRefID < 0) {
+        s_shapeTextureRefID = s_CreateShapeTexture();
+        if (s_shapeTextureRefID < 0) {
+            return -1;
+        }
+        PL_Texture_AddRef(s_shapeTextureRefID);
+    }
+    
+    PL_Texture_RenderGetTextureInfo(s_shapeTextureRefID, &texRect, &xMult, &yMult);
+    *uv = (float)(SHAPE_TEXSIZE / 2) * xMult;
+    
+    return s_shapeTextureRefID;
+}
+
+static SDL_INLINE void s_ShapeVertex(VertexPosition2Tex2Color *v,
+                                     float ox, float oy, float ax, float ay,
+                                     float lx, float ly, float u, float w,
+                                     Uint32 vColor) {
+    v->x = ox + (lx * ax) - (ly * ay);
+    v->y = oy + (lx * ay) + (ly * ax);
+    v->tcx = u;
+    v->tcy = w;
+    v->color = vColor;
+}
+
+/* Gets point i of a rounded box outline, going clockwise from the
+ * right side, with segments points per corner. */
+static void s_GetOutlinePoint(float x1, float y1, float x2, float y2,
+                              float rx, float ry, int i, int segments,
+                              float *px, float *py, float *nx, float *ny) {
+    int corner = i / (segments + 1);
+    int step = i % (segments + 1);
+    float angle = ((float)M_PI * 0.5f) * ((float)corner + ((float)step / (float)segments));
+    float fCos = SDL_cosf(angle);
+    float fSin = SDL_sinf(angle);
+    float cx = (corner == 0 || corner == 3) ? x2 : x1;
+    float cy = (corner == 0 || corner == 1) ? y2 : y1;
+    float dx = ry * fCos;
+    float dy = rx * fSin;
+    float l = (float)SDL_sqrt((dx * dx) + (dy * dy));
+    
+    *px = cx + (rx * fCos);
+    *py = cy + (ry * fSin);
+    
+    /* The normal of an ellipse, or of a sharp corner if it has none. */
+    if (l > 0.0001f) {
+        *nx = dx / l;
+        *ny = dy / l;
+    } else {
+        *nx = fCos;
+        *ny = fSin;
+    }
+}
+
+/* Sets up one direction of a shader fill, see s_DrawShapeFill.
+ * Returns the number of quads across. */
+static int s_GetShaderFillSpans(float p1, float p2, float r, float *ps, float *ts) {
+    /* Padded a pixel out, for the half pixel the edge fades over. */
+    float e = r + 1.0f;
+    int count = 1;
+    
+    ps[0] = p1 - e; ts[0] = -e / r;
+    if (p2 > p1) {
+        count = 3;
+        ps[1] = p1; ts[1] = 0;
+        ps[2] = p2; ts[2] = 0;
+    }
+    ps[count] = p2 + e; ts[count] = e / r;
+    
+    return count;
+}
+
+static void s_DrawShapeFillShader(Uint32 vColor,
+                                  float ox, float oy, float ax, float ay,
+                                  float x1, float y1, float x2, float y2,
+                                  float rx, float ry) {
+    float xs[4], us[4], ys[4], vs[4];
+    int cols, rows;
+    int c, r;
+    
+    cols = s_GetShaderFillSpans(x1, x2, rx, xs, us);
+    rows = s_GetShaderFillSpans(y1, y2, ry, ys, vs);
+    
+    {
+        START(v, VertexPosition2Tex2Color, GL_TRIANGLES, SHAPE_SHADER_REFID, cols * rows * 6, DXTRUE);
+        
+        for (r = 0; r < rows; ++r) {
+            for (c = 0; c < cols; ++c, v += 6) {
+                s_ShapeVertex(&v[0], ox, oy, ax, ay, xs[c], ys[r], us[c], vs[r], vColor);
+                s_ShapeVertex(&v[1], ox, oy, ax, ay, xs[c + 1], ys[r], us[c + 1], vs[r], vColor);
+                s_ShapeVertex(&v[2], ox, oy, ax, ay, xs[c], ys[r + 1], us[c], vs[r + 1], vColor);
+                v[3] = v[2];
+                v[4] = v[1];
+                s_ShapeVertex(&v[5], ox, oy, ax, ay, xs[c + 1], ys[r + 1], us[c + 1], vs[r + 1], vColor);
+            }
+        }
+    }
+}
+
+static void s_DrawShapeFillStrip(int textureRefID, float uv, Uint32 vColor,
+                                 float ox, float oy, float ax, float ay,
+                                 float x1, float y1, float x2, float y2,
+                                 float rx, float ry, int posnum) {
+    Uint32 vClear = vColor & 0x00ffffff;
+    float cx = (x1 + x2) * 0.5f;
+    float cy = (y1 + y2) * 0.5f;
+    float inset = SDL_min(0.5f, SDL_min(cx - x1 + rx, cy - y1 + ry));
+    float aix, aiy, aox, aoy;
+    float px, py, nx, ny;
+    int segments = SDL_max(posnum / 4, 1);
+    int count = (segments + 1) * 4;
+    int i;
+    
+    s_GetOutlinePoint(x1, y1, x2, y2, rx, ry, 0, segments, &px, &py, &nx, &ny);
+    aix = px - (nx * inset); aiy = py - (ny * inset);
+    aox = px + (nx * 0.5f); aoy = py + (ny * 0.5f);
+    
+    for (i = 1; i <= count; ++i) {
+        float bix, biy, box, boy;
+        
+        s_GetOutlinePoint(x1, y1, x2, y2, rx, ry, i % count, segments, &px, &py, &nx, &ny);
+        bix = px - (nx * inset); biy = py - (ny * inset);
+        box = px + (nx * 0.5f); boy = py + (ny * 0.5f);
+        
+        {
+            START(v, VertexPosition2Tex2Color, GL_TRIANGLES, textureRefID, 9, DXTRUE);
+            
+            s_ShapeVertex(&v[0], ox, oy, ax, ay, cx, cy, uv, uv, vColor);
+            s_ShapeVertex(&v[1], ox, oy, ax, ay, aix, aiy, uv, uv, vColor);
+            s_ShapeVertex(&v[2], ox, oy, ax, ay, bix, biy, uv, uv, vColor);
+            v[3] = v[1];
+            v[4] = v[2];
+            s_ShapeVertex(&v[5], ox, oy, ax, ay, aox, aoy, uv, uv, vClear);
+            v[6] = v[2];
+            v[7] = v[5];
+            s_ShapeVertex(&v[8], ox, oy, ax, ay, box, boy, uv, uv, vClear);
+        }
+        
+        aix = bix; aiy = biy; aox = box; aoy = boy;
+    }
+}
+
+/* Draws a filled rounded box in a local frame, where local (lx, ly) is
+ * on screen at (ox, oy) + lx * (ax, ay) + ly * (-ay, ax).
+ *
+ * (x1,y1)-(x2,y2) is the inner box, and posnum is the number of
+ * segments all the way around, used without shaders.
+ */
+static void s_DrawShapeFill(int textureRefID, float uv, Uint32 vColor,
+                            float ox, float oy, float ax, float ay,
+                            float x1, float y1, float x2, float y2,
+                            float rx, float ry, int posnum) {
+    if (textureRefID != SHAPE_SHADER_REFID) {
+        s_DrawShapeFillStrip(textureRefID, uv, vColor, ox, oy, ax, ay,
+                             x1, y1, x2, y2, rx, ry, posnum);
+        return;
+    }
+    
+    /* A sharp corner has no size to measure the distance across, so
+     * those are rounded off a little, taking it out of the inner box. */
+    if (rx < SHAPE_MIN_RADIUS) {
+        float grow = SDL_min(SHAPE_MIN_RADIUS - rx, (x2 - x1) * 0.5f);
+        x1 += grow; x2 -= grow; rx += grow;
+    }
+    if (ry < SHAPE_MIN_RADIUS) {
+        float grow = SDL_min(SHAPE_MIN_RADIUS - ry, (y2 - y1) * 0.5f);
+        y1 += grow; y2 -= grow; ry += grow;
+    }
+    if (rx <= 0 || ry <= 0) {
+        return;
+    }
+    
+    s_DrawShapeFillShader(vColor, ox, oy, ax, ay, x1, y1, x2, y2, rx, ry);
+}
+
+/* Draws the outline of the same kind of box as s_DrawShapeFill, in
+ * screen coordinates. */
+static void s_DrawShapeOutline(int textureRefID, float uv, Uint32 vColor,
+                               float x1, float y1, float x2, float y2,
+                               float rx, float ry, int posnum, float thickness) {
+    Uint32 vClear = vColor & 0x00ffffff;
+    float h = SDL_max(thickness * 0.5f, 0.5f);
+    float offsets[4];
+    float ax, ay, anx, any;
+    int segments = SDL_max(posnum / 4, 1);
+    int count = (segments + 1) * 4;
+    int i, band;
+    
+    offsets[0] = -h - 0.5f;
+    offsets[1] = -h + 0.5f;
+    offsets[2] = h - 0.5f;
+    offsets[3] = h + 0.5f;
+    
+    s_GetOutlinePoint(x1, y1, x2, y2, rx, ry, 0, segments, &ax, &ay, &anx, &any);
+    
+    for (i = 1; i <= count; ++i) {
+        float bx, by, bnx, bny;
+        
+        s_GetOutlinePoint(x1, y1, x2, y2, rx, ry, i % count, segments, &bx, &by, &bnx, &bny);
+        
+        {
+            START(v, VertexPosition2Tex2Color, GL_TRIANGLES, textureRefID, 18, DXTRUE);
+            
+            for (band = 0; band < 3; ++band, v += 6) {
+                float o1 = offsets[band];
+                float o2 = offsets[band + 1];
+                Uint32 c1 = (band == 0) ? vClear : vColor;
+                Uint32 c2 = (band == 2) ? vClear : vColor;
+                
+                v[0].x = ax + (anx * o1); v[0].y = ay + (any * o1); v[0].color = c1;
+                v[1].x = bx + (bnx * o1); v[1].y = by + (bny * o1); v[1].color = c1;
+                v[2].x = ax + (anx * o2); v[2].y = ay + (any * o2); v[2].color = c2;
+                v[5].x = bx + (bnx * o2); v[5].y = by + (bny * o2); v[5].color = c2;
+                v[0].tcx = v[1].tcx = v[2].tcx = v[5].tcx = uv;
+                v[0].tcy = v[1].tcy = v[2].tcy = v[5].tcy = uv;
+                v[3] = v[2];
+                v[4] = v[1];
+            }
+        }
+        
+        ax = bx; ay = by; anx = bnx; any = bny;
+    }
+}
+
+int PL_Draw_OvalAAF(float x, float y, float rx, float ry, int posnum,
+                    DXCOLOR color, int fillFlag, float lineThickness) {
+    Uint32 vColor = s_modulateColor(color);
+    float uv;
+    int textureRefID;
+    float ex, ey;
+    
+    rx = (float)SDL_fabs(rx);
+    ry = (float)SDL_fabs(ry);
+    ex = rx + lineThickness + 1;
+    ey = ry + lineThickness + 1;
+    if (s_IsCulled(x - ex, y - ey, x + ex, y + ey)) {
+        return 0;
+    }
+    
+    textureRefID = s_GetShapeBatch(&uv);
+    if (textureRefID < 0) {
+        return PL_Draw_OvalF(x, y, rx, ry, color, fillFlag);
+    }
+    
+    if (fillFlag) {
+        s_DrawShapeFill(textureRefID, uv, vColor, 0, 0, 1, 0,
+                        x, y, x, y, rx, ry, posnum);
+    } else {
+        s_DrawShapeOutline(textureRefID, uv, vColor,
+                           x, y, x, y, rx, ry, posnum, lineThickness);
+    }
+    
+    return 0;
+}
+
+int PL_Draw_LineAAF(float x1, float y1, float x2, float y2,
+                    DXCOLOR color, float thickness) {
+    Uint32 vColor = s_modulateColor(color);
+    float dx = x2 - x1;
+    float dy = y2 - y1;
+    float l = (float)SDL_sqrt((dx * dx) + (dy * dy));
+    float h = SDL_max(thickness * 0.5f, 0.5f);
+    /* Caps in segments of about two pixels, when drawn without shaders. */
+    int posnum = SDL_max(8, SDL_min((int)(h * 3.0f), 256));
+    float uv;
+    int textureRefID;
+    
+    if (s_IsCulled(SDL_min(x1, x2) - h - 1, SDL_min(y1, y2) - h - 1,
+                   SDL_max(x1, x2) + h + 1, SDL_max(y1, y2) + h + 1)) {
+        return 0;
+    }
+    
+    textureRefID = s_GetShapeBatch(&uv);
+    if (textureRefID < 0) {
+        return PL_Draw_LineF(x1, y1, x2, y2, color, (int)thickness);
+    }
+    
+    /* A capsule: a box of no height along the line. */
+    if (l > 0) {
+        s_DrawShapeFill(textureRefID, uv, vColor, x1, y1, dx / l, dy / l,
+                        0, 0, l, 0, h, h, posnum);
+    } else {
+        s_DrawShapeFill(textureRefID, uv, vColor, x1, y1, 1, 0,
+                        0, 0, 0, 0, h, h, posnum);
+    }
+    
+    return 0;
 }
 
-int PL_Draw_OvalF(float x, float y, float rx, float ry, DXCOLOR color, int fillFlag) {
-    /* DxLib's circle/oval drawing functions are not mimiced accurately.
-     * 
-     * DxLib draws them one pixel around the circumference at a time.
-     * And filled ellipses are lines extending across the diameter.
-     * 
-     * Yes, really.
-     * 
-     * We may want to adjust the number of points based on the
-     * circumference of the ellipse.
-     */
+int PL_Draw_RoundRectAAF(float x1, float y1, float x2, float y2,
+                         float rx, float ry, int posnum,
+                         DXCOLOR color, int fillFlag, float lineThickness) {
     Uint32 vColor = s_modulateColor(color);
+    float uv;
+    int textureRefID;
+    float e = lineThickness + 1;
+    
+    if (x1 > x2) { float tmp = x1; x1 = x2; x2 = tmp; }
+    if (y1 > y2) { float tmp = y1; y1 = y2; y2 = tmp; }
+    
+    if (s_IsCulled(x1 - e, y1 - e, x2 + e, y2 + e)) {
+        return 0;
+    }
+    
+    rx = SDL_min((float)SDL_fabs(rx), (x2 - x1) * 0.5f);
+    ry = SDL_min((float)SDL_fabs(ry), (y2 - y1) * 0.5f);
+    
+    textureRefID = s_GetShapeBatch(&uv);
+    if (textureRefID < 0) {
+        return PL_Draw_BoxF(x1, y1, x2, y2, color, fillFlag);
+    }
     
     if (fillFlag) {
-        int points = 36;
-        float amount = ((float)M_PI * 2) / (float)points;
-        START(v, VertexPosition2Color, GL_TRIANGLE_FAN, -1, points, DXTRUE);
-        int i;
-        
-        for (i = 0; i < points; ++i) {
-            v[i].x = x + (SDL_cosf((float)i * amount) * rx);
-            v[i].y = y + (SDL_sinf((float)i * amount) * ry);
-            v[i].color = vColor;
-        }
-        
-        /* we don't want triangle fan to bleed over, so clear it out now. */
-        PL_Draw_FlushCache();
+        s_DrawShapeFill(textureRefID, uv, vColor, 0, 0, 1, 0,
+                        x1 + rx, y1 + ry, x2 - rx, y2 - ry, rx, ry, posnum);
     } else {
-        int points = 36;
-        float amount = ((float)M_PI * 2) / (float)points;
-        START(v, VertexPosition2Color, GL_LINES, -1, points * 2, DXTRUE);
-        VertexPosition2Color *sv = v;
-        int i;
-        
-        v[0].x = x + rx;
-        v[0].y = y;
-        v[0].color = vColor;
-        v += 1;
-        
-        for (i = 1; i < points; ++i) {
-            v->x = x + (SDL_cosf((float)i * amount) * rx);
-            v->y = y + (SDL_sinf((float)i * amount) * ry);
-            v->color = vColor;
-            
-            v[1] = v[0];
-            v += 2;
-        }
-        
-        v[0] = sv[0];
+        s_DrawShapeOutline(textureRefID, uv, vColor,
+                           x1 + rx, y1 + ry, x2 - rx, y2 - ry,
+                           rx, ry, posnum, lineThickness);
     }
+    
     return 0;
 }
-int PL_Draw_Oval(int x, int y, int rx, int ry, DXCOLOR color, int fillFlag) {
-    return PL_Draw_OvalF((float)x, (float)y, (float)rx, (float)ry, color, fillFlag);
-}
-int PL_Draw_Circle(int x, int y, int r, DXCOLOR color, int fillFlag) {
-    return PL_Draw_OvalF((float)x, (float)y, (float)r, (float)r, color, fillFlag);
-}
-int PL_Draw_CircleF(float x, float y, float r, DXCOLOR color, int fillFlag) {
-    return PL_Draw_OvalF(x, y, r, r, color, fillFlag);
-}
 
 int PL_Draw_TriangleF(
     float x1, float y1, float x2, float y2, float x3, float y3,
@@ -487,6 +1652,10 @@ int PL_Draw_TriangleF(
 ) {
     Uint32 vColor = s_modulateColor(color);
     
+    if (s_IsQuadCulled(x1, y1, x2, y2, x3, y3, x3, y3)) {
+        return 0;
+    }
+    
     if (fillFlag) {
         START(v, VertexPosition2Color, GL_TRIANGLES, -1, 3, DXTRUE);
     
@@ -522,6 +1691,10 @@ int PL_Draw_QuadrangleF(
 ) {
     Uint32 vColor = s_modulateColor(color);
     
+    if (s_IsQuadCulled(x1, y1, x2, y2, x3, y3, x4, y4)) {
+        return 0;
+    }
+    
     if (fillFlag) {
         START(v, VertexPosition2Color, GL_TRIANGLES, -1, 6, DXTRUE);
     
@@ -557,10 +1730,27 @@ int PL_Draw_Quadrangle(
                                color, fillFlag);
 }
 
-int PL_Draw_BoxF(float x1, float y1, float x2, float y2, DXCOLOR color, int FillFlag) {
-    Uint32 vColor = s_modulateColor(color);
+static void s_FillRect(Uint32 vColor, float x1, float y1, float x2, float y2) {
+    if (s_IsRectCulled(x1, y1, x2, y2)) {
+        return;
+    }
     
-    if (FillFlag) {
+    if (s_cpuClipFlag && s_scissorEnabled && s_transformIsIdentity) {
+        float t1 = 0, t2 = 0;
+        if (!s_ClipAxis(&x1, &x2, &t1, &t2,
+                        (float)s_scissorX, (float)(s_scissorX + s_scissorW))
+            || !s_ClipAxis(&y1, &y2, &t1, &t2,
+                           (float)s_scissorY, (float)(s_scissorY + s_scissorH))
+        ) {
+            return;
+        }
+    }
+    
+    s_cpuClipping = s_cpuClipFlag && s_transformIsIdentity;
+    
+    if (s_opaqueLayerFlag && s_IsOpaqueDraw(-1, DXTRUE)) {
+        s_AddOpaqueQuad(-1, vColor, x1, y1, x2, y2, 0, 0, 0, 0);
+    } else {
         /* TRIANGLES instead of TRIANGLE_STRIP so that we can batch. */
         START(v, VertexPosition2Color, GL_TRIANGLES, -1, 6, DXTRUE);
         
@@ -570,6 +1760,19 @@ int PL_Draw_BoxF(float x1, float y1, float x2, float y2, DXCOLOR color, int Fill
         v[3] = v[2];
         v[4] = v[1];
         v[5].x = x2; v[5].y = y2; v[5].color = vColor;
+    }
+    
+    s_cpuClipping = DXFALSE;
+}
+
+int PL_Draw_BoxF(float x1, float y1, float x2, float y2, DXCOLOR color, int FillFlag) {
+    Uint32 vColor = s_modulateColor(color);
+    
+    if (FillFlag) {
+        s_FillRect(vColor, x1, y1, x2, y2);
+    } else if (s_IsCulled(SDL_min(x1, x2) - 1, SDL_min(y1, y2) - 1,
+                          SDL_max(x1, x2) + 1, SDL_max(y1, y2) + 1)) {
+        return 0;
     } else {
         /* LINES instead of LINE_LOOP so that we can batch. */
         START(v, VertexPosition2Color, GL_LINES, -1, 8, DXTRUE);
@@ -597,7 +1800,6 @@ int PL_Draw_GraphF(float x1, float y1, int graphID, int blendFlag) {
     float xMult, yMult;
     if (PL_Texture_RenderGetGraphTextureInfo(graphID, &textureRefID, &texRect, &xMult, &yMult) >= 0) {
         Uint32 vColor = s_getColor();
-        START(v, VertexPosition2Tex2Color, GL_TRIANGLES, textureRefID, 6, blendFlag);
         float x2, y2;
         float tx1 = (float)texRect.x * xMult;
         float ty1 = (float)texRect.y * yMult;
@@ -608,12 +1810,8 @@ int PL_Draw_GraphF(float x1, float y1, int graphID, int blendFlag) {
         
         x2 = x1 + tw; y2 = y1 + th;
         
-        v[0].x = x1; v[0].y = y1; v[0].tcx = tx1; v[0].tcy = ty1; v[0].color = vColor;
-        v[1].x = x2; v[1].y = y1; v[1].tcx = tx2; v[1].tcy = ty1; v[1].color = vColor;
-        v[2].x = x1; v[2].y = y2; v[2].tcx = tx1; v[2].tcy = ty2; v[2].color = vColor;
-        v[3] = v[2];
-        v[4] = v[1];
-        v[5].x = x2; v[5].y = y2; v[5].tcx = tx2; v[5].tcy = ty2; v[5].color = vColor;
+        s_DrawTexturedRect(textureRefID, blendFlag, vColor,
+                           x1, y1, x2, y2, tx1, ty1, tx2, ty2);
     }
     
     return 0;
@@ -629,18 +1827,13 @@ int PL_Draw_ExtendGraphF(float x1, float y1, float x2, float y2, int graphID, in
     float xMult, yMult;
     if (PL_Texture_RenderGetGraphTextureInfo(graphID, &textureRefID, &texRect, &xMult, &yMult) >= 0) {
         Uint32 vColor = s_getColor();
-        START(v, VertexPosition2Tex2Color, GL_TRIANGLES, textureRefID, 6, blendFlag);
         float tx1 = (float)texRect.x * xMult;
         float ty1 = (float)texRect.y * yMult;
         float tx2 = tx1 + ((float)texRect.w * xMult);
         float ty2 = ty1 + ((float)texRect.h * yMult);
         
-        v[0].x = x1; v[0].y = y1; v[0].tcx = tx1; v[0].tcy = ty1; v[0].color = vColor;
-        v[1].x = x2; v[1].y = y1; v[1].tcx = tx2; v[1].tcy = ty1; v[1].color = vColor;
-        v[2].x = x1; v[2].y = y2; v[2].tcx = tx1; v[2].tcy = ty2; v[2].color = vColor;
-        v[3] = v[2];
-        v[4] = v[1];
-        v[5].x = x2; v[5].y = y2; v[5].tcx = tx2; v[5].tcy = ty2; v[5].color = vColor;
+        s_DrawTexturedRect(textureRefID, blendFlag, vColor,
+                           x1, y1, x2, y2, tx1, ty1, tx2, ty2);
     }
     
     return 0;
@@ -727,16 +1920,8 @@ int PL_Draw_RectGraphF(float dx, float dy, int sx, int sy, int sw, int sh,
         }
         
         /* - draw! */
-        {
-            START(v, VertexPosition2Tex2Color, GL_TRIANGLES, textureRefID, 6, blendFlag);
-            
-            v[0].x = dx1; v[0].y = dy1; v[0].tcx = tx1; v[0].tcy = ty1; v[0].color = vColor;
-            v[1].x = dx2; v[1].y = dy1; v[1].tcx = tx2; v[1].tcy = ty1; v[1].color = vColor;
-            v[2].x = dx1; v[2].y = dy2; v[2].tcx = tx1; v[2].tcy = ty2; v[2].color = vColor;
-            v[3] = v[2];
-            v[4] = v[1];
-            v[5].x = dx2; v[5].y = dy2; v[5].tcx = tx2; v[5].tcy = ty2; v[5].color = vColor;
-        }
+        s_DrawTexturedRect(textureRefID, blendFlag, vColor,
+                           dx1, dy1, dx2, dy2, tx1, ty1, tx2, ty2);
     }
     
     return 0;
@@ -756,7 +1941,6 @@ int PL_EXT_Draw_RectGraphFastF(
     float xMult, yMult;
     if (PL_Texture_RenderGetGraphTextureInfo(graphID, &textureRefID, &texRect, &xMult, &yMult) >= 0) {
         Uint32 vColor = s_getColor();
-        START(v, VertexPosition2Tex2Color, GL_TRIANGLES, textureRefID, 6, blendFlag);
         float dx2, dy2;
         float tx1 = (float)(texRect.x + sx) * xMult;
         float ty1 = (float)(texRect.y + sy) * yMult;
@@ -767,12 +1951,91 @@ int PL_EXT_Draw_RectGraphFastF(
         
         dx2 = dx1 + dw; dy2 = dy1 + dh;
         
-        v[0].x = dx1; v[0].y = dy1; v[0].tcx = tx1; v[0].tcy = ty1; v[0].color = vColor;
-        v[1].x = dx2; v[1].y = dy1; v[1].tcx = tx2; v[1].tcy = ty1; v[1].color = vColor;
-        v[2].x = dx1; v[2].y = dy2; v[2].tcx = tx1; v[2].tcy = ty2; v[2].color = vColor;
-        v[3] = v[2];
-        v[4] = v[1];
-        v[5].x = dx2; v[5].y = dy2; v[5].tcx = tx2; v[5].tcy = ty2; v[5].color = vColor;
+        s_DrawTexturedRect(textureRefID, blendFlag, vColor,
+                           dx1, dy1, dx2, dy2, tx1, ty1, tx2, ty2);
+    }
+    
+    return 0;
+}
+
+/* DxPortLib extension for particle systems.
+ *
+ * Draws count copies of the graph centered on (xArray[i], yArray[i]),
+ * each with its own color and alpha. colorArray is already in vertex
+ * order, so with a plain draw bright it is copied through untouched.
+ *
+ * The quads are written in chunks that fit the vertex cache, so a big
+ * system costs one glDrawArrays per 64kb rather than one per particle.
+ */
+int PL_EXT_Draw_ParticleQuads(int graphID, int blendFlag,
+                              const float *xArray, const float *yArray,
+                              const Uint32 *colorArray,
+                              int count, float scale) {
+    SDL_Rect texRect;
+    int textureRefID;
+    float xMult, yMult;
+    float tx1, ty1, tx2, ty2;
+    float halfW, halfH;
+    int maxQuads;
+    int modulate;
+    
+    if (PL_Texture_RenderGetGraphTextureInfo(graphID, &textureRefID, &texRect, &xMult, &yMult) < 0
+        || PL_Texture_IsTiled(textureRefID)
+    ) {
+        return -1;
+    }
+    
+    tx1 = (float)texRect.x * xMult;
+    ty1 = (float)texRect.y * yMult;
+    tx2 = tx1 + ((float)texRect.w * xMult);
+    ty2 = ty1 + ((float)texRect.h * yMult);
+    halfW = (float)texRect.w * scale * 0.5f;
+    halfH = (float)texRect.h * scale * 0.5f;
+    
+    modulate = (s_drawColorR != 0xff || s_drawColorG != 0xff
+                || s_drawColorB != 0xff || s_drawColorA != 0xff000000);
+    
+    maxQuads = s_cache.vertexDataSize / (int)(sizeof(VertexPosition2Tex2Color) * 6);
+    
+    while (count > 0) {
+        int n = (count < maxQuads) ? count : maxQuads;
+        START(v, VertexPosition2Tex2Color, GL_TRIANGLES, textureRefID, n * 6, blendFlag);
+        int i;
+        int culled = 0;
+        
+        for (i = 0; i < n; ++i) {
+            float x1 = xArray[i] - halfW;
+            float y1 = yArray[i] - halfH;
+            float x2 = xArray[i] + halfW;
+            float y2 = yArray[i] + halfH;
+            Uint32 vColor = colorArray[i];
+            
+            if (s_IsRectCulled(x1, y1, x2, y2)) {
+                culled += 1;
+                continue;
+            }
+            
+            if (modulate) {
+                vColor = s_modulateVertexColor(vColor);
+            }
+            
+            v[0].x = x1; v[0].y = y1; v[0].tcx = tx1; v[0].tcy = ty1; v[0].color = vColor;
+            v[1].x = x2; v[1].y = y1; v[1].tcx = tx2; v[1].tcy = ty1; v[1].color = vColor;
+            v[2].x = x1; v[2].y = y2; v[2].tcx = tx1; v[2].tcy = ty2; v[2].color = vColor;
+            v[3] = v[2];
+            v[4] = v[1];
+            v[5].x = x2; v[5].y = y2; v[5].tcx = tx2; v[5].tcy = ty2; v[5].color = vColor;
+            v += 6;
+        }
+        
+        /* Hand back the space reserved for culled particles. */
+        s_cache.vertexCount -= culled * 6;
+        s_cache.vertexDataPosition -= culled * 6 * (int)sizeof(VertexPosition2Tex2Color);
+        
+        xArray += n;
+        yArray += n;
+        colorArray += n;
+        count -= n;
     }
     
     return 0;
@@ -786,18 +2049,13 @@ int PL_Draw_RectExtendGraphF(float dx1, float dy1, float dx2, float dy2,
     float xMult, yMult;
     if (PL_Texture_RenderGetGraphTextureInfo(graphID, &textureRefID, &texRect, &xMult, &yMult) >= 0) {
         Uint32 vColor = s_getColor();
-        START(v, VertexPosition2Tex2Color, GL_TRIANGLES, textureRefID, 6, blendFlag);
         float tx1 = (float)(texRect.x + sx) * xMult;
         float ty1 = (float)(texRect.y + sy) * yMult;
         float tx2 = tx1 + ((float)sw * xMult);
         float ty2 = ty1 + ((float)sh * yMult);
         
-        v[0].x = dx1; v[0].y = dy1; v[0].tcx = tx1; v[0].tcy = ty1; v[0].color = vColor;
-        v[1].x = dx2; v[1].y = dy1; v[1].tcx = tx2; v[1].tcy = ty1; v[1].color = vColor;
-        v[2].x = dx1; v[2].y = dy2; v[2].tcx = tx1; v[2].tcy = ty2; v[2].color = vColor;
-        v[3] = v[2];
-        v[4] = v[1];
-        v[5].x = dx2; v[5].y = dy2; v[5].tcx = tx2; v[5].tcy = ty2; v[5].color = vColor;
+        s_DrawTexturedRect(textureRefID, blendFlag, vColor,
+                           dx1, dy1, dx2, dy2, tx1, ty1, tx2, ty2);
     }
     
     return 0;
@@ -832,7 +2090,6 @@ static int s_Draw_RotaGraphMain(
      * - Draw!
      */
     Uint32 vColor = s_getColor();
-    START(v, VertexPosition2Tex2Color, GL_TRIANGLES, textureRefID, 6, blendFlag);
     float tw = (float)texRect->w;
     float th = (float)texRect->h;
     float tx1 = (float)texRect->x * xMult;
@@ -847,6 +2104,7 @@ static int s_Draw_RotaGraphMain(
     float halfWcos, halfHcos, halfWsin, halfHsin;
     float xext1, xext2;
     float yext1, yext2;
+    float xr, yr;
     
     cx *= xScaleFactor;
     cy *= yScaleFactor;
@@ -871,13 +2129,31 @@ static int s_Draw_RotaGraphMain(
     yext1 = halfHcos + halfWsin;
     yext2 = halfHcos - halfWsin;
     
+    /* Both diagonals together give the bounding box. */
+    xr = (float)SDL_max(SDL_fabs(xext1), SDL_fabs(xext2));
+    yr = (float)SDL_max(SDL_fabs(yext1), SDL_fabs(yext2));
+    if (s_IsCulled(x - xr, y - yr, x + xr, y + yr)) {
+        return 0;
+    }
+    
+    if (textureRefID != s_cache.textureRefID && PL_Texture_IsTiled(textureRefID)) {
+        s_DrawTiledQuad(textureRefID, blendFlag, vColor,
+                        x - xext1, y - yext1, x + xext2, y - yext2, x - xext2, y + yext2,
+                        tx1, ty1, tx2, ty2, DXFALSE);
+        return 0;
+    }
+    
     /* Write vertices! */
-    v[0].x = x - xext1; v[0].y = y - yext1; v[0].tcx = tx1; v[0].tcy = ty1; v[0].color = vColor;
-    v[1].x = x + xext2; v[1].y = y - yext2; v[1].tcx = tx2; v[1].tcy = ty1; v[1].color = vColor;
-    v[2].x = x - xext2; v[2].y = y + yext2; v[2].tcx = tx1; v[2].tcy = ty2; v[2].color = vColor;
-    v[3] = v[2];
-    v[4] = v[1];
-    v[5].x = x + xext1; v[5].y = y + yext1; v[5].tcx = tx2; v[5].tcy = ty2; v[5].color = vColor;
+    {
+        START(v, VertexPosition2Tex2Color, GL_TRIANGLES, textureRefID, 6, blendFlag);
+        
+        v[0].x = x - xext1; v[0].y = y - yext1; v[0].tcx = tx1; v[0].tcy = ty1; v[0].color = vColor;
+        v[1].x = x + xext2; v[1].y = y - yext2; v[1].tcx = tx2; v[1].tcy = ty1; v[1].color = vColor;
+        v[2].x = x - xext2; v[2].y = y + yext2; v[2].tcx = tx1; v[2].tcy = ty2; v[2].color = vColor;
+        v[3] = v[2];
+        v[4] = v[1];
+        v[5].x = x + xext1; v[5].y = y + yext1; v[5].tcx = tx2; v[5].tcy = ty2; v[5].color = vColor;
+    }
     
     return 0;
 }
@@ -1072,7 +2348,15 @@ int PL_Draw_ModiGraphF(
     SDL_Rect texRect;
     int textureRefID;
     float xMult, yMult;
-    if (PL_Texture_RenderGetGraphTextureInfo(graphID, &textureRefID, &texRect, &xMult, &yMult) >= 0) {
+    if (s_IsQuadCulled(x1, y1, x2, y2, x3, y3, x4, y4)) {
+        return 0;
+    }
+    
+    /* ModiGraph quads aren't parallelograms, so they can't be split
+     * into tiles; tiled graphs are not drawn. */
+    if (PL_Texture_RenderGetGraphTextureInfo(graphID, &textureRefID, &texRect, &xMult, &yMult) >= 0
+        && PL_Texture_IsTiled(textureRefID) == DXFALSE
+    ) {
         Uint32 vColor = s_getColor();
         START(v, VertexPosition2Tex2Color, GL_TRIANGLES, textureRefID, 6, blendFlag);
         float tx1 = (float)texRect.x * xMult;
@@ -1091,6 +2375,160 @@ int PL_Draw_ModiGraphF(
     return 0;
 }
 
+/* Figures out how a DX_PRIMTYPE_* with elementCount vertices is sent
+ * to GL. Strips and fans are expanded into lists so that they can be
+ * batched with everything else.
+ *
+ * Returns the number of primitives, or -1 if the type is unknown.
+ */
+static int s_GetPrimitiveInfo(int primitiveType, int elementCount,
+                              GLenum *drawMode, int *primitiveSize) {
+    switch (primitiveType) {
+        case DX_PRIMTYPE_POINTLIST:
+            *drawMode = GL_POINTS; *primitiveSize = 1;
+            return elementCount;
+        case DX_PRIMTYPE_LINELIST:
+            *drawMode = GL_LINES; *primitiveSize = 2;
+            return elementCount / 2;
+        case DX_PRIMTYPE_LINESTRIP:
+            *drawMode = GL_LINES; *primitiveSize = 2;
+            return SDL_max(elementCount - 1, 0);
+        case DX_PRIMTYPE_TRIANGLELIST:
+            *drawMode = GL_TRIANGLES; *primitiveSize = 3;
+            return elementCount / 3;
+        case DX_PRIMTYPE_TRIANGLESTRIP:
+        case DX_PRIMTYPE_TRIANGLEFAN:
+            *drawMode = GL_TRIANGLES; *primitiveSize = 3;
+            return SDL_max(elementCount - 2, 0);
+        default:
+            return -1;
+    }
+}
+
+/* Returns which element is corner n of primitive p. */
+static SDL_INLINE int s_GetPrimitiveElement(int primitiveType, int primitiveSize,
+                                            int p, int n) {
+    switch (primitiveType) {
+        case DX_PRIMTYPE_LINESTRIP:
+        case DX_PRIMTYPE_TRIANGLESTRIP:
+            return p + n;
+        case DX_PRIMTYPE_TRIANGLEFAN:
+            return (n == 0) ? 0 : (p + n);
+        default:
+            return (p * primitiveSize) + n;
+    }
+}
+
+/* Copies user vertices straight into the vertex cache, in chunks that
+ * fit. Indices, if given, must all be less than vertexNum.
+ */
+int PL_Draw_Primitive2D(const VERTEX2D *vertices, int vertexNum,
+                        const unsigned short *indices, int indexNum,
+                        int primitiveType, int graphID, int blendFlag) {
+    SDL_Rect texRect;
+    int textureRefID = -1;
+    float xMult, yMult;
+    float tx = 0, ty = 0, tw = 0, th = 0;
+    float minX, minY, maxX, maxY;
+    GLenum drawMode;
+    int primitiveSize, primitiveCount, elementCount;
+    int vertexSize, maxPrimitives;
+    int modulate;
+    int p, i;
+    
+    if (vertices == NULL || vertexNum <= 0) {
+        return -1;
+    }
+    
+    elementCount = vertexNum;
+    if (indices != NULL) {
+        for (i = 0; i < indexNum; ++i) {
+            if (indices[i] >= vertexNum) {
+                return -1;
+            }
+        }
+        elementCount = indexNum;
+    }
+    
+    primitiveCount = s_GetPrimitiveInfo(primitiveType, elementCount,
+                                        &drawMode, &primitiveSize);
+    if (primitiveCount <= 0) {
+        return primitiveCount;
+    }
+    
+    if (graphID != (int)DX_NONE_GRAPH) {
+        if (PL_Texture_RenderGetGraphTextureInfo(graphID, &textureRefID, &texRect, &xMult, &yMult) < 0
+            || PL_Texture_IsTiled(textureRefID)
+        ) {
+            return -1;
+        }
+        tx = (float)texRect.x * xMult;
+        ty = (float)texRect.y * yMult;
+        tw = (float)texRect.w * xMult;
+        th = (float)texRect.h * yMult;
+    }
+    
+    minX = maxX = vertices[0].pos.x;
+    minY = maxY = vertices[0].pos.y;
+    for (i = 1; i < vertexNum; ++i) {
+        minX = SDL_min(minX, vertices[i].pos.x);
+        minY = SDL_min(minY, vertices[i].pos.y);
+        maxX = SDL_max(maxX, vertices[i].pos.x);
+        maxY = SDL_max(maxY, vertices[i].pos.y);
+    }
+    if (s_IsCulled(minX - 1, minY - 1, maxX + 1, maxY + 1)) {
+        return 0;
+    }
+    
+    modulate = (s_drawColorR != 0xff || s_drawColorG != 0xff
+                || s_drawColorB != 0xff || s_drawColorA != 0xff000000);
+    
+    vertexSize = (textureRefID >= 0) ? (int)sizeof(VertexPosition2Tex2Color)
+                                     : (int)sizeof(VertexPosition2Color);
+    maxPrimitives = s_cache.vertexDataSize / (vertexSize * primitiveSize);
+    
+    for (p = 0; p < primitiveCount; ) {
+        int end = SDL_min(primitiveCount, p + maxPrimitives);
+        int count = (end - p) * primitiveSize;
+        
+        if (textureRefID >= 0) {
+            START(v, VertexPosition2Tex2Color, drawMode, textureRefID, count, blendFlag);
+            
+            for (; p < end; ++p) {
+                for (i = 0; i < primitiveSize; ++i, ++v) {
+                    int e = s_GetPrimitiveElement(primitiveType, primitiveSize, p, i);
+                    const VERTEX2D *src = &vertices[(indices != NULL) ? indices[e] : e];
+                    Uint32 vColor = src->dif.r | (src->dif.g << 8)
+                                    | (src->dif.b << 16) | ((Uint32)src->dif.a << 24);
+                    
+                    v->x = src->pos.x;
+                    v->y = src->pos.y;
+                    v->tcx = tx + (src->u * tw);
+                    v->tcy = ty + (src->v * th);
+                    v->color = modulate ? s_modulateVertexColor(vColor) : vColor;
+                }
+            }
+        } else {
+            START(v, VertexPosition2Color, drawMode, -1, count, DXTRUE);
+            
+            for (; p < end; ++p) {
+                for (i = 0; i < primitiveSize; ++i, ++v) {
+                    int e = s_GetPrimitiveElement(primitiveType, primitiveSize, p, i);
+                    const VERTEX2D *src = &vertices[(indices != NULL) ? indices[e] : e];
+                    Uint32 vColor = src->dif.r | (src->dif.g << 8)
+                                    | (src->dif.b << 16) | ((Uint32)src->dif.a << 24);
+                    
+                    v->x = src->pos.x;
+                    v->y = src->pos.y;
+                    v->color = modulate ? s_modulateVertexColor(vColor) : vColor;
+                }
+            }
+        }
+    }
+    
+    return 0;
+}
+
 int PL_Draw_ModiGraph(
     int x1, int y1, int x2, int y2,
     int x3, int y3, int x4, int y4,
@@ -1107,7 +2545,6 @@ int PL_Draw_TurnGraphF(float x1, float y1, int graphID, int blendFlag) {
     float xMult, yMult;
     if (PL_Texture_RenderGetGraphTextureInfo(graphID, &textureRefID, &texRect, &xMult, &yMult) >= 0) {
         Uint32 vColor = s_getColor();
-        START(v, VertexPosition2Tex2Color, GL_TRIANGLES, textureRefID, 6, blendFlag);
         float x2, y2;
         float tx1 = (float)texRect.x * xMult;
         float ty1 = (float)texRect.y * yMult;
@@ -1118,12 +2555,9 @@ int PL_Draw_TurnGraphF(float x1, float y1, int graphID, int blendFlag) {
         
         x2 = x1 + tw; y2 = y1 + th;
         
-        v[0].x = x1; v[0].y = y1; v[0].tcx = tx2; v[0].tcy = ty1; v[0].color = vColor;
-        v[1].x = x2; v[1].y = y1; v[1].tcx = tx1; v[1].tcy = ty1; v[1].color = vColor;
-        v[2].x = x1; v[2].y = y2; v[2].tcx = tx2; v[2].tcy = ty2; v[2].color = vColor;
-        v[3] = v[2];
-        v[4] = v[1];
-        v[5].x = x2; v[5].y = y2; v[5].tcx = tx1; v[5].tcy = ty2; v[5].color = vColor;
+        /* Flipped by swapping the x texture coordinates. */
+        s_DrawTexturedRect(textureRefID, blendFlag, vColor,
+                           x1, y1, x2, y2, tx2, ty1, tx1, ty2);
     }
     
     return 0;
@@ -1133,24 +2567,12 @@ int PL_Draw_TurnGraph(int x, int y, int graphID, int blendFlag) {
     return PL_Draw_TurnGraphF((float)x, (float)y, graphID, blendFlag);
 }
 
-static int s_scissorEnabled = DXFALSE;
-static int s_scissorX = 0;
-static int s_scissorY = 0;
-static int s_scissorW = 0;
-static int s_scissorH = 0;
-
-static void s_RefreshScissor() {
-    PL_Draw_UpdateDrawScreen();
-    if (s_scissorEnabled == DXFALSE) {
-        PL_GL.glDisable(GL_SCISSOR_TEST);
-    } else {
-        PL_GL.glEnable(GL_SCISSOR_TEST);
-        PL_GL.glScissor(s_scissorX, s_scissorY, s_scissorW, s_scissorH);
-    }
-}
-
 int PL_Draw_SetDrawArea(int x1, int y1, int x2, int y2) {
-    PL_Draw_FlushCache();
+    /* With CPU clipping, the scissor is only brought up to date when
+     * something that can't be clipped gets drawn. */
+    if (s_cpuClipFlag == DXFALSE) {
+        PL_Draw_FlushCache();
+    }
     
     if (x1 == 0 && y1 == 0 && x2 == PL_drawScreenWidth && y2 == PL_drawScreenHeight) {
         s_scissorEnabled = DXFALSE;
@@ -1163,7 +2585,23 @@ int PL_Draw_SetDrawArea(int x1, int y1, int x2, int y2) {
         s_scissorH = y2 - y1;
     }
     
-    s_RefreshScissor();
+    if (s_cpuClipFlag == DXFALSE) {
+        s_RefreshScissor();
+    }
+    
+    return 0;
+}
+
+int PL_EXT_Draw_SetUseCPUClipFlag(int flag) {
+    flag = (flag != 0) ? DXTRUE : DXFALSE;
+    
+    if (flag != s_cpuClipFlag) {
+        PL_Draw_FlushCache();
+        
+        s_cpuClipFlag = flag;
+        
+        s_RefreshScissor();
+    }
     
     return 0;
 }
@@ -1185,7 +2623,7 @@ int PL_Draw_ClearDrawScreen(const RECT *rect) {
         PL_GL.glClear(GL_COLOR_BUFFER_BIT);
     } else {
         PL_GL.glEnable(GL_SCISSOR_TEST);
-        PL_GL.glScissor(rect->left, rect->top, rect->right - rect->left, rect->bottom - rect->top);
+        s_ScaledScissor(rect->left, rect->top, rect->right - rect->left, rect->bottom - rect->top);
         PL_GL.glClear(GL_COLOR_BUFFER_BIT);
     }
     
@@ -1254,6 +2692,7 @@ int PL_Draw_SetBasicBlendFlag(int blendFlag) {
 
 int PL_Draw_ForceUpdate() {
     s_lastBlendMode = -1;
+    s_transformDirty = DXTRUE;
     
     s_RefreshScissor();
     
@@ -67,6 +67,7 @@ typedef struct GLInfo_t {
     void (APIENTRY *glLoadIdentity)( void );
     void (APIENTRY *glPushMatrix)( void );
     void (APIENTRY *glPopMatrix)( void );
+    void (APIENTRY *glLoadMatrixf)( const GLfloat *m );
     void (APIENTRY *glOrtho)( GLdouble left, GLdouble right,
                               GLdouble bottom, GLdouble top,
                               GLdouble near_val, GLdouble far_val );
@@ -92,10 +93,17 @@ typedef struct GLInfo_t {
                                    GLsizei width, GLsizei height,
                                    GLenum format, GLenum type,
                                    GLvoid *pixels );
+    void (APIENTRY *glCopyTexSubImage2D)( GLenum target, GLint level,
+                                          GLint xoffset, GLint yoffset,
+                                          GLint x, GLint y,
+                                          GLsizei width, GLsizei height );
 
     /* Drawing functions */
     void (APIENTRY *glClearColor)( GLclampf red, GLclampf green, GLclampf blue, GLclampf alpha );
     void (APIENTRY *glClear)( GLbitfield mask );
+    void (APIENTRY *glClearDepth)( GLclampd depth );
+    void (APIENTRY *glDepthFunc)( GLenum func );
+    void (APIENTRY *glDepthMask)( GLboolean flag );
     
     void (APIENTRY *glColor4f)( GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha );
     
@@ -129,12 +137,71 @@ typedef struct GLInfo_t {
     void (APIENTRY *glDeleteFramebuffersEXT) (GLsizei n, const GLuint *framebuffers);
     void (APIENTRY *glGenFramebuffersEXT) (GLsizei n, GLuint *framebuffers);
     GLenum (APIENTRY *glCheckFramebufferStatusEXT) (GLenum target);
+    
+    void (APIENTRY *glGenRenderbuffersEXT) (GLsizei n, GLuint *renderbuffers);
+    void (APIENTRY *glDeleteRenderbuffersEXT) (GLsizei n, const GLuint *renderbuffers);
+    void (APIENTRY *glBindRenderbufferEXT) (GLenum target, GLuint renderbuffer);
+    void (APIENTRY *glRenderbufferStorageEXT) (GLenum target, GLenum internalformat, GLsizei width, GLsizei height);
+    void (APIENTRY *glFramebufferRenderbufferEXT) (GLenum target, GLenum attachment, GLenum renderbuffertarget, GLuint renderbuffer);
+    
+    /* NULL without GL_EXT_framebuffer_blit. */
+    void (APIENTRY *glBlitFramebufferEXT) (GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1,
+                                           GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1,
+                                           GLbitfield mask, GLenum filter);
+    
+    /* Timer query functions */
+    int hasTimerQuerySupport;
+    
+    void (APIENTRY *glGenQueries) (GLsizei n, GLuint *ids);
+    void (APIENTRY *glDeleteQueries) (GLsizei n, const GLuint *ids);
+    void (APIENTRY *glBeginQuery) (GLenum target, GLuint id);
+    void (APIENTRY *glEndQuery) (GLenum target);
+    void (APIENTRY *glGetQueryObjectiv) (GLuint id, GLenum pname, GLint *params);
+    void (APIENTRY *glGetQueryObjectui64v) (GLuint id, GLenum pname, GLuint64 *params);
+    
+    /* Pixel buffer functions */
+    int hasPixelBufferSupport;
+    
+    void (APIENTRY *glGenBuffers) (GLsizei n, GLuint *buffers);
+    void (APIENTRY *glDeleteBuffers) (GLsizei n, const GLuint *buffers);
+    void (APIENTRY *glBindBuffer) (GLenum target, GLuint buffer);
+    void (APIENTRY *glBufferData) (GLenum target, GLsizeiptr size, const GLvoid *data, GLenum usage);
+    GLvoid* (APIENTRY *glMapBuffer) (GLenum target, GLenum access);
+    GLboolean (APIENTRY *glUnmapBuffer) (GLenum target);
+    
+    /* Sync functions */
+    int hasSyncSupport;
+    
+    GLsync (APIENTRY *glFenceSync) (GLenum condition, GLbitfield flags);
+    void (APIENTRY *glDeleteSync) (GLsync sync);
+    GLenum (APIENTRY *glClientWaitSync) (GLsync sync, GLbitfield flags, GLuint64 timeout);
+    
+    /* Shader functions */
+    int hasShaderSupport;
+    
+    GLuint (APIENTRY *glCreateShader) (GLenum type);
+    void (APIENTRY *glDeleteShader) (GLuint shader);
+    void (APIENTRY *glShaderSource) (GLuint shader, GLsizei count, const GLchar **string, const GLint *length);
+    void (APIENTRY *glCompileShader) (GLuint shader);
+    void (APIENTRY *glGetShaderiv) (GLuint shader, GLenum pname, GLint *params);
+    GLuint (APIENTRY *glCreateProgram) (void);
+    void (APIENTRY *glDeleteProgram) (GLuint program);
+    void (APIENTRY *glAttachShader) (GLuint program, GLuint shader);
+    void (APIENTRY *glLinkProgram) (GLuint program);
+    void (APIENTRY *glGetProgramiv) (GLuint program, GLenum pname, GLint *params);
+    void (APIENTRY *glUseProgram) (GLuint program);
+    GLint (APIENTRY *glGetUniformLocation) (GLuint program, const GLchar *name);
+    void (APIENTRY *glUniform1i) (GLint location, GLint v0);
 } GLInfo;
 
 extern GLInfo PL_GL;
 
 extern int PL_drawScreenWidth;
 extern int PL_drawScreenHeight;
+extern int PL_drawTargetWidth;
+extern int PL_drawTargetHeight;
+extern float PL_drawViewportScaleX;
+extern float PL_drawViewportScaleY;
 
 extern int PL_Draw_UpdateDrawScreen();
 extern int PL_Draw_FlushCache();
@@ -142,14 +209,25 @@ extern int PL_Draw_InitCache();
 extern int PL_Draw_DestroyCache();
 
 extern int PL_Draw_ForceUpdate();
+extern int PL_Draw_AddDepthBuffer();
 
 extern int PL_Texture_CreateFramebuffer(int width, int height, int hasAlphaChannel);
 extern int PL_Texture_Bind(int textureRefID, int drawMode);
 extern int PL_Texture_Unbind(int textureRefID);
 extern int PL_Texture_BindFramebuffer(int textureRefID);
+extern int PL_Texture_HasFramebuffer(int textureRefID);
+extern int PL_Texture_AddDepthBuffer(int textureRefID);
+extern int PL_Texture_CopyFramebufferToTexture(int textureRefID, int destX, int destY,
+                                               const SDL_Rect *srcRect);
+extern int PL_Texture_BlitFramebufferToTexture(int srcTextureRefID, const SDL_Rect *srcRect,
+                                               int destTextureRefID, const SDL_Rect *destRect);
 extern int PL_Texture_RenderGetTextureInfo(int textureRefID, SDL_Rect *rect, float *xMult, float *yMult);
 extern int PL_Texture_RenderGetGraphTextureInfo(int graphID, int *textureRefID, SDL_Rect *rect, float *xMult, float *yMult);
 extern int PL_Texture_HasAlphaChannel(int textureRefID);
+extern int PL_Texture_IsTiled(int textureRefID);
+extern int PL_Texture_GetTile(int textureRefID, int tileX, int tileY,
+                              SDL_Rect *rect, float *xMult, float *yMult);
+extern int PL_Texture_GetTileSize();
 extern int PL_Texture_ClearAllData();
 
 #endif /* #ifdef DXPORTLIB_DRAW_OPENGL */
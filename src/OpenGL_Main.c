@@ -33,6 +33,15 @@ static int s_screenFrameBufferB = -1;
 int PL_drawScreenWidth = -1;
 int PL_drawScreenHeight = -1;
 
+/* Size of whatever is currently being drawn to, for culling. */
+int PL_drawTargetWidth = -1;
+int PL_drawTargetHeight = -1;
+
+/* How much smaller than its logical size the draw target's viewport is,
+ * see Dynamic resolution below. */
+float PL_drawViewportScaleX = 1.0f;
+float PL_drawViewportScaleY = 1.0f;
+
 GLInfo PL_GL = { 0 };
 
 /* ------------------------------------------------------- Load Functions */
@@ -53,6 +62,7 @@ static void s_LoadGL() {
     PL_GL.glLoadIdentity = SDL_GL_GetProcAddress("glLoadIdentity");
     PL_GL.glPushMatrix = SDL_GL_GetProcAddress("glPushMatrix");
     PL_GL.glPopMatrix = SDL_GL_GetProcAddress("glPopMatrix");
+    PL_GL.glLoadMatrixf = SDL_GL_GetProcAddress("glLoadMatrixf");
     PL_GL.glOrtho = SDL_GL_GetProcAddress("glOrtho");
     
     PL_GL.glGenTextures = SDL_GL_GetProcAddress("glGenTextures");
@@ -64,9 +74,13 @@ static void s_LoadGL() {
     PL_GL.glTexImage2D = SDL_GL_GetProcAddress("glTexImage2D");
     PL_GL.glTexSubImage2D = SDL_GL_GetProcAddress("glTexSubImage2D");
     PL_GL.glReadPixels = SDL_GL_GetProcAddress("glReadPixels");
+    PL_GL.glCopyTexSubImage2D = SDL_GL_GetProcAddress("glCopyTexSubImage2D");
     
     PL_GL.glClearColor = SDL_GL_GetProcAddress("glClearColor");
     PL_GL.glClear = SDL_GL_GetProcAddress("glClear");
+    PL_GL.glClearDepth = SDL_GL_GetProcAddress("glClearDepth");
+    PL_GL.glDepthFunc = SDL_GL_GetProcAddress("glDepthFunc");
+    PL_GL.glDepthMask = SDL_GL_GetProcAddress("glDepthMask");
     
     PL_GL.glColor4f = SDL_GL_GetProcAddress("glColor4f");
     
@@ -95,6 +109,87 @@ static void s_LoadGL() {
         PL_GL.glDeleteFramebuffersEXT = SDL_GL_GetProcAddress("glDeleteFramebuffersEXT");
         PL_GL.glGenFramebuffersEXT = SDL_GL_GetProcAddress("glGenFramebuffersEXT");
         PL_GL.glCheckFramebufferStatusEXT = SDL_GL_GetProcAddress("glCheckFramebufferStatusEXT");
+        
+        PL_GL.glGenRenderbuffersEXT = SDL_GL_GetProcAddress("glGenRenderbuffersEXT");
+        PL_GL.glDeleteRenderbuffersEXT = SDL_GL_GetProcAddress("glDeleteRenderbuffersEXT");
+        PL_GL.glBindRenderbufferEXT = SDL_GL_GetProcAddress("glBindRenderbufferEXT");
+        PL_GL.glRenderbufferStorageEXT = SDL_GL_GetProcAddress("glRenderbufferStorageEXT");
+        PL_GL.glFramebufferRenderbufferEXT = SDL_GL_GetProcAddress("glFramebufferRenderbufferEXT");
+        
+        if (SDL_GL_ExtensionSupported("GL_EXT_framebuffer_blit")) {
+            PL_GL.glBlitFramebufferEXT = SDL_GL_GetProcAddress("glBlitFramebufferEXT");
+        }
+    }
+    
+    if (SDL_GL_ExtensionSupported("GL_ARB_timer_query")
+        || SDL_GL_ExtensionSupported("GL_EXT_timer_query")
+    ) {
+        PL_GL.glGenQueries = SDL_GL_GetProcAddress("glGenQueries");
+        PL_GL.glDeleteQueries = SDL_GL_GetProcAddress("glDeleteQueries");
+        PL_GL.glBeginQuery = SDL_GL_GetProcAddress("glBeginQuery");
+        PL_GL.glEndQuery = SDL_GL_GetProcAddress("glEndQuery");
+        PL_GL.glGetQueryObjectiv = SDL_GL_GetProcAddress("glGetQueryObjectiv");
+        PL_GL.glGetQueryObjectui64v = SDL_GL_GetProcAddress("glGetQueryObjectui64v");
+        if (PL_GL.glGetQueryObjectui64v == NULL) {
+            PL_GL.glGetQueryObjectui64v = SDL_GL_GetProcAddress("glGetQueryObjectui64vEXT");
+        }
+        
+        PL_GL.hasTimerQuerySupport = (PL_GL.glGenQueries != NULL
+                                      && PL_GL.glBeginQuery != NULL
+                                      && PL_GL.glGetQueryObjectui64v != NULL);
+    }
+    
+    if (SDL_GL_ExtensionSupported("GL_ARB_pixel_buffer_object")) {
+        PL_GL.glGenBuffers = SDL_GL_GetProcAddress("glGenBuffers");
+        PL_GL.glDeleteBuffers = SDL_GL_GetProcAddress("glDeleteBuffers");
+        PL_GL.glBindBuffer = SDL_GL_GetProcAddress("glBindBuffer");
+        PL_GL.glBufferData = SDL_GL_GetProcAddress("glBufferData");
+        PL_GL.glMapBuffer = SDL_GL_GetProcAddress("glMapBuffer");
+        PL_GL.glUnmapBuffer = SDL_GL_GetProcAddress("glUnmapBuffer");
+        
+        PL_GL.hasPixelBufferSupport = (PL_GL.glGenBuffers != NULL
+                                       && PL_GL.glDeleteBuffers != NULL
+                                       && PL_GL.glBindBuffer != NULL
+                                       && PL_GL.glBufferData != NULL
+                                       && PL_GL.glMapBuffer != NULL
+                                       && PL_GL.glUnmapBuffer != NULL);
+    }
+    
+    if (SDL_GL_ExtensionSupported("GL_ARB_sync")) {
+        PL_GL.glFenceSync = SDL_GL_GetProcAddress("glFenceSync");
+        PL_GL.glDeleteSync = SDL_GL_GetProcAddress("glDeleteSync");
+        PL_GL.glClientWaitSync = SDL_GL_GetProcAddress("glClientWaitSync");
+        
+        PL_GL.hasSyncSupport = (PL_GL.glFenceSync != NULL
+                                && PL_GL.glDeleteSync != NULL
+                                && PL_GL.glClientWaitSync != NULL);
+    }
+    
+    if (SDL_GL_ExtensionSupported("GL_ARB_fragment_shader")
+        && SDL_GL_ExtensionSupported("GL_ARB_shading_language_100")
+    ) {
+        PL_GL.glCreateShader = SDL_GL_GetProcAddress("glCreateShader");
+        PL_GL.glDeleteShader = SDL_GL_GetProcAddress("glDeleteShader");
+        PL_GL.glShaderSource = SDL_GL_GetProcAddress("glShaderSource");
+        PL_GL.glCompileShader = SDL_GL_GetProcAddress("glCompileShader");
+        PL_GL.glGetShaderiv = SDL_GL_GetProcAddress("glGetShaderiv");
+        PL_GL.glCreateProgram = SDL_GL_GetProcAddress("glCreateProgram");
+        PL_GL.glDeleteProgram = SDL_GL_GetProcAddress("glDeleteProgram");
+        PL_GL.glAttachShader = SDL_GL_GetProcAddress("glAttachShader");
+        PL_GL.glLinkProgram = SDL_GL_GetProcAddress("glLinkProgram");
+        PL_GL.glGetProgramiv = SDL_GL_GetProcAddress("glGetProgramiv");
+        PL_GL.glUseProgram = SDL_GL_GetProcAddress("glUseProgram");
+        PL_GL.glGetUniformLocation = SDL_GL_GetProcAddress("glGetUniformLocation");
+        PL_GL.glUniform1i = SDL_GL_GetProcAddress("glUniform1i");
+        
+        /* Only the GL 2.0 names are loaded, so check they're all there. */
+        PL_GL.hasShaderSupport = (PL_GL.glActiveTexture != NULL
+                                  && PL_GL.glCreateShader != NULL
+                                  && PL_GL.glShaderSource != NULL
+                                  && PL_GL.glCreateProgram != NULL
+                                  && PL_GL.glLinkProgram != NULL
+                                  && PL_GL.glUseProgram != NULL
+                                  && PL_GL.glUniform1i != NULL);
     }
     
     if (SDL_GL_ExtensionSupported("GL_ARB_texture_rectangle")
@@ -118,6 +213,376 @@ static void s_LoadGL() {
     PL_GL.isInitialized = DXTRUE;
 }
 
+/* --------------------------------------------------- Dynamic resolution */
+
+/* DxPortLib extension: dynamic resolution.
+ *
+ * The screen framebuffers are always allocated at full size, but only
+ * the top left part of the one being drawn to is used, by shrinking the
+ * viewport. The projection stays the same, so draw coordinates don't
+ * change, and s_drawRect stretches just that part out to the window.
+ *
+ * The scale for the next frame is picked at each ScreenFlip, from how
+ * long the GPU took on recent frames. That comes from timer queries,
+ * read back a few frames late so that we never wait on the GPU.
+ */
+#define TIMER_QUERY_COUNT 4
+
+static int s_dynResFlag = DXFALSE;
+static float s_dynResMinScale = 0.5f;
+static float s_dynResMaxScale = 1.0f;
+static float s_dynResTargetTime = 16.0f;
+static float s_dynResScale = 1.0f;
+static float s_dynResGPUTime = 0;
+
+/* Viewport sizes of the screen framebuffers. */
+static int s_screenViewWidthA = 0;
+static int s_screenViewHeightA = 0;
+static int s_screenViewWidthB = 0;
+static int s_screenViewHeightB = 0;
+
+static GLuint s_timerQueries[TIMER_QUERY_COUNT];
+static int s_timerQueryPending[TIMER_QUERY_COUNT];
+static int s_timerQueryIndex = 0;
+static int s_timerQueryActive = DXFALSE;
+static int s_timerQueriesCreated = DXFALSE;
+
+static void s_BeginFrameTimer() {
+    int slot = s_timerQueryIndex;
+    
+    if (s_dynResFlag == DXFALSE || PL_GL.hasTimerQuerySupport == DXFALSE) {
+        return;
+    }
+    
+    if (s_timerQueriesCreated == DXFALSE) {
+        PL_GL.glGenQueries(TIMER_QUERY_COUNT, s_timerQueries);
+        SDL_memset(s_timerQueryPending, 0, sizeof(s_timerQueryPending));
+        s_timerQueriesCreated = DXTRUE;
+    }
+    
+    /* If the GPU is that far behind, skip measuring this frame. */
+    if (s_timerQueryPending[slot]) {
+        return;
+    }
+    
+    PL_GL.glBeginQuery(GL_TIME_ELAPSED_EXT, s_timerQueries[slot]);
+    s_timerQueryActive = DXTRUE;
+}
+
+static void s_EndFrameTimer() {
+    if (s_timerQueryActive == DXFALSE) {
+        return;
+    }
+    
+    PL_GL.glEndQuery(GL_TIME_ELAPSED_EXT);
+    s_timerQueryPending[s_timerQueryIndex] = DXTRUE;
+    s_timerQueryIndex = (s_timerQueryIndex + 1) % TIMER_QUERY_COUNT;
+    s_timerQueryActive = DXFALSE;
+}
+
+/* Reads back every finished query, oldest first, and returns how many
+ * new results there were. */
+static int s_CollectFrameTimers() {
+    int count = 0;
+    int i;
+    
+    if (s_timerQueriesCreated == DXFALSE) {
+        return 0;
+    }
+    
+    for (i = 0; i < TIMER_QUERY_COUNT; ++i) {
+        int slot = (s_timerQueryIndex + i) % TIMER_QUERY_COUNT;
+        GLint available = 0;
+        GLuint64 elapsed = 0;
+        float ms;
+        
+        if (s_timerQueryPending[slot] == DXFALSE) {
+            continue;
+        }
+        
+        PL_GL.glGetQueryObjectiv(s_timerQueries[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available == 0) {
+            break;
+        }
+        PL_GL.glGetQueryObjectui64v(s_timerQueries[slot], GL_QUERY_RESULT, &elapsed);
+        s_timerQueryPending[slot] = DXFALSE;
+        
+        ms = (float)((double)elapsed / 1000000.0);
+        if (s_dynResGPUTime <= 0) {
+            s_dynResGPUTime = ms;
+        } else {
+            s_dynResGPUTime = (s_dynResGPUTime * 0.75f) + (ms * 0.25f);
+        }
+        count += 1;
+    }
+    
+    return count;
+}
+
+static void s_ReleaseFrameTimers() {
+    if (s_timerQueriesCreated) {
+        PL_GL.glDeleteQueries(TIMER_QUERY_COUNT, s_timerQueries);
+        s_timerQueriesCreated = DXFALSE;
+    }
+    s_timerQueryActive = DXFALSE;
+    s_timerQueryIndex = 0;
+    s_dynResGPUTime = 0;
+}
+
+/* Picks the scale for the next frame. GPU time goes roughly with the
+ * number of pixels, so the scale is nudged towards the square root of
+ * how far off we are, a little at a time, with some room in between
+ * so that it doesn't keep flipping back and forth. */
+static void s_UpdateDynamicResolution() {
+    float scale = s_dynResScale;
+    int active = s_dynResFlag && PL_GL.hasFramebufferSupport && PL_GL.hasTimerQuerySupport;
+    
+    if (active == DXFALSE) {
+        scale = 1.0f;
+    } else if (s_CollectFrameTimers() > 0) {
+        if (s_dynResGPUTime > s_dynResTargetTime * 0.95f) {
+            scale *= SDL_max(0.9f, (float)SDL_sqrt((s_dynResTargetTime * 0.85f) / s_dynResGPUTime));
+        } else if (s_dynResGPUTime < s_dynResTargetTime * 0.7f) {
+            scale *= 1.02f;
+        }
+    }
+    
+    if (active) {
+        if (scale < s_dynResMinScale) { scale = s_dynResMinScale; }
+        if (scale > s_dynResMaxScale) { scale = s_dynResMaxScale; }
+    }
+    
+    s_dynResScale = scale;
+    
+    s_screenViewWidthA = (int)SDL_ceil(PL_drawScreenWidth * scale);
+    s_screenViewHeightA = (int)SDL_ceil(PL_drawScreenHeight * scale);
+    if (s_screenViewWidthA < 1) { s_screenViewWidthA = 1; }
+    if (s_screenViewHeightA < 1) { s_screenViewHeightA = 1; }
+    if (s_screenViewWidthA > PL_drawScreenWidth) { s_screenViewWidthA = PL_drawScreenWidth; }
+    if (s_screenViewHeightA > PL_drawScreenHeight) { s_screenViewHeightA = PL_drawScreenHeight; }
+}
+
+int PL_EXT_Draw_SetDynamicResolutionFlag(int flag) {
+    flag = (flag != 0) ? DXTRUE : DXFALSE;
+    
+    if (flag && PL_GL.isInitialized
+        && (PL_GL.hasFramebufferSupport == DXFALSE || PL_GL.hasTimerQuerySupport == DXFALSE)
+    ) {
+        return -1;
+    }
+    
+    s_dynResFlag = flag;
+    
+    return 0;
+}
+
+int PL_EXT_Draw_SetDynamicResolutionRange(float minScale, float maxScale,
+                                          float targetMilliseconds) {
+    if (minScale <= 0 || maxScale > 1.0f || minScale > maxScale
+        || targetMilliseconds <= 0
+    ) {
+        return -1;
+    }
+    
+    s_dynResMinScale = minScale;
+    s_dynResMaxScale = maxScale;
+    s_dynResTargetTime = targetMilliseconds;
+    
+    return 0;
+}
+
+float PL_EXT_Draw_GetDynamicResolutionScale() {
+    return s_dynResScale;
+}
+
+/* ----------------------------------------------------- Frames in flight */
+
+/* DxPortLib extension: frames in flight.
+ *
+ * Drivers are free to queue up several frames before the GPU gets to
+ * them. That keeps the GPU busy, but input is that many frames old by
+ * the time it is shown. So a fence goes in after every ScreenFlip, and
+ * with a limit set, the next frame doesn't start until the fence from
+ * (limit - 1) frames ago has passed.
+ *
+ * The time from each ScreenFlip to its fence being seen as passed is
+ * kept as a rough measure of present latency. Fences are only looked at
+ * once per frame, so it errs on the high side.
+ */
+#define FRAME_FENCE_COUNT 3
+
+/* Don't wait forever on a GPU that has gone away. (100ms) */
+#define FRAME_FENCE_TIMEOUT 100000000
+
+static int s_framesInFlight = 0;
+static float s_presentLatency = 0;
+
+static GLsync s_frameFences[FRAME_FENCE_COUNT];
+static Uint64 s_frameFenceTimes[FRAME_FENCE_COUNT];
+static int s_frameFenceIndex = 0;
+
+/* Returns DXTRUE if the fence in slot has passed (or there is none). */
+static int s_CheckFrameFence(int slot, GLuint64 timeout) {
+    GLenum result;
+    
+    if (s_frameFences[slot] == NULL) {
+        return DXTRUE;
+    }
+    
+    result = PL_GL.glClientWaitSync(s_frameFences[slot],
+                                    (timeout > 0) ? GL_SYNC_FLUSH_COMMANDS_BIT : 0,
+                                    timeout);
+    if (result == GL_TIMEOUT_EXPIRED) {
+        return DXFALSE;
+    }
+    
+    if (result != GL_WAIT_FAILED) {
+        float ms = (float)((double)(SDL_GetPerformanceCounter() - s_frameFenceTimes[slot])
+                           * 1000.0 / (double)SDL_GetPerformanceFrequency());
+        if (s_presentLatency <= 0) {
+            s_presentLatency = ms;
+        } else {
+            s_presentLatency = (s_presentLatency * 0.75f) + (ms * 0.25f);
+        }
+    }
+    
+    PL_GL.glDeleteSync(s_frameFences[slot]);
+    s_frameFences[slot] = NULL;
+    
+    return DXTRUE;
+}
+
+static void s_EndFrameFence() {
+    int slot;
+    int i;
+    
+    if (PL_GL.hasSyncSupport == DXFALSE) {
+        return;
+    }
+    
+    /* Fences pass in order, so look at the oldest first. */
+    for (i = 0; i < FRAME_FENCE_COUNT; ++i) {
+        if (s_CheckFrameFence((s_frameFenceIndex + i) % FRAME_FENCE_COUNT, 0) == DXFALSE) {
+            break;
+        }
+    }
+    
+    /* With no limit, the GPU can be further behind than we keep track
+     * of. The oldest fence is just dropped then. */
+    slot = s_frameFenceIndex;
+    if (s_frameFences[slot] != NULL) {
+        PL_GL.glDeleteSync(s_frameFences[slot]);
+    }
+    
+    s_frameFences[slot] = PL_GL.glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    s_frameFenceTimes[slot] = SDL_GetPerformanceCounter();
+    s_frameFenceIndex = (slot + 1) % FRAME_FENCE_COUNT;
+    
+    if (s_framesInFlight > 0) {
+        slot = (s_frameFenceIndex - s_framesInFlight + FRAME_FENCE_COUNT) % FRAME_FENCE_COUNT;
+        s_CheckFrameFence(slot, FRAME_FENCE_TIMEOUT);
+    }
+}
+
+static void s_ReleaseFrameFences() {
+    int i;
+    
+    for (i = 0; i < FRAME_FENCE_COUNT; ++i) {
+        if (s_frameFences[i] != NULL) {
+            PL_GL.glDeleteSync(s_frameFences[i]);
+            s_frameFences[i] = NULL;
+        }
+    }
+    s_frameFenceIndex = 0;
+    s_presentLatency = 0;
+}
+
+int PL_EXT_Draw_SetMaxFramesInFlight(int count) {
+    if (count < 0 || count > FRAME_FENCE_COUNT) {
+        return -1;
+    }
+    
+    if (count > 0 && PL_GL.isInitialized && PL_GL.hasSyncSupport == DXFALSE) {
+        return -1;
+    }
+    
+    s_framesInFlight = count;
+    
+    return 0;
+}
+
+float PL_EXT_Draw_GetPresentLatency() {
+    return s_presentLatency;
+}
+
+/* ------------------------------------------------------- Loader context */
+
+/* DxPortLib extension: loader context.
+ *
+ * A second GL context, sharing textures with the main one, for
+ * ASyncLoad's upload thread to make current. Textures made there are
+ * fenced before they are handed over (see PL_Texture_PrepareFromSurface),
+ * so the main thread never waits on an upload.
+ *
+ * It has to be asked for before the window is made, and needs fence
+ * sync support.
+ */
+static int s_useLoaderContextFlag = DXFALSE;
+static SDL_GLContext s_loaderContext = NULL;
+static SDL_Window *s_loaderWindow = NULL;
+
+static void s_CreateLoaderContext(SDL_Window *window) {
+    if (s_useLoaderContextFlag == DXFALSE || PL_GL.hasSyncSupport == DXFALSE) {
+        return;
+    }
+    
+    /* Creating a context also makes it current, so switch back after. */
+    SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, 1);
+    s_loaderContext = SDL_GL_CreateContext(window);
+    SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, 0);
+    
+    if (s_loaderContext != NULL) {
+        s_loaderWindow = window;
+    }
+    
+    SDL_GL_MakeCurrent(window, s_context);
+}
+
+static void s_DestroyLoaderContext() {
+    if (s_loaderContext != NULL) {
+        SDL_GL_DeleteContext(s_loaderContext);
+        s_loaderContext = NULL;
+    }
+    s_loaderWindow = NULL;
+}
+
+int PL_Draw_HasLoaderContext() {
+    return (s_loaderContext != NULL) ? DXTRUE : DXFALSE;
+}
+
+/* Called on the upload thread itself. */
+int PL_Draw_BindLoaderContext() {
+    if (s_loaderContext == NULL) {
+        return -1;
+    }
+    
+    return SDL_GL_MakeCurrent(s_loaderWindow, s_loaderContext);
+}
+void PL_Draw_UnbindLoaderContext() {
+    if (s_loaderContext != NULL) {
+        SDL_GL_MakeCurrent(s_loaderWindow, NULL);
+    }
+}
+
+int PL_EXT_Draw_SetLoaderContextFlag(int flag) {
+    if (PL_GL.isInitialized) {
+        return -1;
+    }
+    
+    s_useLoaderContextFlag = (flag == 0) ? DXFALSE : DXTRUE;
+    return 0;
+}
+
 /* ------------------------------------------------------- Window context */
 
 static int s_currentScreenID = -1;
@@ -129,6 +594,17 @@ int PL_Draw_UpdateDrawScreen() {
         s_currentScreenID = s_drawScreenID;
         PL_Texture_BindFramebuffer(s_drawScreenID);
         
+        PL_drawViewportScaleX = 1.0f;
+        PL_drawViewportScaleY = 1.0f;
+        if (s_drawScreenID == s_screenFrameBufferA
+            && (s_screenViewWidthA != PL_drawScreenWidth
+                || s_screenViewHeightA != PL_drawScreenHeight)
+        ) {
+            PL_GL.glViewport(0, 0, s_screenViewWidthA, s_screenViewHeightA);
+            PL_drawViewportScaleX = (float)s_screenViewWidthA / (float)PL_drawScreenWidth;
+            PL_drawViewportScaleY = (float)s_screenViewHeightA / (float)PL_drawScreenHeight;
+        }
+        
         PL_GL.glDisable(GL_DEPTH_TEST);
         PL_GL.glDisable(GL_CULL_FACE);
         
@@ -141,6 +617,8 @@ int PL_Draw_UpdateDrawScreen() {
 
 int PL_Draw_SetDrawScreen(int graphID) {
     int textureID = PL_Graph_GetTextureID(graphID, NULL);
+    SDL_Rect texRect;
+    float xMult, yMult;
     
     PL_Draw_FlushCache();
     
@@ -152,6 +630,16 @@ int PL_Draw_SetDrawScreen(int graphID) {
         s_drawGraphID = -1;
     }
     
+    if (s_drawGraphID >= 0
+        && PL_Texture_RenderGetTextureInfo(textureID, &texRect, &xMult, &yMult) >= 0
+    ) {
+        PL_drawTargetWidth = texRect.w;
+        PL_drawTargetHeight = texRect.h;
+    } else {
+        PL_drawTargetWidth = PL_drawScreenWidth;
+        PL_drawTargetHeight = PL_drawScreenHeight;
+    }
+    
     return 0;
 }
 
@@ -162,6 +650,478 @@ int PL_Draw_GetDrawScreen() {
     return s_drawGraphID;
 }
 
+int PL_Draw_AddDepthBuffer() {
+    return PL_Texture_AddDepthBuffer(s_drawScreenID);
+}
+
+static void s_GetPixelRect(int x1, int y1, int x2, int y2,
+                           float scaleX, float scaleY, SDL_Rect *rect);
+
+/* Copies (x1,y1)-(x2,y2) of the framebuffer texture srcTextureRefID
+ * into destGraphID at (destX,destY), clipped to both.
+ *
+ * Framebuffer textures are stored top row first, same as loaded
+ * images, so no flipping is needed.
+ *
+ * With dynamic resolution, the back screen is drawn smaller, into the
+ * top-left of its texture, so that part is scaled back up instead.
+ */
+static int s_CopyFramebufferToGraph(int srcTextureRefID, int x1, int y1, int x2, int y2,
+                                    int destX, int destY, int destGraphID) {
+    SDL_Rect srcTexRect, destRect, srcRect;
+    float xMult, yMult;
+    int destTextureRefID;
+    int scaledFlag;
+    int retval;
+    
+    if (PL_GL.hasFramebufferSupport == DXFALSE) {
+        return -1;
+    }
+    
+    /* Only screens and MakeScreen graphs can be copied from. */
+    if (PL_Texture_HasFramebuffer(srcTextureRefID) == DXFALSE) {
+        return -1;
+    }
+    
+    destTextureRefID = PL_Graph_GetTextureID(destGraphID, &destRect);
+    if (destTextureRefID < 0 || destTextureRefID == srcTextureRefID) {
+        return -1;
+    }
+    if (PL_Texture_RenderGetTextureInfo(srcTextureRefID, &srcTexRect, &xMult, &yMult) < 0) {
+        return -1;
+    }
+    
+    scaledFlag = (srcTextureRefID == s_screenFrameBufferA
+                  && (s_screenViewWidthA != srcTexRect.w
+                      || s_screenViewHeightA != srcTexRect.h));
+    
+    /* Clip against the source texture. */
+    if (x1 < 0) { destX -= x1; x1 = 0; }
+    if (y1 < 0) { destY -= y1; y1 = 0; }
+    if (x2 > srcTexRect.w) { x2 = srcTexRect.w; }
+    if (y2 > srcTexRect.h) { y2 = srcTexRect.h; }
+    
+    /* Clip against the destination graph. */
+    if (destX < 0) { x1 -= destX; destX = 0; }
+    if (destY < 0) { y1 -= destY; destY = 0; }
+    if ((x2 - x1) > (destRect.w - destX)) { x2 = x1 + destRect.w - destX; }
+    if ((y2 - y1) > (destRect.h - destY)) { y2 = y1 + destRect.h - destY; }
+    
+    if (x2 <= x1 || y2 <= y1) {
+        return 0;
+    }
+    
+    srcRect.x = x1;
+    srcRect.y = y1;
+    srcRect.w = x2 - x1;
+    srcRect.h = y2 - y1;
+    
+    PL_Draw_FlushCache();
+    
+    PL_Graph_StopSharing(destGraphID);
+    
+    if (scaledFlag) {
+        SDL_Rect pixelRect, targetRect;
+        
+        s_GetPixelRect(x1, y1, x2, y2,
+                       (float)s_screenViewWidthA / (float)srcTexRect.w,
+                       (float)s_screenViewHeightA / (float)srcTexRect.h,
+                       &pixelRect);
+        
+        targetRect.x = destRect.x + destX;
+        targetRect.y = destRect.y + destY;
+        targetRect.w = srcRect.w;
+        targetRect.h = srcRect.h;
+        
+        retval = PL_Texture_BlitFramebufferToTexture(srcTextureRefID, &pixelRect,
+                                                     destTextureRefID, &targetRect);
+    } else {
+        retval = PL_Texture_BindFramebuffer(srcTextureRefID);
+        if (retval == 0) {
+            retval = PL_Texture_CopyFramebufferToTexture(destTextureRefID,
+                                                         destRect.x + destX, destRect.y + destY,
+                                                         &srcRect);
+        }
+    }
+    
+    /* Force the draw screen to be rebound on the next draw. */
+    s_currentScreenID = -1;
+    
+    return retval;
+}
+
+int PL_Draw_GetDrawScreenGraph(int x1, int y1, int x2, int y2, int destGraphID) {
+    return s_CopyFramebufferToGraph(s_drawScreenID, x1, y1, x2, y2,
+                                    0, 0, destGraphID);
+}
+
+int PL_Draw_BltDrawValidGraph(int srcGraphID, int x1, int y1, int x2, int y2,
+                              int destX, int destY, int destGraphID) {
+    SDL_Rect srcRect;
+    int srcTextureRefID = PL_Graph_GetTextureID(srcGraphID, &srcRect);
+    if (srcTextureRefID < 0) {
+        return -1;
+    }
+    
+    /* Clip against the source graph, so one derived from a larger
+     * screen can't read its neighbours' pixels. */
+    if (x1 < 0) { destX -= x1; x1 = 0; }
+    if (y1 < 0) { destY -= y1; y1 = 0; }
+    if (x2 > srcRect.w) { x2 = srcRect.w; }
+    if (y2 > srcRect.h) { y2 = srcRect.h; }
+    
+    return s_CopyFramebufferToGraph(srcTextureRefID,
+                                    srcRect.x + x1, srcRect.y + y1,
+                                    srcRect.x + x2, srcRect.y + y2,
+                                    destX, destY, destGraphID);
+}
+
+/* ------------------------------------------------------- Pixel readback */
+
+/* DxPortLib extension: cached pixel readback.
+ *
+ * Reading the screen back makes the CPU wait for the GPU to catch up,
+ * so doing it for every GetPixel is slow. Instead, regions of the back
+ * screen can be requested during a frame with EXT_RequestPixelRegion.
+ * At ScreenFlip they are all read into one pixel buffer object, which
+ * doesn't wait, and during the next frame GetPixel and GetPixelRegion
+ * answer from that copy. The buffer is only mapped on the first query,
+ * by which time the GPU is normally done with it.
+ *
+ * Anything that wasn't requested, or is on another draw screen, is
+ * read back right away, same as before.
+ */
+#define READBACK_REGION_MAX 32
+
+typedef struct ReadbackRegion {
+    /* In draw coordinates. */
+    int x1, y1, x2, y2;
+    
+    /* In framebuffer pixels, which differ with dynamic resolution. */
+    SDL_Rect pixelRect;
+    
+    size_t offset;
+} ReadbackRegion;
+
+static SDL_Rect s_readbackRequests[READBACK_REGION_MAX];
+static int s_readbackRequestCount = 0;
+
+static ReadbackRegion s_readbackRegions[READBACK_REGION_MAX];
+static int s_readbackRegionCount = 0;
+static float s_readbackScaleX = 1.0f;
+static float s_readbackScaleY = 1.0f;
+
+static Uint32 *s_readbackPixels = NULL;
+static size_t s_readbackPixelsSize = 0;
+static GLuint s_readbackBuffer = 0;
+static int s_readbackPending = DXFALSE;
+
+/* Converts draw rect (x1,y1)-(x2,y2) to the framebuffer pixels it
+ * covers at the given scale. */
+static void s_GetPixelRect(int x1, int y1, int x2, int y2,
+                           float scaleX, float scaleY, SDL_Rect *rect) {
+    int px1 = (int)SDL_floor(x1 * scaleX);
+    int py1 = (int)SDL_floor(y1 * scaleY);
+    int px2 = (int)SDL_ceil(x2 * scaleX);
+    int py2 = (int)SDL_ceil(y2 * scaleY);
+    
+    rect->x = px1;
+    rect->y = py1;
+    rect->w = px2 - px1;
+    rect->h = py2 - py1;
+}
+
+/* Fills colors with (x1,y1)-(x2,y2), from pixels holding pixelRect. */
+static void s_SamplePixels(const Uint32 *pixels, const SDL_Rect *pixelRect,
+                           float scaleX, float scaleY,
+                           int x1, int y1, int x2, int y2, DXCOLOR *colors) {
+    int x, y;
+    
+    for (y = y1; y < y2; ++y) {
+        const Uint32 *row = pixels
+            + (((int)SDL_floor(y * scaleY) - pixelRect->y) * pixelRect->w);
+        
+        for (x = x1; x < x2; ++x) {
+            Uint32 c = row[(int)SDL_floor(x * scaleX) - pixelRect->x];
+            *colors++ = ((c >> 16) & 0xff) | (c & 0xff00) | ((c & 0xff) << 16);
+        }
+    }
+}
+
+static int s_ReservePixels(size_t count) {
+    if (count > s_readbackPixelsSize) {
+        Uint32 *pixels = (Uint32 *)DXREALLOC(s_readbackPixels, count * sizeof(Uint32));
+        if (pixels == NULL) {
+            return -1;
+        }
+        s_readbackPixels = pixels;
+        s_readbackPixelsSize = count;
+    }
+    return 0;
+}
+
+/* Reads every region requested this frame from screen A. Called at
+ * ScreenFlip, before the screens are swapped. */
+static void s_CaptureReadbackRegions() {
+    size_t total = 0;
+    int viewWidth = s_screenViewWidthA;
+    int viewHeight = s_screenViewHeightA;
+    int i;
+    
+    s_readbackRegionCount = 0;
+    s_readbackPending = DXFALSE;
+    
+    if (s_readbackRequestCount == 0 || PL_GL.hasFramebufferSupport == DXFALSE) {
+        s_readbackRequestCount = 0;
+        return;
+    }
+    
+    s_readbackScaleX = (float)viewWidth / (float)PL_drawScreenWidth;
+    s_readbackScaleY = (float)viewHeight / (float)PL_drawScreenHeight;
+    
+    for (i = 0; i < s_readbackRequestCount; ++i) {
+        const SDL_Rect *request = &s_readbackRequests[i];
+        ReadbackRegion *region = &s_readbackRegions[s_readbackRegionCount];
+        
+        region->x1 = request->x;
+        region->y1 = request->y;
+        region->x2 = request->x + request->w;
+        region->y2 = request->y + request->h;
+        s_GetPixelRect(region->x1, region->y1, region->x2, region->y2,
+                       s_readbackScaleX, s_readbackScaleY, &region->pixelRect);
+        if (region->pixelRect.x + region->pixelRect.w > viewWidth
+            || region->pixelRect.y + region->pixelRect.h > viewHeight
+        ) {
+            continue;
+        }
+        
+        region->offset = total;
+        total += (size_t)region->pixelRect.w * (size_t)region->pixelRect.h;
+        s_readbackRegionCount += 1;
+    }
+    s_readbackRequestCount = 0;
+    
+    if (s_ReservePixels(total) < 0) {
+        s_readbackRegionCount = 0;
+        return;
+    }
+    
+    PL_Texture_BindFramebuffer(s_screenFrameBufferA);
+    s_currentScreenID = -1;
+    
+    PL_GL.glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    PL_GL.glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+    
+    if (PL_GL.hasPixelBufferSupport) {
+        if (s_readbackBuffer == 0) {
+            PL_GL.glGenBuffers(1, &s_readbackBuffer);
+        }
+        PL_GL.glBindBuffer(GL_PIXEL_PACK_BUFFER, s_readbackBuffer);
+        PL_GL.glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)(total * sizeof(Uint32)),
+                           NULL, GL_STREAM_READ);
+    }
+    
+    for (i = 0; i < s_readbackRegionCount; ++i) {
+        const ReadbackRegion *region = &s_readbackRegions[i];
+        GLvoid *dest;
+        
+        /* With a buffer bound, the pointer is an offset into it. */
+        if (PL_GL.hasPixelBufferSupport) {
+            dest = (GLvoid *)(region->offset * sizeof(Uint32));
+        } else {
+            dest = s_readbackPixels + region->offset;
+        }
+        
+        PL_GL.glReadPixels(region->pixelRect.x, region->pixelRect.y,
+                           region->pixelRect.w, region->pixelRect.h,
+                           GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, dest);
+    }
+    
+    if (PL_GL.hasPixelBufferSupport) {
+        PL_GL.glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        s_readbackPending = DXTRUE;
+    }
+}
+
+/* Finds a captured region holding all of (x1,y1)-(x2,y2), making sure
+ * its pixels have made it out of the buffer first. */
+static const ReadbackRegion *s_FindReadbackRegion(int x1, int y1, int x2, int y2) {
+    int i;
+    
+    if (s_drawGraphID >= 0) {
+        return NULL;
+    }
+    
+    for (i = 0; i < s_readbackRegionCount; ++i) {
+        const ReadbackRegion *region = &s_readbackRegions[i];
+        if (x1 >= region->x1 && y1 >= region->y1
+            && x2 <= region->x2 && y2 <= region->y2
+        ) {
+            break;
+        }
+    }
+    if (i == s_readbackRegionCount) {
+        return NULL;
+    }
+    
+    if (s_readbackPending) {
+        const ReadbackRegion *last = &s_readbackRegions[s_readbackRegionCount - 1];
+        size_t total = last->offset + ((size_t)last->pixelRect.w * (size_t)last->pixelRect.h);
+        GLvoid *data;
+        
+        PL_GL.glBindBuffer(GL_PIXEL_PACK_BUFFER, s_readbackBuffer);
+        data = PL_GL.glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+        if (data != NULL) {
+            SDL_memcpy(s_readbackPixels, data, total * sizeof(Uint32));
+            PL_GL.glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+        PL_GL.glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        
+        s_readbackPending = DXFALSE;
+        if (data == NULL) {
+            s_readbackRegionCount = 0;
+            return NULL;
+        }
+    }
+    
+    return &s_readbackRegions[i];
+}
+
+static void s_ReleaseReadback() {
+    if (s_readbackBuffer != 0) {
+        PL_GL.glDeleteBuffers(1, &s_readbackBuffer);
+        s_readbackBuffer = 0;
+    }
+    if (s_readbackPixels != NULL) {
+        DXFREE(s_readbackPixels);
+        s_readbackPixels = NULL;
+    }
+    s_readbackPixelsSize = 0;
+    s_readbackRequestCount = 0;
+    s_readbackRegionCount = 0;
+    s_readbackPending = DXFALSE;
+}
+
+int PL_EXT_Draw_RequestPixelRegion(int x1, int y1, int x2, int y2) {
+    SDL_Rect *request;
+    
+    if (x1 < 0 || y1 < 0 || x2 > PL_drawScreenWidth || y2 > PL_drawScreenHeight
+        || x2 <= x1 || y2 <= y1
+        || s_readbackRequestCount >= READBACK_REGION_MAX
+    ) {
+        return -1;
+    }
+    
+    request = &s_readbackRequests[s_readbackRequestCount++];
+    request->x = x1;
+    request->y = y1;
+    request->w = x2 - x1;
+    request->h = y2 - y1;
+    
+    return 0;
+}
+
+int PL_Draw_GetPixelRegion(int x1, int y1, int x2, int y2, DXCOLOR *colors) {
+    const ReadbackRegion *region;
+    SDL_Rect pixelRect;
+    Uint32 *pixels;
+    
+    if (PL_GL.hasFramebufferSupport == DXFALSE
+        || x1 < 0 || y1 < 0 || x2 > PL_drawTargetWidth || y2 > PL_drawTargetHeight
+        || x2 <= x1 || y2 <= y1
+    ) {
+        return -1;
+    }
+    
+    region = s_FindReadbackRegion(x1, y1, x2, y2);
+    if (region != NULL) {
+        s_SamplePixels(s_readbackPixels + region->offset, &region->pixelRect,
+                       s_readbackScaleX, s_readbackScaleY,
+                       x1, y1, x2, y2, colors);
+        return 0;
+    }
+    
+    /* Not cached, so read it right now. */
+    PL_Draw_FlushCache();
+    PL_Draw_UpdateDrawScreen();
+    
+    s_GetPixelRect(x1, y1, x2, y2, PL_drawViewportScaleX, PL_drawViewportScaleY, &pixelRect);
+    
+    pixels = (Uint32 *)DXALLOC((size_t)pixelRect.w * (size_t)pixelRect.h * sizeof(Uint32));
+    if (pixels == NULL) {
+        return -1;
+    }
+    
+    PL_GL.glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    PL_GL.glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+    PL_GL.glReadPixels(pixelRect.x, pixelRect.y, pixelRect.w, pixelRect.h,
+                       GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, pixels);
+    
+    s_SamplePixels(pixels, &pixelRect, PL_drawViewportScaleX, PL_drawViewportScaleY,
+                   x1, y1, x2, y2, colors);
+    
+    DXFREE(pixels);
+    
+    return 0;
+}
+
+/* Reads (x1,y1)-(x2,y2) of the draw screen into a new surface, at full
+ * size. With dynamic resolution, the smaller image actually drawn is
+ * scaled back up to match. */
+int PL_Draw_GetScreenSurface(int x1, int y1, int x2, int y2, SDL_Surface **dSurface) {
+    SDL_Rect pixelRect;
+    SDL_Surface *surface, *scaledSurface;
+    
+    if (x1 < 0 || y1 < 0 || x2 > PL_drawTargetWidth || y2 > PL_drawTargetHeight
+        || x2 <= x1 || y2 <= y1
+    ) {
+        return -1;
+    }
+    
+    PL_Draw_FlushCache();
+    PL_Draw_UpdateDrawScreen();
+    
+    s_GetPixelRect(x1, y1, x2, y2, PL_drawViewportScaleX, PL_drawViewportScaleY, &pixelRect);
+    
+    if (PL_Framebuffer_GetSurface(&pixelRect, &surface) < 0) {
+        return -1;
+    }
+    
+    if (pixelRect.w == x2 - x1 && pixelRect.h == y2 - y1) {
+        *dSurface = surface;
+        return 0;
+    }
+    
+    scaledSurface = SDL_CreateRGBSurface(SDL_SWSURFACE, x2 - x1, y2 - y1, 32,
+                                         0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000);
+    if (scaledSurface == NULL) {
+        SDL_FreeSurface(surface);
+        return -1;
+    }
+    
+    SDL_SetSurfaceBlendMode(surface, SDL_BLENDMODE_NONE);
+    if (SDL_BlitScaled(surface, NULL, scaledSurface, NULL) < 0) {
+        SDL_FreeSurface(scaledSurface);
+        SDL_FreeSurface(surface);
+        return -1;
+    }
+    SDL_FreeSurface(surface);
+    
+    *dSurface = scaledSurface;
+    
+    return 0;
+}
+
+DXCOLOR PL_Draw_GetPixel(int x, int y) {
+    DXCOLOR color;
+    
+    if (PL_Draw_GetPixelRegion(x, y, x + 1, y + 1, &color) < 0) {
+        return 0xffffffff;
+    }
+    
+    return color;
+}
+
 void PL_Draw_ResizeWindow(int width, int height) {
     if (!PL_GL.isInitialized) {
         return;
@@ -174,6 +1134,20 @@ void PL_Draw_ResizeWindow(int width, int height) {
     PL_drawScreenWidth = width;
     PL_drawScreenHeight = height;
     
+    s_screenViewWidthA = width;
+    s_screenViewHeightA = height;
+    s_screenViewWidthB = width;
+    s_screenViewHeightB = height;
+    
+    /* Anything read back was for the old size. */
+    s_readbackRegionCount = 0;
+    s_readbackPending = DXFALSE;
+    
+    if (s_drawGraphID < 0) {
+        PL_drawTargetWidth = width;
+        PL_drawTargetHeight = height;
+    }
+    
     if (PL_GL.hasFramebufferSupport == DXFALSE) {
         return;
     }
@@ -218,8 +1192,8 @@ static void s_drawRect(const SDL_Rect *rect) {
 
     tcx1 = (float)texRect.x * xMult;
     tcy1 = (float)texRect.y * yMult;
-    tcx2 = tcx1 + ((float)texRect.w * xMult);
-    tcy2 = tcy1 + ((float)texRect.h * yMult);
+    tcx2 = tcx1 + ((float)s_screenViewWidthB * xMult);
+    tcy2 = tcy1 + ((float)s_screenViewHeightB * yMult);
     
     v[0].x = x1; v[0].y = y1; v[0].tcx = tcx1; v[0].tcy = tcy1;
     v[1].x = x2; v[1].y = y1; v[1].tcx = tcx2; v[1].tcy = tcy1;
@@ -291,6 +1265,8 @@ void PL_Draw_Refresh(SDL_Window *window, const SDL_Rect *targetRect) {
     
     /* Rebind the new buffer. */
     s_drawScreenID = s_screenFrameBufferA;
+    PL_drawTargetWidth = PL_drawScreenWidth;
+    PL_drawTargetHeight = PL_drawScreenHeight;
     /* s_BindActiveFramebuffer(); */
 }
 
@@ -301,12 +1277,23 @@ void PL_Draw_SwapBuffers(SDL_Window *window, const SDL_Rect *targetRect) {
     }
     
     PL_Draw_FlushCache();
+    s_EndFrameTimer();
+    
+    s_CaptureReadbackRegions();
     
     tempBuffer = s_screenFrameBufferB;
     s_screenFrameBufferB = s_screenFrameBufferA;
     s_screenFrameBufferA = tempBuffer;
     
+    s_screenViewWidthB = s_screenViewWidthA;
+    s_screenViewHeightB = s_screenViewHeightA;
+    
     PL_Draw_Refresh(window, targetRect);
+    
+    s_EndFrameFence();
+    
+    s_UpdateDynamicResolution();
+    s_BeginFrameTimer();
 }
 
 void PL_Draw_Init(SDL_Window *window, int width, int height, int vsyncFlag) {
@@ -329,6 +1316,8 @@ void PL_Draw_Init(SDL_Window *window, int width, int height, int vsyncFlag) {
     
     s_LoadGL();
     
+    s_CreateLoaderContext(window);
+    
     PL_Draw_InitCache();
     
     PL_Draw_ResizeWindow(width, height);
@@ -340,16 +1329,23 @@ void PL_Draw_End() {
     PL_Draw_DestroyCache();
     
     if (s_context != NULL) {
+        s_ReleaseFrameTimers();
+        s_ReleaseFrameFences();
+        s_ReleaseReadback();
+        
         PL_Texture_Release(s_screenFrameBufferA);
         PL_Texture_Release(s_screenFrameBufferB);
         
         PL_Texture_ClearAllData();
         
+        s_DestroyLoaderContext();
         SDL_GL_DeleteContext(s_context);
     }
     
     PL_drawScreenWidth = -1;
     PL_drawScreenHeight = -1;
+    PL_drawTargetWidth = -1;
+    PL_drawTargetHeight = -1;
     
     SDL_memset(&PL_GL, 0, sizeof(PL_GL));
 }
@@ -32,6 +32,7 @@
  */
 typedef struct FramebufferInfo {
     GLuint framebufferID;
+    GLuint depthBufferID;
     
     int width;
     int height;
@@ -109,6 +110,7 @@ static int s_GLFrameBuffer_Create(int width, int height) {
         info = (FramebufferInfo *)PL_Handle_AllocateData(handleID, sizeof(FramebufferInfo));
         
         PL_GL.glGenFramebuffersEXT(1, &info->framebufferID);
+        info->depthBufferID = 0;
         info->width = width;
         info->height = height;
         info->refCount = 1;
@@ -131,6 +133,10 @@ static int s_GLFrameBuffer_Release(int handleID) {
     
     info->refCount -= 1;
     if (info->refCount <= 0) {
+        if (info->depthBufferID != 0) {
+            PL_GL.glDeleteRenderbuffersEXT(1, &info->depthBufferID);
+            info->depthBufferID = 0;
+        }
         PL_GL.glDeleteFramebuffersEXT(1, &info->framebufferID);
         info->framebufferID = 0;
         
@@ -150,8 +156,8 @@ int PL_Framebuffer_GetSurface(const SDL_Rect *rect, SDL_Surface **dSurface) {
         return -1;
     }
     
-    PL_GL.glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-    PL_GL.glPixelStorei(GL_UNPACK_ROW_LENGTH, (surface->pitch / surface->format->BytesPerPixel));
+    PL_GL.glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    PL_GL.glPixelStorei(GL_PACK_ROW_LENGTH, (surface->pitch / surface->format->BytesPerPixel));
     PL_GL.glReadPixels(
         rect->x, rect->y, rect->w, rect->h,
         GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV,
@@ -165,6 +171,11 @@ int PL_Framebuffer_GetSurface(const SDL_Rect *rect, SDL_Surface **dSurface) {
 
 /* ------------------------------------------------------------- Textures */
 
+struct TiledTexture;
+struct TexturePalette;
+
+static void s_BindPalette(struct TexturePalette *palette);
+
 typedef struct TextureRef {
     GLuint textureID;
     
@@ -188,6 +199,13 @@ typedef struct TextureRef {
     
     int framebufferID;
     
+    /* Not NULL for tiled textures, which have no GL texture of their
+     * own. See Tiled textures below. */
+    struct TiledTexture *tiled;
+    
+    /* Not NULL for 8-bit textures, see Palette textures below. */
+    struct TexturePalette *palette;
+    
     int refCount;
 } TextureRef;
 
@@ -210,6 +228,8 @@ static int s_AllocateTextureRefID(GLuint textureID) {
     textureref = (TextureRef *)PL_Handle_AllocateData(textureRefID, sizeof(TextureRef));
     textureref->textureID = textureID;
     textureref->framebufferID = -1;
+    textureref->tiled = NULL;
+    textureref->palette = NULL;
     textureref->refCount = 0;
     
     return textureRefID;
@@ -239,11 +259,16 @@ int PL_Texture_Bind(int textureRefID, int drawMode) {
         return -1;
     }
     
+    if (textureref->palette != NULL) {
+        s_BindPalette(textureref->palette);
+    }
+    
     textureTarget = textureref->glTarget;
     PL_GL.glEnable(textureTarget);
     PL_GL.glBindTexture(textureTarget, textureref->textureID);
     
-    if (drawMode != textureref->drawMode) {
+    /* Filtering palette indices makes no sense, so those stay nearest. */
+    if (drawMode != textureref->drawMode && textureref->palette == NULL) {
         textureref->drawMode = drawMode;
         switch(drawMode) {
             case DX_DRAWMODE_NEAREST:
@@ -267,6 +292,10 @@ int PL_Texture_Unbind(int textureRefID) {
         return -1;
     }
     
+    if (textureref->palette != NULL) {
+        PL_GL.glUseProgram(0);
+    }
+    
     PL_GL.glDisable(textureref->glTarget);
     return 0;
 }
@@ -285,6 +314,174 @@ int PL_Texture_BindFramebuffer(int textureRefID) {
     return s_GLFrameBuffer_Bind(framebufferID, textureTarget, textureID);
 }
 
+/* Returns DXTRUE if the texture can be drawn to, and so read from
+ * as a framebuffer. */
+int PL_Texture_HasFramebuffer(int textureRefID) {
+    TextureRef *textureref = (TextureRef*)PL_Handle_GetData(textureRefID, DXHANDLE_TEXTURE);
+    
+    return (textureref != NULL && textureref->framebufferID >= 0) ? DXTRUE : DXFALSE;
+}
+
+/* Makes sure the framebuffer behind textureRefID has a depth buffer
+ * attached, creating it the first time it is asked for. The
+ * framebuffer is left bound. */
+int PL_Texture_AddDepthBuffer(int textureRefID) {
+    TextureRef *textureref = (TextureRef*)PL_Handle_GetData(textureRefID, DXHANDLE_TEXTURE);
+    FramebufferInfo *info;
+    
+    if (PL_GL.hasFramebufferSupport == DXFALSE || textureref == NULL) {
+        return -1;
+    }
+    
+    info = (FramebufferInfo *)PL_Handle_GetData(textureref->framebufferID, DXHANDLE_FRAMEBUFFER);
+    if (info == NULL) {
+        return -1;
+    }
+    
+    if (info->depthBufferID == 0) {
+        PL_GL.glGenRenderbuffersEXT(1, &info->depthBufferID);
+        PL_GL.glBindRenderbufferEXT(GL_RENDERBUFFER_EXT, info->depthBufferID);
+        PL_GL.glRenderbufferStorageEXT(GL_RENDERBUFFER_EXT, GL_DEPTH_COMPONENT24,
+                                       info->width, info->height);
+        PL_GL.glBindRenderbufferEXT(GL_RENDERBUFFER_EXT, 0);
+        
+        PL_GL.glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, info->framebufferID);
+        PL_GL.glFramebufferRenderbufferEXT(GL_FRAMEBUFFER_EXT,
+                                           GL_DEPTH_ATTACHMENT_EXT,
+                                           GL_RENDERBUFFER_EXT,
+                                           info->depthBufferID);
+        
+        if (PL_GL.glCheckFramebufferStatusEXT(GL_FRAMEBUFFER_EXT) != GL_FRAMEBUFFER_COMPLETE_EXT) {
+            /* Not every driver takes a 24-bit depth buffer; give up
+             * on depth rather than lose the colour buffer too. */
+            PL_GL.glFramebufferRenderbufferEXT(GL_FRAMEBUFFER_EXT,
+                                               GL_DEPTH_ATTACHMENT_EXT,
+                                               GL_RENDERBUFFER_EXT, 0);
+            PL_GL.glDeleteRenderbuffersEXT(1, &info->depthBufferID);
+            info->depthBufferID = 0;
+            return -1;
+        }
+    }
+    
+    PL_GL.glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, info->framebufferID);
+    
+    return 0;
+}
+
+/* Copies srcRect of the currently bound framebuffer into the texture
+ * at (destX, destY). Everything stays on the GPU. */
+int PL_Texture_CopyFramebufferToTexture(int textureRefID, int destX, int destY,
+                                        const SDL_Rect *srcRect) {
+    TextureRef *textureref = (TextureRef*)PL_Handle_GetData(textureRefID, DXHANDLE_TEXTURE);
+    GLuint textureTarget;
+    if (textureref == NULL || textureref->textureID == 0
+        || textureref->palette != NULL
+    ) {
+        return -1;
+    }
+    
+    textureTarget = textureref->glTarget;
+    
+    PL_GL.glEnable(textureTarget);
+    PL_GL.glBindTexture(textureTarget, textureref->textureID);
+    PL_GL.glCopyTexSubImage2D(textureTarget, 0,
+                              destX, destY,
+                              srcRect->x, srcRect->y, srcRect->w, srcRect->h);
+    PL_GL.glDisable(textureTarget);
+    
+    return 0;
+}
+
+static int s_ConvertAndBlitSurface(TextureRef *textureref, SDL_Surface *surface,
+                                   const SDL_Rect *rect);
+
+/* Copies srcRect of a framebuffer texture into destRect of another
+ * texture, scaling it to fit. The framebuffer ends up unbound.
+ * With GL_EXT_framebuffer_blit, this stays on the GPU. Without it,
+ * the pixels are read back and scaled here instead. */
+int PL_Texture_BlitFramebufferToTexture(int srcTextureRefID, const SDL_Rect *srcRect,
+                                        int destTextureRefID, const SDL_Rect *destRect) {
+    TextureRef *srcref = (TextureRef*)PL_Handle_GetData(srcTextureRefID, DXHANDLE_TEXTURE);
+    TextureRef *destref = (TextureRef*)PL_Handle_GetData(destTextureRefID, DXHANDLE_TEXTURE);
+    FramebufferInfo *info;
+    SDL_Surface *surface, *scaledSurface;
+    int retval;
+    
+    if (srcref == NULL || destref == NULL || destref->textureID == 0
+        || destref->palette != NULL
+    ) {
+        return -1;
+    }
+    
+    info = (FramebufferInfo *)PL_Handle_GetData(srcref->framebufferID, DXHANDLE_FRAMEBUFFER);
+    if (info == NULL) {
+        return -1;
+    }
+    
+    if (PL_GL.glBlitFramebufferEXT != NULL) {
+        GLuint destFramebuffer;
+        GLenum status;
+        
+        PL_GL.glGenFramebuffersEXT(1, &destFramebuffer);
+        PL_GL.glBindFramebufferEXT(GL_DRAW_FRAMEBUFFER_EXT, destFramebuffer);
+        PL_GL.glFramebufferTexture2DEXT(GL_DRAW_FRAMEBUFFER_EXT,
+                                        GL_COLOR_ATTACHMENT0_EXT,
+                                        destref->glTarget,
+                                        destref->textureID,
+                                        0);
+        status = PL_GL.glCheckFramebufferStatusEXT(GL_DRAW_FRAMEBUFFER_EXT);
+        
+        if (status == GL_FRAMEBUFFER_COMPLETE_EXT) {
+            PL_GL.glBindFramebufferEXT(GL_READ_FRAMEBUFFER_EXT, info->framebufferID);
+            PL_GL.glFramebufferTexture2DEXT(GL_READ_FRAMEBUFFER_EXT,
+                                            GL_COLOR_ATTACHMENT0_EXT,
+                                            srcref->glTarget,
+                                            srcref->textureID,
+                                            0);
+            PL_GL.glBlitFramebufferEXT(srcRect->x, srcRect->y,
+                                       srcRect->x + srcRect->w, srcRect->y + srcRect->h,
+                                       destRect->x, destRect->y,
+                                       destRect->x + destRect->w, destRect->y + destRect->h,
+                                       GL_COLOR_BUFFER_BIT, GL_LINEAR);
+        }
+        
+        PL_GL.glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, 0);
+        PL_GL.glDeleteFramebuffersEXT(1, &destFramebuffer);
+        
+        if (status == GL_FRAMEBUFFER_COMPLETE_EXT) {
+            return 0;
+        }
+    }
+    
+    /* Read it back, scale it, and upload it again. */
+    if (s_GLFrameBuffer_Bind(srcref->framebufferID, srcref->glTarget, srcref->textureID) < 0) {
+        return -1;
+    }
+    retval = PL_Framebuffer_GetSurface(srcRect, &surface);
+    s_GLFrameBuffer_Bind(-1, 0, 0);
+    if (retval < 0) {
+        return -1;
+    }
+    
+    scaledSurface = SDL_CreateRGBSurface(SDL_SWSURFACE, destRect->w, destRect->h, 32,
+                                         0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000);
+    if (scaledSurface == NULL) {
+        SDL_FreeSurface(surface);
+        return -1;
+    }
+    
+    SDL_SetSurfaceBlendMode(surface, SDL_BLENDMODE_NONE);
+    retval = SDL_BlitScaled(surface, NULL, scaledSurface, NULL);
+    SDL_FreeSurface(surface);
+    
+    if (retval >= 0) {
+        retval = s_ConvertAndBlitSurface(destref, scaledSurface, destRect);
+    }
+    SDL_FreeSurface(scaledSurface);
+    
+    return (retval < 0) ? -1 : 0;
+}
+
 int PL_Texture_HasAlphaChannel(int textureRefID) {
     TextureRef *textureref = (TextureRef*)PL_Handle_GetData(textureRefID, DXHANDLE_TEXTURE);
     if (textureref == NULL) {
@@ -293,6 +490,540 @@ int PL_Texture_HasAlphaChannel(int textureRefID) {
     return textureref->hasAlphaChannel;
 }
 
+/* GL formats for the SDL formats textures can be created in.
+ * The 16-bit ones come from graphs loaded at a 16-bit colour depth. */
+static int s_GetGLFormat(Uint32 sdlFormat, GLint *internalFormat,
+                         GLenum *format, GLenum *type) {
+    switch (sdlFormat) {
+        case SDL_PIXELFORMAT_ARGB8888:
+            *internalFormat = GL_RGBA8;
+            *format = GL_BGRA;
+            *type = GL_UNSIGNED_INT_8_8_8_8_REV;
+            return 0;
+        case SDL_PIXELFORMAT_RGB565:
+            *internalFormat = GL_RGB5;
+            *format = GL_RGB;
+            *type = GL_UNSIGNED_SHORT_5_6_5;
+            return 0;
+        case SDL_PIXELFORMAT_RGBA4444:
+            *internalFormat = GL_RGBA4;
+            *format = GL_RGBA;
+            *type = GL_UNSIGNED_SHORT_4_4_4_4;
+            return 0;
+        case SDL_PIXELFORMAT_RGBA5551:
+            *internalFormat = GL_RGB5_A1;
+            *format = GL_RGBA;
+            *type = GL_UNSIGNED_SHORT_5_5_5_1;
+            return 0;
+        case SDL_PIXELFORMAT_INDEX8:
+            *internalFormat = GL_LUMINANCE8;
+            *format = GL_LUMINANCE;
+            *type = GL_UNSIGNED_BYTE;
+            return 0;
+        default:
+            return -1;
+    }
+}
+
+/* Surfaces already in one of the formats above are kept as they are,
+ * anything else is converted to ARGB8888. Index textures need a palette
+ * to go with them, so those are left to s_CreatePaletteTexture. */
+static Uint32 s_GetTextureFormat(SDL_Surface *surface) {
+    GLint internalFormat;
+    GLenum format, type;
+    
+    if (surface->format->format == SDL_PIXELFORMAT_INDEX8
+        || s_GetGLFormat(surface->format->format, &internalFormat, &format, &type) < 0
+    ) {
+        return SDL_PIXELFORMAT_ARGB8888;
+    }
+    
+    return surface->format->format;
+}
+
+static int s_CreateTexture(int width, int height, int hasAlphaChannel, Uint32 sdlFormat);
+
+/* ------------------------------------------------------- Tiled textures */
+
+/* DxPortLib extension: tiled textures.
+ *
+ * Images that are too big for the GPU (or bigger than the tiled graph
+ * threshold) are kept in memory, and split into tiles that are only
+ * uploaded once something draws them. Once too many are resident, the
+ * least recently drawn tile is dropped again.
+ *
+ * A tiled texture works in texel coordinates, and the drawing code
+ * splits each quad along tile edges with PL_Texture_GetTile. Each tile
+ * texture also has a one pixel border taken from its neighbours, so
+ * bilinear filtering doesn't show seams.
+ */
+#define TILE_TEXTURE_SIZE 256
+#define TILE_SIZE (TILE_TEXTURE_SIZE - 2)
+
+typedef struct TiledTexture {
+    SDL_Surface *surface;
+    
+    int tilesX;
+    int tilesY;
+    int *tileIDs;
+    unsigned int *tileLastUse;
+    
+    int residentCount;
+    int residentMax;
+} TiledTexture;
+
+static int s_tiledThreshold = 0;
+static unsigned int s_tileUseCounter = 0;
+
+static void s_FreeTiledTexture(TiledTexture *tiled) {
+    int i;
+    
+    if (tiled->tileIDs != NULL) {
+        for (i = 0; i < tiled->tilesX * tiled->tilesY; ++i) {
+            if (tiled->tileIDs[i] >= 0) {
+                PL_Texture_Release(tiled->tileIDs[i]);
+            }
+        }
+    }
+    
+    if (tiled->surface != NULL) {
+        SDL_FreeSurface(tiled->surface);
+    }
+    DXFREE(tiled->tileIDs);
+    DXFREE(tiled->tileLastUse);
+    DXFREE(tiled);
+}
+
+static int s_NeedsTiles(int width, int height) {
+    int maxWidth = PL_GL.maxTextureWidth;
+    int maxHeight = PL_GL.maxTextureHeight;
+    
+    if (PL_GL.hasTextureRectangleSupport == DXFALSE) {
+        width = s_topow2(width);
+        height = s_topow2(height);
+    }
+    
+    if (s_tiledThreshold > 0) {
+        maxWidth = SDL_min(maxWidth, s_tiledThreshold);
+        maxHeight = SDL_min(maxHeight, s_tiledThreshold);
+    }
+    
+    return width > maxWidth || height > maxHeight;
+}
+
+static int s_CreateTiledTexture(SDL_Surface *surface, int hasAlphaChannel) {
+    TiledTexture *tiled;
+    TextureRef *textureref;
+    int textureRefID;
+    int tileCount;
+    int i;
+    
+    tiled = (TiledTexture *)DXALLOC(sizeof(TiledTexture));
+    if (tiled == NULL) {
+        return -1;
+    }
+    
+    tiled->tilesX = (surface->w + TILE_SIZE - 1) / TILE_SIZE;
+    tiled->tilesY = (surface->h + TILE_SIZE - 1) / TILE_SIZE;
+    tileCount = tiled->tilesX * tiled->tilesY;
+    
+    tiled->surface = SDL_ConvertSurfaceFormat(surface, s_GetTextureFormat(surface), 0);
+    tiled->tileIDs = (int *)DXALLOC(sizeof(int) * tileCount);
+    tiled->tileLastUse = (unsigned int *)DXALLOC(sizeof(unsigned int) * tileCount);
+    if (tiled->tileIDs != NULL) {
+        for (i = 0; i < tileCount; ++i) {
+            tiled->tileIDs[i] = -1;
+        }
+    }
+    if (tiled->surface == NULL || tiled->tileIDs == NULL || tiled->tileLastUse == NULL) {
+        s_FreeTiledTexture(tiled);
+        return -1;
+    }
+    
+    /* Enough to cover the screen with a tile to spare either way. */
+    tiled->residentCount = 0;
+    tiled->residentMax = ((SDL_max(PL_drawScreenWidth, 640) / TILE_SIZE) + 2)
+                         * ((SDL_max(PL_drawScreenHeight, 480) / TILE_SIZE) + 2);
+    
+    textureRefID = s_AllocateTextureRefID(0);
+    if (textureRefID < 0) {
+        s_FreeTiledTexture(tiled);
+        return -1;
+    }
+    
+    textureref = (TextureRef*)PL_Handle_GetData(textureRefID, DXHANDLE_TEXTURE);
+    
+    textureref->glInternalFormat = 0;
+    textureref->glTarget = 0;
+    textureref->glFormat = 0;
+    textureref->glType = 0;
+    textureref->sdlFormat = tiled->surface->format->format;
+    textureref->width = surface->w;
+    textureref->height = surface->h;
+    textureref->texWidth = surface->w;
+    textureref->texHeight = surface->h;
+    textureref->widthMult = 1.0f;
+    textureref->heightMult = 1.0f;
+    textureref->drawMode = DX_DRAWMODE_NEAREST;
+    textureref->hasAlphaChannel = hasAlphaChannel;
+    textureref->tiled = tiled;
+    
+    return textureRefID;
+}
+
+/* The area of the image held by a tile's texture, border included. */
+static void s_GetTileRect(const TiledTexture *tiled, int tileX, int tileY, SDL_Rect *rect) {
+    int x1 = (tileX * TILE_SIZE) - 1;
+    int y1 = (tileY * TILE_SIZE) - 1;
+    int x2 = x1 + TILE_SIZE + 2;
+    int y2 = y1 + TILE_SIZE + 2;
+    
+    if (x1 < 0) { x1 = 0; }
+    if (y1 < 0) { y1 = 0; }
+    if (x2 > tiled->surface->w) { x2 = tiled->surface->w; }
+    if (y2 > tiled->surface->h) { y2 = tiled->surface->h; }
+    
+    rect->x = x1;
+    rect->y = y1;
+    rect->w = x2 - x1;
+    rect->h = y2 - y1;
+}
+
+static int s_UploadTile(const TiledTexture *tiled, const SDL_Rect *rect, int hasAlphaChannel) {
+    SDL_Surface *surface = tiled->surface;
+    SDL_PixelFormat *format = surface->format;
+    SDL_Surface *tileSurface;
+    int textureRefID;
+    
+    textureRefID = s_CreateTexture(rect->w, rect->h, hasAlphaChannel, format->format);
+    if (textureRefID < 0) {
+        return -1;
+    }
+    
+    /* A view into the big surface, so nothing gets copied twice. */
+    tileSurface = SDL_CreateRGBSurfaceFrom(
+        (Uint8 *)surface->pixels + (rect->y * surface->pitch)
+            + (rect->x * format->BytesPerPixel),
+        rect->w, rect->h, format->BitsPerPixel, surface->pitch,
+        format->Rmask, format->Gmask, format->Bmask, format->Amask);
+    if (tileSurface == NULL) {
+        PL_Texture_Release(textureRefID);
+        return -1;
+    }
+    
+    PL_Texture_BlitSurface(textureRefID, tileSurface, NULL);
+    SDL_FreeSurface(tileSurface);
+    
+    PL_Texture_AddRef(textureRefID);
+    
+    return textureRefID;
+}
+
+static void s_EvictTile(TiledTexture *tiled) {
+    int tileCount = tiled->tilesX * tiled->tilesY;
+    int oldest = -1;
+    int i;
+    
+    for (i = 0; i < tileCount; ++i) {
+        if (tiled->tileIDs[i] >= 0
+            && (oldest < 0 || tiled->tileLastUse[i] < tiled->tileLastUse[oldest])
+        ) {
+            oldest = i;
+        }
+    }
+    
+    if (oldest >= 0) {
+        /* The tile may still be waiting to be drawn. */
+        PL_Draw_FlushCache();
+        
+        PL_Texture_Release(tiled->tileIDs[oldest]);
+        tiled->tileIDs[oldest] = -1;
+        tiled->residentCount -= 1;
+    }
+}
+
+int PL_Texture_IsTiled(int textureRefID) {
+    TextureRef *textureref = (TextureRef*)PL_Handle_GetData(textureRefID, DXHANDLE_TEXTURE);
+    return textureref != NULL && textureref->tiled != NULL;
+}
+
+/* Returns the texture for tile (tileX,tileY) of a tiled texture,
+ * uploading it if needed. rect is set to the area of the image it
+ * holds, and xMult/yMult to its texture coordinate multipliers. */
+int PL_Texture_GetTile(int textureRefID, int tileX, int tileY,
+                       SDL_Rect *rect, float *xMult, float *yMult) {
+    TextureRef *textureref = (TextureRef*)PL_Handle_GetData(textureRefID, DXHANDLE_TEXTURE);
+    TiledTexture *tiled;
+    SDL_Rect texRect;
+    int n;
+    
+    if (textureref == NULL || (tiled = textureref->tiled) == NULL
+        || tileX < 0 || tileX >= tiled->tilesX
+        || tileY < 0 || tileY >= tiled->tilesY
+    ) {
+        return -1;
+    }
+    
+    n = (tileY * tiled->tilesX) + tileX;
+    
+    s_GetTileRect(tiled, tileX, tileY, rect);
+    
+    if (tiled->tileIDs[n] < 0) {
+        if (tiled->residentCount >= tiled->residentMax) {
+            s_EvictTile(tiled);
+        }
+        
+        tiled->tileIDs[n] = s_UploadTile(tiled, rect, textureref->hasAlphaChannel);
+        if (tiled->tileIDs[n] < 0) {
+            return -1;
+        }
+        tiled->residentCount += 1;
+    }
+    
+    s_tileUseCounter += 1;
+    tiled->tileLastUse[n] = s_tileUseCounter;
+    
+    PL_Texture_RenderGetTextureInfo(tiled->tileIDs[n], &texRect, xMult, yMult);
+    
+    return tiled->tileIDs[n];
+}
+
+int PL_Texture_GetTileSize() {
+    return TILE_SIZE;
+}
+
+int PL_EXT_Texture_SetTiledGraphThreshold(int size) {
+    s_tiledThreshold = (size > 0) ? size : 0;
+    return 0;
+}
+
+/* ----------------------------------------------------- Palette textures */
+
+/* DxPortLib extension: palette textures.
+ *
+ * 8-bit images are kept on the GPU as they are, one byte per pixel,
+ * with their palette in a separate 256x1 texture. A small fragment
+ * shader looks each pixel up in the palette as it is drawn, so changing
+ * the palette (SetGraphPalette) only means uploading 1KB again.
+ *
+ * The shader takes the place of the texture environment, so these
+ * always draw as GL_MODULATE, which only differs for DX_BLENDMODE_INVSRC.
+ */
+typedef struct TexturePalette {
+    GLuint textureID;
+    int isDirty;
+    
+    Uint32 colors[256];
+    Uint32 originalColors[256];
+} TexturePalette;
+
+static GLuint s_paletteProgram = 0;
+static int s_paletteProgramFailed = DXFALSE;
+
+static const GLchar *s_paletteShaderSource =
+    "uniform INDEX_SAMPLER indexTexture;\n"
+    "uniform sampler2D paletteTexture;\n"
+    "void main() {\n"
+    "    float index = INDEX_LOOKUP(indexTexture, gl_TexCoord[0].st).r;\n"
+    "    vec2 entry = vec2(index * (255.0 / 256.0) + (0.5 / 256.0), 0.5);\n"
+    "    gl_FragColor = texture2D(paletteTexture, entry) * gl_Color;\n"
+    "}\n";
+
+static int s_CreatePaletteProgram() {
+    const GLchar *sources[2];
+    GLuint shader;
+    GLuint program;
+    GLint status;
+    
+    if (s_paletteProgram != 0) {
+        return 0;
+    }
+    if (PL_GL.hasShaderSupport == DXFALSE || s_paletteProgramFailed == DXTRUE) {
+        return -1;
+    }
+    
+    /* The index texture is whatever kind the rest of our textures are. */
+    if (PL_GL.hasTextureRectangleSupport) {
+        sources[0] = "#extension GL_ARB_texture_rectangle : enable\n"
+                     "#define INDEX_SAMPLER sampler2DRect\n"
+                     "#define INDEX_LOOKUP texture2DRect\n";
+    } else {
+        sources[0] = "#define INDEX_SAMPLER sampler2D\n"
+                     "#define INDEX_LOOKUP texture2D\n";
+    }
+    sources[1] = s_paletteShaderSource;
+    
+    /* If this doesn't work, don't try again on every load. */
+    s_paletteProgramFailed = DXTRUE;
+    
+    shader = PL_GL.glCreateShader(GL_FRAGMENT_SHADER);
+    PL_GL.glShaderSource(shader, 2, sources, NULL);
+    PL_GL.glCompileShader(shader);
+    PL_GL.glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+    if (status == GL_FALSE) {
+        PL_GL.glDeleteShader(shader);
+        return -1;
+    }
+    
+    /* No vertex shader, the fixed function pipeline handles that. */
+    program = PL_GL.glCreateProgram();
+    PL_GL.glAttachShader(program, shader);
+    PL_GL.glLinkProgram(program);
+    PL_GL.glDeleteShader(shader);
+    PL_GL.glGetProgramiv(program, GL_LINK_STATUS, &status);
+    if (status == GL_FALSE) {
+        PL_GL.glDeleteProgram(program);
+        return -1;
+    }
+    
+    PL_GL.glUseProgram(program);
+    PL_GL.glUniform1i(PL_GL.glGetUniformLocation(program, "indexTexture"), 0);
+    PL_GL.glUniform1i(PL_GL.glGetUniformLocation(program, "paletteTexture"), 1);
+    PL_GL.glUseProgram(0);
+    
+    s_paletteProgram = program;
+    s_paletteProgramFailed = DXFALSE;
+    
+    return 0;
+}
+
+static void s_FreePalette(TexturePalette *palette) {
+    if (palette->textureID != 0) {
+        PL_GL.glDeleteTextures(1, &palette->textureID);
+    }
+    DXFREE(palette);
+}
+
+static void s_BindPalette(TexturePalette *palette) {
+    PL_GL.glActiveTexture(GL_TEXTURE1);
+    PL_GL.glBindTexture(GL_TEXTURE_2D, palette->textureID);
+    if (palette->isDirty) {
+        PL_GL.glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 256, 1,
+                              GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV,
+                              palette->colors);
+        palette->isDirty = DXFALSE;
+    }
+    PL_GL.glActiveTexture(GL_TEXTURE0);
+    
+    PL_GL.glUseProgram(s_paletteProgram);
+}
+
+static int s_CreatePaletteTexture(SDL_Surface *surface, int hasAlphaChannel) {
+    SDL_Palette *sdlPalette = surface->format->palette;
+    TexturePalette *palette;
+    TextureRef *textureref;
+    Uint32 colorKey;
+    int hasColorKey;
+    int textureRefID;
+    int i;
+    
+    palette = (TexturePalette *)DXALLOC(sizeof(TexturePalette));
+    if (palette == NULL) {
+        return -1;
+    }
+    
+    hasColorKey = (SDL_GetColorKey(surface, &colorKey) >= 0);
+    
+    for (i = 0; i < 256; ++i) {
+        Uint32 color = 0;
+        if (sdlPalette != NULL && i < sdlPalette->ncolors) {
+            SDL_Color c = sdlPalette->colors[i];
+            color = ((Uint32)c.a << 24) | ((Uint32)c.r << 16)
+                    | ((Uint32)c.g << 8) | (Uint32)c.b;
+            if (hasColorKey && (Uint32)i == colorKey) {
+                color &= 0x00ffffff;
+            }
+        }
+        palette->colors[i] = color;
+        palette->originalColors[i] = color;
+    }
+    palette->isDirty = DXFALSE;
+    
+    PL_GL.glGenTextures(1, &palette->textureID);
+    PL_GL.glBindTexture(GL_TEXTURE_2D, palette->textureID);
+    PL_GL.glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    PL_GL.glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    PL_GL.glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    PL_GL.glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    PL_GL.glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 256, 1, 0,
+                       GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, palette->colors);
+    if (PL_GL.glGetError() != GL_NO_ERROR) {
+        s_FreePalette(palette);
+        return -1;
+    }
+    
+    textureRefID = s_CreateTexture(surface->w, surface->h, hasAlphaChannel,
+                                   SDL_PIXELFORMAT_INDEX8);
+    if (textureRefID < 0) {
+        s_FreePalette(palette);
+        return -1;
+    }
+    
+    textureref = (TextureRef*)PL_Handle_GetData(textureRefID, DXHANDLE_TEXTURE);
+    textureref->palette = palette;
+    
+    PL_Texture_BlitSurface(textureRefID, surface, NULL);
+    
+    return textureRefID;
+}
+
+static TexturePalette *s_GetPalette(int textureRefID) {
+    TextureRef *textureref = (TextureRef*)PL_Handle_GetData(textureRefID, DXHANDLE_TEXTURE);
+    if (textureref == NULL) {
+        return NULL;
+    }
+    return textureref->palette;
+}
+
+int PL_Texture_HasPaletteSupport() {
+    return s_CreatePaletteProgram() == 0;
+}
+
+/* Sets the RGB of one palette entry, keeping its alpha. */
+int PL_Texture_SetPaletteColor(int textureRefID, int index, Uint32 color) {
+    TexturePalette *palette = s_GetPalette(textureRefID);
+    if (palette == NULL || index < 0 || index >= 256) {
+        return -1;
+    }
+    
+    /* Anything already queued up is still drawn with the old colour. */
+    PL_Draw_FlushCache();
+    
+    palette->colors[index] = (palette->colors[index] & 0xff000000) | (color & 0x00ffffff);
+    palette->isDirty = DXTRUE;
+    
+    return 0;
+}
+
+int PL_Texture_GetPaletteColor(int textureRefID, int index, int originalFlag, Uint32 *color) {
+    TexturePalette *palette = s_GetPalette(textureRefID);
+    if (palette == NULL || index < 0 || index >= 256) {
+        return -1;
+    }
+    
+    if (originalFlag) {
+        *color = palette->originalColors[index];
+    } else {
+        *color = palette->colors[index];
+    }
+    
+    return 0;
+}
+
+int PL_Texture_ResetPalette(int textureRefID) {
+    TexturePalette *palette = s_GetPalette(textureRefID);
+    if (palette == NULL) {
+        return -1;
+    }
+    
+    PL_Draw_FlushCache();
+    
+    SDL_memcpy(palette->colors, palette->originalColors, sizeof(palette->colors));
+    palette->isDirty = DXTRUE;
+    
+    return 0;
+}
+
 int PL_Texture_CreateFromSurface(SDL_Surface *surface, int hasAlphaChannel) {
     int textureRefID;
     
@@ -300,7 +1031,18 @@ int PL_Texture_CreateFromSurface(SDL_Surface *surface, int hasAlphaChannel) {
         hasAlphaChannel = DXTRUE;
     }
     
-    textureRefID = PL_Texture_CreateFromDimensions(surface->w, surface->h, hasAlphaChannel);
+    if (s_NeedsTiles(surface->w, surface->h)) {
+        return s_CreateTiledTexture(surface, hasAlphaChannel);
+    }
+    
+    if (surface->format->format == SDL_PIXELFORMAT_INDEX8
+        && PL_Texture_HasPaletteSupport()
+    ) {
+        return s_CreatePaletteTexture(surface, hasAlphaChannel);
+    }
+    
+    textureRefID = s_CreateTexture(surface->w, surface->h, hasAlphaChannel,
+                                   s_GetTextureFormat(surface));
     if (textureRefID < 0) {
         return -1;
     }
@@ -310,9 +1052,11 @@ int PL_Texture_CreateFromSurface(SDL_Surface *surface, int hasAlphaChannel) {
     return textureRefID;
 }
 
-int PL_Texture_CreateFromDimensions(int width, int height, int hasAlphaChannel) {
-    int textureRefID;
-    TextureRef *textureref;
+/* Makes the GL texture, and fills out a TextureRef for it that isn't in
+ * the handle table yet. This only needs a current context, so it is also
+ * what the loader context uses. */
+static int s_GenTexture(TextureRef *textureref, int width, int height,
+                        int hasAlphaChannel, Uint32 sdlFormat) {
     GLint textureInternalFormat = 0;
     GLenum textureFormat = 0;
     GLenum textureType = 0;
@@ -335,9 +1079,9 @@ int PL_Texture_CreateFromDimensions(int width, int height, int hasAlphaChannel)
         return -1;
     }
     
-    textureInternalFormat = GL_RGBA8;
-    textureFormat = GL_BGRA;
-    textureType = GL_UNSIGNED_INT_8_8_8_8_REV;
+    if (s_GetGLFormat(sdlFormat, &textureInternalFormat, &textureFormat, &textureType) < 0) {
+        return -1;
+    }
     
     /* - Create the texture itself. */
     PL_GL.glGenTextures(1, &textureID);
@@ -363,30 +1107,26 @@ int PL_Texture_CreateFromDimensions(int width, int height, int hasAlphaChannel)
     
     PL_GL.glDisable(textureTarget);
     if (PL_GL.glGetError() != GL_NO_ERROR) {
-        return -1;
-    }
-
-    /* - Assign to texture reference. */
-    textureRefID = s_AllocateTextureRefID(textureID);
-    if (textureRefID < 0) {
         PL_GL.glDeleteTextures(1, &textureID);
         return -1;
     }
     
-    textureref = (TextureRef*)PL_Handle_GetData(textureRefID, DXHANDLE_TEXTURE);
-    
     textureref->textureID = textureID;
     textureref->glInternalFormat = textureInternalFormat;
     textureref->glTarget = textureTarget;
     textureref->glFormat = textureFormat;
     textureref->glType = textureType;
-    textureref->sdlFormat = SDL_PIXELFORMAT_ARGB8888;
+    textureref->sdlFormat = sdlFormat;
     textureref->width = width;
     textureref->height = height;
     textureref->texWidth = texWidth;
     textureref->texHeight = texHeight;
     textureref->drawMode = DX_DRAWMODE_NEAREST;
     textureref->hasAlphaChannel = hasAlphaChannel;
+    textureref->framebufferID = -1;
+    textureref->tiled = NULL;
+    textureref->palette = NULL;
+    textureref->refCount = 0;
     
     if (textureTarget == GL_TEXTURE_RECTANGLE_ARB) {
         textureref->widthMult = 1.0f;
@@ -396,9 +1136,33 @@ int PL_Texture_CreateFromDimensions(int width, int height, int hasAlphaChannel)
         textureref->heightMult = 1.0f / (float)texHeight;
     }
     
+    return 0;
+}
+
+static int s_CreateTexture(int width, int height, int hasAlphaChannel, Uint32 sdlFormat) {
+    int textureRefID;
+    TextureRef newTexture;
+    
+    if (s_GenTexture(&newTexture, width, height, hasAlphaChannel, sdlFormat) < 0) {
+        return -1;
+    }
+    
+    /* - Assign to texture reference. */
+    textureRefID = s_AllocateTextureRefID(newTexture.textureID);
+    if (textureRefID < 0) {
+        PL_GL.glDeleteTextures(1, &newTexture.textureID);
+        return -1;
+    }
+    
+    *(TextureRef*)PL_Handle_GetData(textureRefID, DXHANDLE_TEXTURE) = newTexture;
+    
     return textureRefID;
 }
 
+int PL_Texture_CreateFromDimensions(int width, int height, int hasAlphaChannel) {
+    return s_CreateTexture(width, height, hasAlphaChannel, SDL_PIXELFORMAT_ARGB8888);
+}
+
 int PL_Texture_CreateFramebuffer(int width, int height, int hasAlphaChannel) {
     int textureRefID = -1;
     int framebufferID = -1;
@@ -467,19 +1231,23 @@ int PL_Texture_Release(int textureRefID) {
         if (textureref->framebufferID >= 0) {
             s_GLFrameBuffer_Release(textureref->framebufferID);
         }
+        if (textureref->tiled != NULL) {
+            s_FreeTiledTexture(textureref->tiled);
+            textureref->tiled = NULL;
+        }
+        if (textureref->palette != NULL) {
+            s_FreePalette(textureref->palette);
+            textureref->palette = NULL;
+        }
         PL_Handle_ReleaseID(textureRefID, DXTRUE);
     }
     return 0;
 }
 
-int PL_Texture_BlitSurface(int textureRefID, SDL_Surface *surface, const SDL_Rect *rect) {
-    TextureRef *textureref = (TextureRef*)PL_Handle_GetData(textureRefID, DXHANDLE_TEXTURE);
+static int s_ConvertAndBlitSurface(TextureRef *textureref, SDL_Surface *surface,
+                                   const SDL_Rect *rect) {
     SDL_Rect tempRect;
     
-    if (textureref == NULL || textureref->textureID == 0) {
-        return -1;
-    }
-    
     if (rect == NULL) {
         tempRect.x = 0;
         tempRect.y = 0;
@@ -491,6 +1259,9 @@ int PL_Texture_BlitSurface(int textureRefID, SDL_Surface *surface, const SDL_Rec
     /* Convert to target format if different. */
     if (textureref->sdlFormat != surface->format->format) {
         SDL_Surface *tempSurface = SDL_ConvertSurfaceFormat(surface, textureref->sdlFormat, 0);
+        if (tempSurface == NULL) {
+            return -1;
+        }
         if (SDL_MUSTLOCK(tempSurface)) {
             SDL_LockSurface(tempSurface);
             s_blitSurface(textureref, tempSurface, rect);
@@ -512,6 +1283,105 @@ int PL_Texture_BlitSurface(int textureRefID, SDL_Surface *surface, const SDL_Rec
     return 0;
 }
 
+int PL_Texture_BlitSurface(int textureRefID, SDL_Surface *surface, const SDL_Rect *rect) {
+    TextureRef *textureref = (TextureRef*)PL_Handle_GetData(textureRefID, DXHANDLE_TEXTURE);
+    
+    if (textureref == NULL || textureref->textureID == 0) {
+        return -1;
+    }
+    
+    return s_ConvertAndBlitSurface(textureref, surface, rect);
+}
+
+/* ------------------------------------------------------ Loader textures */
+
+/* Textures made on the loader context (see OpenGL_Main.c) by ASyncLoad's
+ * upload thread. They are made and filled there like any other, but are
+ * held back from the handle table, which only the main thread may touch.
+ *
+ * The upload thread waits on a fence after the upload, so by the time the
+ * main thread sees one, the texture is complete and can be drawn from.
+ */
+struct PreparedTexture {
+    TextureRef textureref;
+};
+
+/* Don't wait forever on a GPU that has gone away. (1s) */
+#define PREPARED_FENCE_TIMEOUT 1000000000
+
+PreparedTexture *PL_Texture_PrepareFromSurface(SDL_Surface *surface, int hasAlphaChannel) {
+    PreparedTexture *prepared;
+    TextureRef textureref;
+    GLsync fence;
+    GLenum result;
+    
+    if (SDL_GetColorKey(surface, 0) >= 0) {
+        hasAlphaChannel = DXTRUE;
+    }
+    
+    /* Tiled and palette textures are left to PL_Texture_CreateFromSurface. */
+    if (s_NeedsTiles(surface->w, surface->h)
+        || (surface->format->format == SDL_PIXELFORMAT_INDEX8
+            && PL_Texture_HasPaletteSupport())
+    ) {
+        return NULL;
+    }
+    
+    if (s_GenTexture(&textureref, surface->w, surface->h, hasAlphaChannel,
+                     s_GetTextureFormat(surface)) < 0) {
+        return NULL;
+    }
+    
+    if (s_ConvertAndBlitSurface(&textureref, surface, NULL) < 0) {
+        PL_GL.glDeleteTextures(1, &textureref.textureID);
+        return NULL;
+    }
+    
+    fence = PL_GL.glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    if (fence == NULL) {
+        PL_GL.glFinish();
+    } else {
+        result = PL_GL.glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT,
+                                        PREPARED_FENCE_TIMEOUT);
+        PL_GL.glDeleteSync(fence);
+        
+        if (result == GL_TIMEOUT_EXPIRED || result == GL_WAIT_FAILED) {
+            PL_GL.glDeleteTextures(1, &textureref.textureID);
+            return NULL;
+        }
+    }
+    
+    prepared = DXALLOC(sizeof(PreparedTexture));
+    if (prepared == NULL) {
+        PL_GL.glDeleteTextures(1, &textureref.textureID);
+        return NULL;
+    }
+    prepared->textureref = textureref;
+    
+    return prepared;
+}
+
+/* Frees prepared either way. */
+int PL_Texture_CreateFromPrepared(PreparedTexture *prepared) {
+    int textureRefID;
+    
+    textureRefID = s_AllocateTextureRefID(prepared->textureref.textureID);
+    if (textureRefID < 0) {
+        PL_Texture_ReleasePrepared(prepared);
+        return -1;
+    }
+    
+    *(TextureRef*)PL_Handle_GetData(textureRefID, DXHANDLE_TEXTURE) = prepared->textureref;
+    DXFREE(prepared);
+    
+    return textureRefID;
+}
+
+void PL_Texture_ReleasePrepared(PreparedTexture *prepared) {
+    PL_GL.glDeleteTextures(1, &prepared->textureref.textureID);
+    DXFREE(prepared);
+}
+
 int PL_Texture_RenderGetTextureInfo(int textureRefID, SDL_Rect *rect, float *xMult, float *yMult) {
     TextureRef *textureref = (TextureRef*)PL_Handle_GetData(textureRefID, DXHANDLE_TEXTURE);
     
@@ -560,11 +1430,22 @@ int PL_Texture_ClearAllData() {
                 s_GLFrameBuffer_Release(textureref->framebufferID);
                 textureref->framebufferID = -1;
             }
+            
+            if (textureref->palette != NULL && textureref->palette->textureID > 0) {
+                PL_GL.glDeleteTextures(1, &textureref->palette->textureID);
+                textureref->palette->textureID = 0;
+            }
         }
         
         textureRefID = PL_Handle_GetNextID(textureRefID);
     }
     
+    if (s_paletteProgram != 0) {
+        PL_GL.glDeleteProgram(s_paletteProgram);
+        s_paletteProgram = 0;
+    }
+    s_paletteProgramFailed = DXFALSE;
+    
     return 0;
 }
 
@@ -0,0 +1,295 @@
+/*
+  DxPortLib - A portability library for DxLib-based software.
+  Copyright (C) 2013 Patrick McCarthy <mauve@sandwich.net>
+  
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+  
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+    
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required. 
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include "DxInternal.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#  include <xmmintrin.h>
+#  define PARTICLE_USE_SSE
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#  include <arm_neon.h>
+#  define PARTICLE_USE_NEON
+#endif
+
+/* DxPortLib extension: particle systems.
+ *
+ * Games tend to draw their particles with one DrawRotaGraph per
+ * particle, which is a lot of handle lookups and function calls for
+ * something that is basically the same quad over and over.
+ *
+ * Instead, each system keeps its particles as a structure of arrays,
+ * so the update can run four particles at a time, and the whole system
+ * is handed to the renderer in one go. Since a system only ever uses
+ * one graph, it all ends up in one run of the vertex cache.
+ */
+
+typedef struct ParticleSystem {
+    int graphID;
+    
+    int count;
+    int capacity;
+    
+    float gravityX;
+    float gravityY;
+    float scale;
+    
+    /* All arrays live in one allocation, pointed to by x. */
+    float *x;
+    float *y;
+    float *vx;
+    float *vy;
+    float *life;
+    Uint32 *color;
+} ParticleSystem;
+
+static ParticleSystem *s_GetParticleSystem(int particleID) {
+    return (ParticleSystem *)PL_Handle_GetData(particleID, DXHANDLE_PARTICLE);
+}
+
+/* Moves every particle forward by deltaTime. */
+static void s_UpdateKernel(ParticleSystem *ps, float deltaTime) {
+    float *x = ps->x;
+    float *y = ps->y;
+    float *vx = ps->vx;
+    float *vy = ps->vy;
+    float *life = ps->life;
+    float ax = ps->gravityX * deltaTime;
+    float ay = ps->gravityY * deltaTime;
+    int count = ps->count;
+    int i = 0;
+
+#if defined(PARTICLE_USE_SSE)
+    {
+        __m128 vdt = _mm_set1_ps(deltaTime);
+        __m128 vax = _mm_set1_ps(ax);
+        __m128 vay = _mm_set1_ps(ay);
+        
+        for (; i + 4 <= count; i += 4) {
+            __m128 nvx = _mm_add_ps(_mm_loadu_ps(vx + i), vax);
+            __m128 nvy = _mm_add_ps(_mm_loadu_ps(vy + i), vay);
+            _mm_storeu_ps(vx + i, nvx);
+            _mm_storeu_ps(vy + i, nvy);
+            _mm_storeu_ps(x + i, _mm_add_ps(_mm_loadu_ps(x + i), _mm_mul_ps(nvx, vdt)));
+            _mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(nvy, vdt)));
+            _mm_storeu_ps(life + i, _mm_sub_ps(_mm_loadu_ps(life + i), vdt));
+        }
+    }
+#elif defined(PARTICLE_USE_NEON)
+    {
+        float32x4_t vdt = vdupq_n_f32(deltaTime);
+        float32x4_t vax = vdupq_n_f32(ax);
+        float32x4_t vay = vdupq_n_f32(ay);
+        
+        for (; i + 4 <= count; i += 4) {
+            float32x4_t nvx = vaddq_f32(vld1q_f32(vx + i), vax);
+            float32x4_t nvy = vaddq_f32(vld1q_f32(vy + i), vay);
+            vst1q_f32(vx + i, nvx);
+            vst1q_f32(vy + i, nvy);
+            vst1q_f32(x + i, vmlaq_f32(vld1q_f32(x + i), nvx, vdt));
+            vst1q_f32(y + i, vmlaq_f32(vld1q_f32(y + i), nvy, vdt));
+            vst1q_f32(life + i, vsubq_f32(vld1q_f32(life + i), vdt));
+        }
+    }
+#endif
+    
+    /* Scalar version, also picks up whatever is left over. */
+    for (; i < count; ++i) {
+        vx[i] += ax;
+        vy[i] += ay;
+        x[i] += vx[i] * deltaTime;
+        y[i] += vy[i] * deltaTime;
+        life[i] -= deltaTime;
+    }
+}
+
+/* Removes dead particles, keeping the survivors in emission order so
+ * that alpha blended systems don't flicker as particles die. */
+static void s_Compact(ParticleSystem *ps) {
+    int count = ps->count;
+    int i, n;
+    
+    for (i = 0; i < count; ++i) {
+        if (ps->life[i] <= 0) {
+            break;
+        }
+    }
+    
+    for (n = i; i < count; ++i) {
+        if (ps->life[i] > 0) {
+            ps->x[n] = ps->x[i];
+            ps->y[n] = ps->y[i];
+            ps->vx[n] = ps->vx[i];
+            ps->vy[n] = ps->vy[i];
+            ps->life[n] = ps->life[i];
+            ps->color[n] = ps->color[i];
+            n += 1;
+        }
+    }
+    
+    ps->count = n;
+}
+
+int PLEXT_Particle_Create(int graphID, int maxParticles) {
+    int particleID;
+    ParticleSystem *ps;
+    size_t capacity;
+    
+    if (maxParticles <= 0) {
+        return -1;
+    }
+    
+    particleID = PL_Handle_AcquireID(DXHANDLE_PARTICLE);
+    if (particleID < 0) {
+        return -1;
+    }
+    
+    ps = (ParticleSystem *)PL_Handle_AllocateData(particleID, sizeof(ParticleSystem));
+    
+    /* Round up to a full SIMD vector so each array starts aligned. */
+    capacity = ((size_t)maxParticles + 3) & ~(size_t)3;
+    
+    ps->x = (float *)DXALLOC(capacity * (sizeof(float) * 5 + sizeof(Uint32)));
+    if (ps->x == NULL) {
+        PL_Handle_ReleaseID(particleID, DXTRUE);
+        return -1;
+    }
+    ps->y = ps->x + capacity;
+    ps->vx = ps->y + capacity;
+    ps->vy = ps->vx + capacity;
+    ps->life = ps->vy + capacity;
+    ps->color = (Uint32 *)(ps->life + capacity);
+    
+    ps->graphID = graphID;
+    ps->count = 0;
+    ps->capacity = maxParticles;
+    ps->gravityX = 0;
+    ps->gravityY = 0;
+    ps->scale = 1.0f;
+    
+    return particleID;
+}
+
+int PLEXT_Particle_Delete(int particleID) {
+    ParticleSystem *ps = s_GetParticleSystem(particleID);
+    if (ps == NULL) {
+        return -1;
+    }
+    
+    DXFREE(ps->x);
+    
+    PL_Handle_ReleaseID(particleID, DXTRUE);
+    
+    return 0;
+}
+
+int PLEXT_Particle_SetGravity(int particleID, float gravityX, float gravityY) {
+    ParticleSystem *ps = s_GetParticleSystem(particleID);
+    if (ps == NULL) {
+        return -1;
+    }
+    
+    ps->gravityX = gravityX;
+    ps->gravityY = gravityY;
+    
+    return 0;
+}
+
+int PLEXT_Particle_SetScale(int particleID, float scale) {
+    ParticleSystem *ps = s_GetParticleSystem(particleID);
+    if (ps == NULL) {
+        return -1;
+    }
+    
+    ps->scale = scale;
+    
+    return 0;
+}
+
+int PLEXT_Particle_Emit(int particleID, float x, float y, float vx, float vy,
+                        float lifetime, DXCOLOR color, int alpha) {
+    ParticleSystem *ps = s_GetParticleSystem(particleID);
+    int n;
+    
+    if (ps == NULL || ps->count >= ps->capacity || lifetime <= 0) {
+        return -1;
+    }
+    
+    if (alpha < 0) { alpha = 0; }
+    if (alpha > 255) { alpha = 255; }
+    
+    n = ps->count++;
+    ps->x[n] = x;
+    ps->y[n] = y;
+    ps->vx[n] = vx;
+    ps->vy[n] = vy;
+    ps->life[n] = lifetime;
+    ps->color[n] = ((Uint32)color & 0x00ffffff) | ((Uint32)alpha << 24);
+    
+    return 0;
+}
+
+int PLEXT_Particle_Update(int particleID, float deltaTime) {
+    ParticleSystem *ps = s_GetParticleSystem(particleID);
+    if (ps == NULL) {
+        return -1;
+    }
+    
+    if (ps->count > 0) {
+        s_UpdateKernel(ps, deltaTime);
+        s_Compact(ps);
+    }
+    
+    return 0;
+}
+
+int PLEXT_Particle_Draw(int particleID, int blendFlag) {
+    ParticleSystem *ps = s_GetParticleSystem(particleID);
+    if (ps == NULL) {
+        return -1;
+    }
+    
+    if (ps->count == 0) {
+        return 0;
+    }
+    
+    return PL_EXT_Draw_ParticleQuads(ps->graphID, blendFlag,
+                                     ps->x, ps->y, ps->color,
+                                     ps->count, ps->scale);
+}
+
+int PLEXT_Particle_GetNum(int particleID) {
+    ParticleSystem *ps = s_GetParticleSystem(particleID);
+    if (ps == NULL) {
+        return -1;
+    }
+    
+    return ps->count;
+}
+
+int PLEXT_Particle_InitParticleSystems() {
+    int particleID;
+    
+    while ((particleID = PL_Handle_GetFirstIDOf(DXHANDLE_PARTICLE)) >= 0) {
+        PLEXT_Particle_Delete(particleID);
+    }
+    
+    return 0;
+}
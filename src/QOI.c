@@ -0,0 +1,211 @@
+/*
+  DxPortLib - A portability library for DxLib-based software.
+  Copyright (C) 2013 Patrick McCarthy <mauve@sandwich.net>
+  
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+  
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+    
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required. 
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include "DxInternal.h"
+
+/* Built-in decoder for QOI, the "Quite OK Image" format.
+ *
+ * QOI is lossless like PNG, but has no inflate step, and decodes
+ * several times faster; for games that control their own assets,
+ * that's most of LoadGraph's time saved. Graph checks for it before
+ * handing a file to SDL2_image. tools/dxqoiconv makes these files.
+ *
+ * Pixels are written straight out as ARGB8888, which is what the
+ * texture code wants, so there's no conversion afterwards.
+ * The header's colorspace field is informational, and is ignored.
+ */
+
+#define QOI_HEADER_SIZE         14
+#define QOI_PADDING_SIZE        8
+
+/* The same limit the reference decoder has. */
+#define QOI_PIXELS_MAX          400000000
+
+#define QOI_OP_INDEX            0x00
+#define QOI_OP_DIFF             0x40
+#define QOI_OP_LUMA             0x80
+#define QOI_OP_RUN              0xc0
+#define QOI_OP_RGB              0xfe
+#define QOI_OP_RGBA             0xff
+#define QOI_MASK_2              0xc0
+
+static Uint32 s_Read32BE(const unsigned char *p) {
+    return ((Uint32)p[0] << 24) | ((Uint32)p[1] << 16)
+           | ((Uint32)p[2] << 8) | (Uint32)p[3];
+}
+
+int PL_QOI_IsQOI(const unsigned char *data, unsigned int size) {
+    return (size >= 4 && SDL_memcmp(data, "qoif", 4) == 0) ? DXTRUE : DXFALSE;
+}
+
+/* Returns NULL if this isn't a QOI file, or it's broken. */
+SDL_Surface *PL_QOI_Decode(const unsigned char *data, unsigned int size,
+                           int *dHasAlphaChannel) {
+    SDL_Surface *surface;
+    Uint32 index[64];
+    Uint32 width, height;
+    unsigned int p, chunksEnd;
+    unsigned int r = 0, g = 0, b = 0, a = 255;
+    Uint32 pixel = 0xff000000;
+    int run = 0;
+    int channels;
+    Uint32 x, y;
+    Uint8 *row;
+    
+    if (size < QOI_HEADER_SIZE + QOI_PADDING_SIZE
+        || PL_QOI_IsQOI(data, size) == DXFALSE
+    ) {
+        return NULL;
+    }
+    
+    width = s_Read32BE(data + 4);
+    height = s_Read32BE(data + 8);
+    channels = data[12];
+    
+    if (width == 0 || height == 0
+        || height > QOI_PIXELS_MAX / width
+        || (channels != 3 && channels != 4)
+    ) {
+        return NULL;
+    }
+    
+    surface = SDL_CreateRGBSurface(0, (int)width, (int)height, 32,
+                                   0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000);
+    if (surface == NULL) {
+        return NULL;
+    }
+    
+    SDL_memset(index, 0, sizeof(index));
+    
+    /* Every op starts before the padding, and the longest is 5 bytes,
+     * so none of them can read past the end. */
+    p = QOI_HEADER_SIZE;
+    chunksEnd = size - QOI_PADDING_SIZE;
+    
+    row = (Uint8 *)surface->pixels;
+    for (y = 0; y < height; ++y) {
+        Uint32 *dest = (Uint32 *)row;
+        
+        for (x = 0; x < width; ++x) {
+            if (run > 0) {
+                run -= 1;
+            } else if (p < chunksEnd) {
+                unsigned int op = data[p++];
+                
+                if (op == QOI_OP_RGB) {
+                    r = data[p];
+                    g = data[p + 1];
+                    b = data[p + 2];
+                    p += 3;
+                } else if (op == QOI_OP_RGBA) {
+                    r = data[p];
+                    g = data[p + 1];
+                    b = data[p + 2];
+                    a = data[p + 3];
+                    p += 4;
+                } else if ((op & QOI_MASK_2) == QOI_OP_INDEX) {
+                    pixel = index[op];
+                    a = pixel >> 24;
+                    r = (pixel >> 16) & 0xff;
+                    g = (pixel >> 8) & 0xff;
+                    b = pixel & 0xff;
+                } else if ((op & QOI_MASK_2) == QOI_OP_DIFF) {
+                    r = (r + ((op >> 4) & 0x03) - 2) & 0xff;
+                    g = (g + ((op >> 2) & 0x03) - 2) & 0xff;
+                    b = (b + (op & 0x03) - 2) & 0xff;
+                } else if ((op & QOI_MASK_2) == QOI_OP_LUMA) {
+                    unsigned int next = data[p++];
+                    int dg = (int)(op & 0x3f) - 32;
+                    
+                    r = (unsigned int)((int)r + dg - 8 + (int)((next >> 4) & 0x0f)) & 0xff;
+                    g = (unsigned int)((int)g + dg) & 0xff;
+                    b = (unsigned int)((int)b + dg - 8 + (int)(next & 0x0f)) & 0xff;
+                } else {
+                    /* QOI_OP_RUN; this pixel is the first of the run. */
+                    run = (int)(op & 0x3f);
+                }
+                
+                pixel = ((Uint32)a << 24) | ((Uint32)r << 16)
+                        | ((Uint32)g << 8) | (Uint32)b;
+                index[(r * 3 + g * 5 + b * 7 + a * 11) & 63] = pixel;
+            }
+            
+            /* A file that ends early repeats its last pixel, like the
+             * reference decoder does. */
+            dest[x] = pixel;
+        }
+        
+        row += surface->pitch;
+    }
+    
+    *dHasAlphaChannel = (channels == 4) ? DXTRUE : DXFALSE;
+    
+    return surface;
+}
+
+/* Like SDL2_image's IMG_isPNG and friends, this leaves file where it was. */
+int PL_QOI_IsQOI_RW(SDL_RWops *file) {
+    unsigned char magic[4];
+    Sint64 start = SDL_RWtell(file);
+    int isQOI = DXFALSE;
+    
+    if (start < 0) {
+        return DXFALSE;
+    }
+    
+    if (SDL_RWread(file, magic, 4, 1) == 1) {
+        isQOI = PL_QOI_IsQOI(magic, 4);
+    }
+    
+    SDL_RWseek(file, start, RW_SEEK_SET);
+    
+    return isQOI;
+}
+
+/* QOI has to be read into memory whole anyway, so this does that. */
+SDL_Surface *PL_QOI_Load_RW(SDL_RWops *file, int freeSrc, int *dHasAlphaChannel) {
+    SDL_Surface *surface = NULL;
+    unsigned char *data;
+    Sint64 start, end;
+    unsigned int size;
+    
+    start = SDL_RWtell(file);
+    end = SDL_RWseek(file, 0, RW_SEEK_END);
+    
+    if (start >= 0 && end > start && end - start < 0x7fffffff
+        && SDL_RWseek(file, start, RW_SEEK_SET) == start
+    ) {
+        size = (unsigned int)(end - start);
+        data = DXALLOC(size);
+        if (data != NULL) {
+            if (SDL_RWread(file, data, size, 1) == 1) {
+                surface = PL_QOI_Decode(data, size, dHasAlphaChannel);
+            }
+            DXFREE(data);
+        }
+    }
+    
+    if (freeSrc) {
+        SDL_RWclose(file);
+    }
+    
+    return surface;
+}
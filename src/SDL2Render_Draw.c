@@ -131,6 +131,106 @@ int PL_Draw_ModiGraph(
 ) {
     return -1;
 }
+int PL_EXT_Draw_ParticleQuads(int graphID, int blendFlag,
+                              const float *xArray, const float *yArray,
+                              const Uint32 *colorArray,
+                              int count, float scale) {
+    return -1;
+}
+int PL_Draw_GetDrawScreenGraph(int x1, int y1, int x2, int y2, int destGraphID) {
+    return -1;
+}
+int PL_Draw_BltDrawValidGraph(int srcGraphID, int x1, int y1, int x2, int y2,
+                              int destX, int destY, int destGraphID) {
+    return -1;
+}
+int PL_Draw_GetScreenSurface(int x1, int y1, int x2, int y2, SDL_Surface **dSurface) {
+    return -1;
+}
+DXCOLOR PL_Draw_GetPixel(int x, int y) {
+    return 0xffffffff;
+}
+int PL_Draw_GetPixelRegion(int x1, int y1, int x2, int y2, DXCOLOR *colors) {
+    return -1;
+}
+int PL_EXT_Draw_RequestPixelRegion(int x1, int y1, int x2, int y2) {
+    return -1;
+}
+int PL_EXT_Draw_SetUseCPUClipFlag(int flag) {
+    return -1;
+}
+int PL_EXT_Draw_GetCulledCount(int resetFlag) {
+    return -1;
+}
+int PL_EXT_Draw_PushTransform() {
+    return -1;
+}
+int PL_EXT_Draw_PopTransform() {
+    return -1;
+}
+int PL_EXT_Draw_SetTransform(float a, float b, float c, float d, float tx, float ty) {
+    return -1;
+}
+int PL_EXT_Draw_ResetTransform() {
+    return -1;
+}
+int PL_EXT_Draw_TranslateTransform(float x, float y) {
+    return -1;
+}
+int PL_EXT_Draw_ScaleTransform(float xScale, float yScale) {
+    return -1;
+}
+int PL_EXT_Draw_RotateTransform(float angle) {
+    return -1;
+}
+int PL_EXT_Draw_SetUseOpaqueLayerFlag(int flag) {
+    return -1;
+}
+int PL_EXT_Draw_SetDynamicResolutionFlag(int flag) {
+    return -1;
+}
+int PL_EXT_Draw_SetDynamicResolutionRange(float minScale, float maxScale,
+                                          float targetMilliseconds) {
+    return -1;
+}
+float PL_EXT_Draw_GetDynamicResolutionScale() {
+    return 1.0f;
+}
+int PL_EXT_Draw_SetMaxFramesInFlight(int count) {
+    return -1;
+}
+float PL_EXT_Draw_GetPresentLatency() {
+    return 0;
+}
+int PL_EXT_Draw_SetLoaderContextFlag(int flag) {
+    return -1;
+}
+int PL_Draw_HasLoaderContext() {
+    return DXFALSE;
+}
+int PL_Draw_BindLoaderContext() {
+    return -1;
+}
+void PL_Draw_UnbindLoaderContext() {
+}
+int PL_Draw_Primitive2D(const VERTEX2D *vertices, int vertexNum,
+                        const unsigned short *indices, int indexNum,
+                        int primitiveType, int graphID, int blendFlag) {
+    return -1;
+}
+int PL_Draw_OvalAAF(float x, float y, float rx, float ry, int posnum,
+                    DXCOLOR color, int fillFlag, float lineThickness) {
+    return -1;
+}
+int PL_Draw_LineAAF(float x1, float y1, float x2, float y2,
+                    DXCOLOR color, float thickness) {
+    return -1;
+}
+int PL_Draw_RoundRectAAF(float x1, float y1, float x2, float y2,
+                         float rx, float ry, int posnum,
+                         DXCOLOR color, int fillFlag, float lineThickness) {
+    return -1;
+}
 
 /* Supported functions from here on out. */
 
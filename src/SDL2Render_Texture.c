@@ -150,4 +150,30 @@ int PL_Texture_RenderGetGraphTexture(int graphID, SDL_Texture **texture, SDL_Rec
     return 0;
 }
 
+int PL_EXT_Texture_SetTiledGraphThreshold(int size) {
+    return -1;
+}
+
+int PL_Texture_HasPaletteSupport() {
+    return DXFALSE;
+}
+int PL_Texture_SetPaletteColor(int textureRefID, int index, Uint32 color) {
+    return -1;
+}
+int PL_Texture_GetPaletteColor(int textureRefID, int index, int originalFlag, Uint32 *color) {
+    return -1;
+}
+int PL_Texture_ResetPalette(int textureRefID) {
+    return -1;
+}
+
+PreparedTexture *PL_Texture_PrepareFromSurface(SDL_Surface *surface, int hasAlphaChannel) {
+    return NULL;
+}
+int PL_Texture_CreateFromPrepared(PreparedTexture *prepared) {
+    return -1;
+}
+void PL_Texture_ReleasePrepared(PreparedTexture *prepared) {
+}
+
 #endif /* #ifdef DXPORTLIB_DRAW_SDL2_RENDER */
@@ -39,17 +39,19 @@ int PL_SaveDrawScreenToPNG(int x1, int y1, int x2, int y2,
                            int compressionLevel) {
     SDL_Surface *surface;
     char namebuf[4096];
-    SDL_Rect rect;
-    rect.x = x1;
-    rect.y = y1;
-    rect.w = x2 - x1;
-    rect.h = y2 - y1;
+    int retval;
     
-    if (PL_Framebuffer_GetSurface(&rect, &surface) < 0) {
+    /* This scales for dynamic resolution, so the image is always
+     * the size that was asked for. */
+    if (PL_Draw_GetScreenSurface(x1, y1, x2, y2, &surface) < 0) {
         return -1;
     }
     
     PL_Text_DxStringToString(filename, namebuf, 4096, DX_CHARSET_EXT_UTF8);
     
-    return IMG_SavePNG(surface, namebuf);
+    retval = IMG_SavePNG(surface, namebuf);
+    
+    SDL_FreeSurface(surface);
+    
+    return retval;
 }
@@ -0,0 +1,547 @@
+/*
+  DxPortLib - A portability library for DxLib-based software.
+  Copyright (C) 2013 Patrick McCarthy <mauve@sandwich.net>
+  
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+  
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+    
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required. 
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include "DxInternal.h"
+
+#ifndef DX_NON_SOFTIMAGE
+
+#include "SDL_image.h"
+
+/* Soft images: images kept in memory, for the CPU to work on.
+ *
+ * Pixels are always ARGB8888, the same layout textures are made from,
+ * so making a graph from one hands the pixels straight to the renderer.
+ * Images made without an alpha channel keep every alpha at 255.
+ *
+ * Fills, blits, blends and format conversions are done a row at a
+ * time, by Surface.c's row kernels.
+ */
+
+typedef struct SoftImage {
+    int width;
+    int height;
+    int pitch;
+    int hasAlphaChannel;
+    
+    /* pixels is allocation, rounded up to a 16-byte boundary. */
+    Uint8 *pixels;
+    void *allocation;
+} SoftImage;
+
+static SoftImage *s_GetSoftImage(int softImageID) {
+    return (SoftImage *)PL_Handle_GetData(softImageID, DXHANDLE_SOFTIMAGE);
+}
+
+static Uint32 *s_GetRow(const SoftImage *image, int y) {
+    return (Uint32 *)(image->pixels + (size_t)image->pitch * y);
+}
+
+static Uint32 s_MakeColor(const SoftImage *image, int r, int g, int b, int a) {
+    if (image->hasAlphaChannel == DXFALSE) {
+        a = 255;
+    }
+    
+    return ((Uint32)(a & 0xff) << 24) | ((Uint32)(r & 0xff) << 16)
+           | ((Uint32)(g & 0xff) << 8) | (Uint32)(b & 0xff);
+}
+
+/* ------------------------------------------------------------ Images */
+
+static void s_FillRect(SoftImage *image, int x, int y, int w, int h, Uint32 color) {
+    int i;
+    
+    for (i = 0; i < h; ++i) {
+        PL_Surface_FillRow(s_GetRow(image, y + i) + x, w, color);
+    }
+}
+
+/* Wraps the pixels in a surface, without copying them.
+ * Opaque images are ARGB8888 too, so the renderer takes them as-is. */
+static SDL_Surface *s_WrapSurface(const SoftImage *image) {
+    return SDL_CreateRGBSurfaceFrom(image->pixels, image->width, image->height,
+                                    32, image->pitch,
+                                    0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000);
+}
+
+int PL_SoftImage_Make(int width, int height, int hasAlphaChannel) {
+    SoftImage *image;
+    int softImageID;
+    int pitch;
+    
+    if (width <= 0 || height <= 0 || width > 0x1fffffff / 4) {
+        return -1;
+    }
+    
+    pitch = (width * 4 + 15) & ~15;
+    if (height > 0x7fffffff / pitch) {
+        return -1;
+    }
+    
+    softImageID = PL_Handle_AcquireID(DXHANDLE_SOFTIMAGE);
+    if (softImageID < 0) {
+        return -1;
+    }
+    
+    image = (SoftImage *)PL_Handle_AllocateData(softImageID, sizeof(SoftImage));
+    
+    image->allocation = DXALLOC((size_t)pitch * height + 15);
+    if (image->allocation == NULL) {
+        PL_Handle_ReleaseID(softImageID, DXTRUE);
+        return -1;
+    }
+    image->pixels = (Uint8 *)(((size_t)image->allocation + 15) & ~(size_t)15);
+    image->width = width;
+    image->height = height;
+    image->pitch = pitch;
+    image->hasAlphaChannel = hasAlphaChannel ? DXTRUE : DXFALSE;
+    
+    s_FillRect(image, 0, 0, width, height, s_MakeColor(image, 0, 0, 0, 0));
+    
+    return softImageID;
+}
+
+/* Copies a loaded surface's pixels in, converting them on the way. */
+static int s_CopySurface(SoftImage *image, SDL_Surface *surface) {
+    Uint32 format = surface->format->format;
+    int y;
+    
+    if (format == SDL_PIXELFORMAT_ARGB8888 || format == SDL_PIXELFORMAT_RGB888
+        || format == SDL_PIXELFORMAT_ABGR8888 || format == SDL_PIXELFORMAT_BGR888
+    ) {
+        int swap = (format == SDL_PIXELFORMAT_ABGR8888 || format == SDL_PIXELFORMAT_BGR888);
+        
+        if (SDL_MUSTLOCK(surface)) {
+            SDL_LockSurface(surface);
+        }
+        for (y = 0; y < image->height; ++y) {
+            const Uint32 *src = (const Uint32 *)((const Uint8 *)surface->pixels
+                                                 + (size_t)surface->pitch * y);
+            Uint32 *dest = s_GetRow(image, y);
+            
+            if (swap) {
+                PL_Surface_SwapRedBlueRow(dest, src, image->width);
+            } else {
+                SDL_memcpy(dest, src, (size_t)image->width * 4);
+            }
+        }
+        if (SDL_MUSTLOCK(surface)) {
+            SDL_UnlockSurface(surface);
+        }
+    } else {
+        /* SDL converts everything else, straight into the image.
+         * Color keyed pixels are skipped, and so stay transparent. */
+        SDL_Surface *wrapper = s_WrapSurface(image);
+        if (wrapper == NULL) {
+            return -1;
+        }
+        
+        SDL_SetSurfaceBlendMode(surface, SDL_BLENDMODE_NONE);
+        SDL_BlitSurface(surface, NULL, wrapper, NULL);
+        SDL_FreeSurface(wrapper);
+    }
+    
+    if (image->hasAlphaChannel == DXFALSE) {
+        for (y = 0; y < image->height; ++y) {
+            Uint32 *row = s_GetRow(image, y);
+            PL_Surface_OpaqueRow(row, row, image->width);
+        }
+    }
+    
+    return 0;
+}
+
+int PL_SoftImage_Load(const DXCHAR *filename) {
+    SDL_RWops *file;
+    SDL_Surface *surface;
+    SoftImage *image;
+    int hasAlphaChannel = DXTRUE;
+    Uint32 colorKey;
+    int softImageID;
+    
+    file = PL_File_OpenStream(filename);
+    if (file == NULL) {
+        return -1;
+    }
+    
+    if (PL_QOI_IsQOI_RW(file)) {
+        surface = PL_QOI_Load_RW(file, SDL_TRUE, &hasAlphaChannel);
+    } else {
+        surface = IMG_Load_RW(file, SDL_TRUE);
+        if (surface != NULL) {
+            hasAlphaChannel = (surface->format->Amask != 0
+                               || SDL_GetColorKey(surface, &colorKey) == 0);
+        }
+    }
+    if (surface == NULL) {
+        return -1;
+    }
+    
+    softImageID = PL_SoftImage_Make(surface->w, surface->h, hasAlphaChannel);
+    image = s_GetSoftImage(softImageID);
+    if (image == NULL || s_CopySurface(image, surface) < 0) {
+        if (image != NULL) {
+            PL_SoftImage_Delete(softImageID);
+        }
+        SDL_FreeSurface(surface);
+        return -1;
+    }
+    
+    SDL_FreeSurface(surface);
+    
+    return softImageID;
+}
+
+int PL_SoftImage_Delete(int softImageID) {
+    SoftImage *image = s_GetSoftImage(softImageID);
+    if (image == NULL) {
+        return -1;
+    }
+    
+    DXFREE(image->allocation);
+    PL_Handle_ReleaseID(softImageID, DXTRUE);
+    
+    return 0;
+}
+
+int PL_SoftImage_InitSoftImage() {
+    int softImageID;
+    
+    while ((softImageID = PL_Handle_GetFirstIDOf(DXHANDLE_SOFTIMAGE)) >= 0) {
+        PL_SoftImage_Delete(softImageID);
+    }
+    
+    return 0;
+}
+
+int PL_SoftImage_GetSize(int softImageID, int *width, int *height) {
+    SoftImage *image = s_GetSoftImage(softImageID);
+    if (image == NULL) {
+        return -1;
+    }
+    
+    if (width != NULL) {
+        *width = image->width;
+    }
+    if (height != NULL) {
+        *height = image->height;
+    }
+    
+    return 0;
+}
+
+void *PL_SoftImage_GetImageAddress(int softImageID) {
+    SoftImage *image = s_GetSoftImage(softImageID);
+    if (image == NULL) {
+        return NULL;
+    }
+    
+    return image->pixels;
+}
+
+int PL_SoftImage_GetPitch(int softImageID) {
+    SoftImage *image = s_GetSoftImage(softImageID);
+    if (image == NULL) {
+        return -1;
+    }
+    
+    return image->pitch;
+}
+
+int PL_SoftImage_GetPixel(int softImageID, int x, int y,
+                          int *r, int *g, int *b, int *a) {
+    SoftImage *image = s_GetSoftImage(softImageID);
+    Uint32 pixel;
+    
+    if (image == NULL
+        || x < 0 || y < 0 || x >= image->width || y >= image->height
+    ) {
+        return -1;
+    }
+    
+    pixel = s_GetRow(image, y)[x];
+    
+    if (r != NULL) {
+        *r = (int)((pixel >> 16) & 0xff);
+    }
+    if (g != NULL) {
+        *g = (int)((pixel >> 8) & 0xff);
+    }
+    if (b != NULL) {
+        *b = (int)(pixel & 0xff);
+    }
+    if (a != NULL) {
+        *a = (int)(pixel >> 24);
+    }
+    
+    return 0;
+}
+
+int PL_SoftImage_DrawPixel(int softImageID, int x, int y, int r, int g, int b, int a) {
+    SoftImage *image = s_GetSoftImage(softImageID);
+    
+    if (image == NULL
+        || x < 0 || y < 0 || x >= image->width || y >= image->height
+    ) {
+        return -1;
+    }
+    
+    s_GetRow(image, y)[x] = s_MakeColor(image, r, g, b, a);
+    
+    return 0;
+}
+
+int PL_SoftImage_Fill(int softImageID, int r, int g, int b, int a) {
+    SoftImage *image = s_GetSoftImage(softImageID);
+    if (image == NULL) {
+        return -1;
+    }
+    
+    s_FillRect(image, 0, 0, image->width, image->height,
+               s_MakeColor(image, r, g, b, a));
+    
+    return 0;
+}
+
+int PL_SoftImage_ClearRect(int softImageID, int x, int y, int w, int h) {
+    SoftImage *image = s_GetSoftImage(softImageID);
+    if (image == NULL) {
+        return -1;
+    }
+    
+    if (x < 0) {
+        w += x;
+        x = 0;
+    }
+    if (y < 0) {
+        h += y;
+        y = 0;
+    }
+    if (w > image->width - x) {
+        w = image->width - x;
+    }
+    if (h > image->height - y) {
+        h = image->height - y;
+    }
+    if (w <= 0 || h <= 0) {
+        return 0;
+    }
+    
+    s_FillRect(image, x, y, w, h, s_MakeColor(image, 0, 0, 0, 0));
+    
+    return 0;
+}
+
+/* Clips a blit to both images. Returns DXFALSE if nothing is left. */
+static int s_ClipBlt(const SoftImage *src, int *srcX, int *srcY, int *w, int *h,
+                     const SoftImage *dest, int *destX, int *destY) {
+    if (*srcX < 0) {
+        *w += *srcX;
+        *destX -= *srcX;
+        *srcX = 0;
+    }
+    if (*srcY < 0) {
+        *h += *srcY;
+        *destY -= *srcY;
+        *srcY = 0;
+    }
+    if (*destX < 0) {
+        *w += *destX;
+        *srcX -= *destX;
+        *destX = 0;
+    }
+    if (*destY < 0) {
+        *h += *destY;
+        *srcY -= *destY;
+        *destY = 0;
+    }
+    
+    if (*w > src->width - *srcX) {
+        *w = src->width - *srcX;
+    }
+    if (*h > src->height - *srcY) {
+        *h = src->height - *srcY;
+    }
+    if (*w > dest->width - *destX) {
+        *w = dest->width - *destX;
+    }
+    if (*h > dest->height - *destY) {
+        *h = dest->height - *destY;
+    }
+    
+    return (*w > 0 && *h > 0) ? DXTRUE : DXFALSE;
+}
+
+/* opacity < 0 copies, anything else alpha blends. */
+static int s_Blt(int srcX, int srcY, int w, int h, int srcSoftImageID,
+                 int destX, int destY, int destSoftImageID, int opacity) {
+    SoftImage *src = s_GetSoftImage(srcSoftImageID);
+    SoftImage *dest = s_GetSoftImage(destSoftImageID);
+    Uint32 *temp = NULL;
+    int srcPitch;
+    const Uint8 *srcRow;
+    int y;
+    
+    if (src == NULL || dest == NULL) {
+        return -1;
+    }
+    
+    if (s_ClipBlt(src, &srcX, &srcY, &w, &h, dest, &destX, &destY) == DXFALSE
+        || opacity == 0
+    ) {
+        return 0;
+    }
+    
+    srcRow = (const Uint8 *)(s_GetRow(src, srcY) + srcX);
+    srcPitch = src->pitch;
+    
+    /* Blitting an image onto itself works from a copy if they overlap. */
+    if (src == dest
+        && srcX < destX + w && destX < srcX + w
+        && srcY < destY + h && destY < srcY + h
+    ) {
+        temp = (Uint32 *)DXALLOC((size_t)w * h * 4);
+        if (temp == NULL) {
+            return -1;
+        }
+        for (y = 0; y < h; ++y) {
+            SDL_memcpy(temp + (size_t)w * y, srcRow + (size_t)srcPitch * y,
+                       (size_t)w * 4);
+        }
+        srcRow = (const Uint8 *)temp;
+        srcPitch = w * 4;
+    }
+    
+    for (y = 0; y < h; ++y) {
+        const Uint32 *s = (const Uint32 *)(srcRow + (size_t)srcPitch * y);
+        Uint32 *d = s_GetRow(dest, destY + y) + destX;
+        
+        if (opacity >= 0) {
+            PL_Surface_BlendRow(d, s, w, (unsigned int)(opacity > 255 ? 255 : opacity));
+        } else if (dest->hasAlphaChannel == DXFALSE && src->hasAlphaChannel) {
+            PL_Surface_OpaqueRow(d, s, w);
+        } else {
+            SDL_memcpy(d, s, (size_t)w * 4);
+        }
+    }
+    
+    if (temp != NULL) {
+        DXFREE(temp);
+    }
+    
+    return 0;
+}
+
+int PL_SoftImage_Blt(int srcX, int srcY, int srcSizeX, int srcSizeY, int srcSoftImageID,
+                     int destX, int destY, int destSoftImageID) {
+    return s_Blt(srcX, srcY, srcSizeX, srcSizeY, srcSoftImageID,
+                 destX, destY, destSoftImageID, -1);
+}
+
+int PL_SoftImage_BltAlphaBlend(int srcX, int srcY, int srcSizeX, int srcSizeY,
+                               int srcSoftImageID, int destX, int destY,
+                               int destSoftImageID, int opacity) {
+    if (opacity < 0) {
+        opacity = 0;
+    }
+    
+    return s_Blt(srcX, srcY, srcSizeX, srcSizeY, srcSoftImageID,
+                 destX, destY, destSoftImageID, opacity);
+}
+
+int PL_SoftImage_CreateGraph(int softImageID) {
+    SoftImage *image = s_GetSoftImage(softImageID);
+    SDL_Surface *surface;
+    int graphID;
+    
+    if (image == NULL) {
+        return -1;
+    }
+    
+    surface = s_WrapSurface(image);
+    if (surface == NULL) {
+        return -1;
+    }
+    
+    graphID = PL_Graph_CreateFromSurface(surface, image->hasAlphaChannel);
+    
+    SDL_FreeSurface(surface);
+    
+    return graphID;
+}
+
+/* The graph has to be the same size as the image. */
+int PL_SoftImage_ReCreateGraph(int softImageID, int graphID) {
+    SoftImage *image = s_GetSoftImage(softImageID);
+    SDL_Surface *surface;
+    SDL_Rect rect;
+    int textureRefID;
+    int retval;
+    
+    if (image == NULL) {
+        return -1;
+    }
+    
+    textureRefID = PL_Graph_GetTextureID(graphID, &rect);
+    if (textureRefID < 0 || rect.w != image->width || rect.h != image->height) {
+        return -1;
+    }
+    
+    surface = s_WrapSurface(image);
+    if (surface == NULL) {
+        return -1;
+    }
+    
+    PL_Graph_StopSharing(graphID);
+    
+    retval = PL_Texture_BlitSurface(textureRefID, surface, &rect);
+    
+    SDL_FreeSurface(surface);
+    
+    return retval;
+}
+
+/* compressionLevel is ignored, as it is for SaveDrawScreenToPNG. */
+int PL_SoftImage_SaveToPNG(const DXCHAR *filename, int softImageID,
+                           int compressionLevel) {
+    SoftImage *image = s_GetSoftImage(softImageID);
+    SDL_Surface *surface;
+    char namebuf[4096];
+    int retval;
+    
+    if (image == NULL) {
+        return -1;
+    }
+    
+    surface = s_WrapSurface(image);
+    if (surface == NULL) {
+        return -1;
+    }
+    
+    PL_Text_DxStringToString(filename, namebuf, 4096, DX_CHARSET_EXT_UTF8);
+    
+    retval = IMG_SavePNG(surface, namebuf);
+    
+    SDL_FreeSurface(surface);
+    
+    return retval;
+}
+
+#endif /* #ifndef DX_NON_SOFTIMAGE */
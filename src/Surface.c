@@ -0,0 +1,817 @@
+/*
+  DxPortLib - A portability library for DxLib-based software.
+  Copyright (C) 2013 Patrick McCarthy <mauve@sandwich.net>
+  
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+  
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+  
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required. 
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include "DxInternal.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define SURFACE_USE_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#  include <arm_neon.h>
+#  define SURFACE_USE_NEON
+#endif
+
+/* AVX2 can't be assumed, so its kernels are built for it on their own
+ * and only used if the CPU and OS turn out to support it. */
+#if defined(SURFACE_USE_SSE2) && defined(__GNUC__) \
+    && (defined(__clang__) || __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#  include <immintrin.h>
+#  include <cpuid.h>
+#  define SURFACE_USE_AVX2
+#  define SURFACE_AVX2_FUNC __attribute__((target("avx2")))
+#elif defined(SURFACE_USE_SSE2) && defined(_MSC_VER) && _MSC_VER >= 1700
+#  include <immintrin.h>
+#  include <intrin.h>
+#  define SURFACE_USE_AVX2
+#  define SURFACE_AVX2_FUNC
+#endif
+
+/* SIMD dispatch.
+ *
+ * SSE2 or NEON is picked at compile time, AVX2 at run time, by asking
+ * the CPU with cpuid whether it has AVX2, and the OS with xgetbv whether
+ * it saves the YMM registers. PL_Surface_SetSIMDLevel can turn either
+ * off, so the tests can check them against the scalar code.
+ */
+static int s_simdLevel = -1;
+
+#if defined(SURFACE_USE_AVX2)
+static int s_CPUHasAVX2() {
+    unsigned int a, b, c, d;
+    Uint64 xcr0;
+
+#  if defined(_MSC_VER)
+    int regs[4];
+    
+    __cpuid(regs, 0);
+    if (regs[0] < 7) {
+        return DXFALSE;
+    }
+    __cpuid(regs, 1);
+    c = (unsigned int)regs[2];
+#  else
+    if (__get_cpuid_max(0, NULL) < 7) {
+        return DXFALSE;
+    }
+    __cpuid(1, a, b, c, d);
+#  endif
+    
+    /* OSXSAVE and AVX. */
+    if ((c & 0x18000000) != 0x18000000) {
+        return DXFALSE;
+    }
+    
+    /* The OS has to save the XMM and YMM state. */
+#  if defined(_MSC_VER)
+    xcr0 = _xgetbv(0);
+#  else
+    __asm__ __volatile__ (".byte 0x0f, 0x01, 0xd0" : "=a"(a), "=d"(d) : "c"(0));
+    xcr0 = ((Uint64)d << 32) | a;
+#  endif
+    if ((xcr0 & 6) != 6) {
+        return DXFALSE;
+    }
+
+#  if defined(_MSC_VER)
+    __cpuidex(regs, 7, 0);
+    b = (unsigned int)regs[1];
+#  else
+    __cpuid_count(7, 0, a, b, c, d);
+#  endif
+    
+    return (b & 0x20) ? DXTRUE : DXFALSE;
+}
+#endif
+
+static int s_GetSIMDMax() {
+#if defined(SURFACE_USE_AVX2)
+    if (s_CPUHasAVX2() == DXTRUE) {
+        return PL_SURFACE_SIMD_AVX2;
+    }
+#endif
+#if defined(SURFACE_USE_SSE2) || defined(SURFACE_USE_NEON)
+    return PL_SURFACE_SIMD_BASE;
+#else
+    return PL_SURFACE_SIMD_NONE;
+#endif
+}
+
+static int s_GetSIMDLevel() {
+    if (s_simdLevel < 0) {
+        s_simdLevel = s_GetSIMDMax();
+    }
+    return s_simdLevel;
+}
+
+/* Limits the kernels used to level, or the best available if it's
+ * lower. Returns the level now in use. */
+int PL_Surface_SetSIMDLevel(int level) {
+    int max = s_GetSIMDMax();
+    
+    s_simdLevel = (level < 0 || level > max) ? max : level;
+    
+    return s_simdLevel;
+}
+
+/* 16-bit surfaces.
+ *
+ * With a 16-bit colour depth, graphs are packed down to 16 bits per
+ * pixel before they are handed to the renderer, which halves the memory
+ * they take up on the GPU. Opaque images become RGB565, images whose
+ * alpha is all on or off become RGBA5551, and the rest become RGBA4444.
+ *
+ * Packing is done four pixels at a time. Optionally, an ordered dither
+ * is added first to hide the banding on gradients.
+ */
+
+typedef struct PackedFormat {
+    Uint32 sdlFormat;
+    
+    /* The packed pixel is the OR of ((argb >> shift[i]) & mask[i]). */
+    int shift[4];
+    Uint32 mask[4];
+    
+    /* How far to shift a 0-15 dither value down for each of R, G, B. */
+    int ditherShift[3];
+} PackedFormat;
+
+static const PackedFormat s_formatRGB565 = {
+    SDL_PIXELFORMAT_RGB565,
+    { 8, 5, 3, 0 },
+    { 0xf800, 0x07e0, 0x001f, 0x0000 },
+    { 1, 2, 1 }
+};
+static const PackedFormat s_formatRGBA4444 = {
+    SDL_PIXELFORMAT_RGBA4444,
+    { 8, 4, 0, 28 },
+    { 0xf000, 0x0f00, 0x00f0, 0x000f },
+    { 0, 0, 0 }
+};
+static const PackedFormat s_formatRGBA5551 = {
+    SDL_PIXELFORMAT_RGBA5551,
+    { 8, 5, 2, 31 },
+    { 0xf800, 0x07c0, 0x003e, 0x0001 },
+    { 1, 1, 1 }
+};
+
+static const Uint8 s_bayerMatrix[4][4] = {
+    {  0,  8,  2, 10 },
+    { 12,  4, 14,  6 },
+    {  3, 11,  1,  9 },
+    { 15,  7, 13,  5 }
+};
+
+/* Alpha decides the format: none, on/off, or anything in between. */
+static const PackedFormat *s_ChooseFormat(SDL_Surface *surface, int hasAlphaChannel) {
+    const Uint32 *pixels = (const Uint32 *)surface->pixels;
+    int pitch = surface->pitch / 4;
+    int x, y;
+    
+    if (hasAlphaChannel == DXFALSE) {
+        return &s_formatRGB565;
+    }
+    
+    for (y = 0; y < surface->h; ++y) {
+        for (x = 0; x < surface->w; ++x) {
+            Uint32 alpha = pixels[x] >> 24;
+            if (alpha != 0 && alpha != 0xff) {
+                return &s_formatRGBA4444;
+            }
+        }
+        pixels += pitch;
+    }
+    
+    return &s_formatRGBA5551;
+}
+
+/* Adds each byte of d to x, clamping at 0xff. */
+static Uint32 s_AddSaturate(Uint32 x, Uint32 d) {
+    Uint32 result = 0;
+    int shift;
+    
+    for (shift = 0; shift < 32; shift += 8) {
+        Uint32 c = ((x >> shift) & 0xff) + ((d >> shift) & 0xff);
+        if (c > 0xff) {
+            c = 0xff;
+        }
+        result |= c << shift;
+    }
+    
+    return result;
+}
+
+static void s_PackRow(const PackedFormat *fmt, Uint16 *dest, const Uint32 *src,
+                      int width, const Uint32 *dither) {
+    int x = 0;
+
+#if defined(SURFACE_USE_SSE2)
+    if (s_GetSIMDLevel() >= PL_SURFACE_SIMD_BASE) {
+        __m128i vdither = _mm_loadu_si128((const __m128i *)dither);
+        __m128i vshift[4], vmask[4];
+        int i;
+        
+        for (i = 0; i < 4; ++i) {
+            vshift[i] = _mm_cvtsi32_si128(fmt->shift[i]);
+            vmask[i] = _mm_set1_epi32((int)fmt->mask[i]);
+        }
+        
+        for (; x + 8 <= width; x += 8) {
+            __m128i a = _mm_adds_epu8(_mm_loadu_si128((const __m128i *)(src + x)), vdither);
+            __m128i b = _mm_adds_epu8(_mm_loadu_si128((const __m128i *)(src + x + 4)), vdither);
+            __m128i pa = _mm_setzero_si128();
+            __m128i pb = _mm_setzero_si128();
+            
+            for (i = 0; i < 4; ++i) {
+                pa = _mm_or_si128(pa, _mm_and_si128(_mm_srl_epi32(a, vshift[i]), vmask[i]));
+                pb = _mm_or_si128(pb, _mm_and_si128(_mm_srl_epi32(b, vshift[i]), vmask[i]));
+            }
+            
+            /* Sign extend the low halves so the saturating pack keeps them. */
+            pa = _mm_srai_epi32(_mm_slli_epi32(pa, 16), 16);
+            pb = _mm_srai_epi32(_mm_slli_epi32(pb, 16), 16);
+            _mm_storeu_si128((__m128i *)(dest + x), _mm_packs_epi32(pa, pb));
+        }
+    }
+#elif defined(SURFACE_USE_NEON)
+    if (s_GetSIMDLevel() >= PL_SURFACE_SIMD_BASE) {
+        uint8x16_t vdither = vreinterpretq_u8_u32(vld1q_u32(dither));
+        int32x4_t vshift[4];
+        uint32x4_t vmask[4];
+        int i;
+        
+        for (i = 0; i < 4; ++i) {
+            vshift[i] = vdupq_n_s32(-fmt->shift[i]);
+            vmask[i] = vdupq_n_u32(fmt->mask[i]);
+        }
+        
+        for (; x + 4 <= width; x += 4) {
+            uint32x4_t a = vreinterpretq_u32_u8(
+                vqaddq_u8(vreinterpretq_u8_u32(vld1q_u32(src + x)), vdither));
+            uint32x4_t p = vdupq_n_u32(0);
+            
+            for (i = 0; i < 4; ++i) {
+                p = vorrq_u32(p, vandq_u32(vshlq_u32(a, vshift[i]), vmask[i]));
+            }
+            
+            vst1_u16(dest + x, vmovn_u32(p));
+        }
+    }
+#endif
+    
+    /* Scalar version, also picks up whatever is left over. */
+    for (; x < width; ++x) {
+        Uint32 c = s_AddSaturate(src[x], dither[x & 3]);
+        dest[x] = (Uint16)(((c >> fmt->shift[0]) & fmt->mask[0])
+                           | ((c >> fmt->shift[1]) & fmt->mask[1])
+                           | ((c >> fmt->shift[2]) & fmt->mask[2])
+                           | ((c >> fmt->shift[3]) & fmt->mask[3]));
+    }
+}
+
+SDL_Surface *PL_Surface_ConvertTo16Bit(SDL_Surface *surface, int hasAlphaChannel,
+                                       int ditherFlag) {
+    SDL_Surface *src = surface;
+    SDL_Surface *dest;
+    const PackedFormat *fmt;
+    Uint32 dither[4];
+    Uint32 rmask, gmask, bmask, amask;
+    int bpp;
+    int x, y;
+    
+    if (surface->format->format != SDL_PIXELFORMAT_ARGB8888) {
+        src = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_ARGB8888, 0);
+        if (src == NULL) {
+            return NULL;
+        }
+    }
+    
+    fmt = s_ChooseFormat(src, hasAlphaChannel);
+    
+    SDL_PixelFormatEnumToMasks(fmt->sdlFormat, &bpp, &rmask, &gmask, &bmask, &amask);
+    dest = SDL_CreateRGBSurface(SDL_SWSURFACE, src->w, src->h, bpp,
+                                rmask, gmask, bmask, amask);
+    if (dest != NULL) {
+        for (y = 0; y < src->h; ++y) {
+            for (x = 0; x < 4; ++x) {
+                Uint32 d = 0;
+                if (ditherFlag != DXFALSE) {
+                    d = s_bayerMatrix[y & 3][x];
+                    d = ((d >> fmt->ditherShift[0]) << 16)
+                        | ((d >> fmt->ditherShift[1]) << 8)
+                        | (d >> fmt->ditherShift[2]);
+                }
+                dither[x] = d;
+            }
+            
+            s_PackRow(fmt,
+                      (Uint16 *)((Uint8 *)dest->pixels + y * dest->pitch),
+                      (const Uint32 *)((const Uint8 *)src->pixels + y * src->pitch),
+                      src->w, dither);
+        }
+    }
+    
+    if (src != surface) {
+        SDL_FreeSurface(src);
+    }
+    
+    return dest;
+}
+
+/* Colour keys.
+ *
+ * Every pixel matching the key is cleared to transparent black.
+ * Returns DXTRUE if any were found. Four pixels are compared at a time,
+ * or eight with AVX2.
+ */
+#if defined(SURFACE_USE_AVX2)
+SURFACE_AVX2_FUNC
+static int s_ColorKeyBlocksAVX2(Uint32 *pixels, int width, Uint32 key, int *dFound) {
+    __m256i vkey = _mm256_set1_epi32((int)key);
+    __m256i vfound = _mm256_setzero_si256();
+    int x = 0;
+    
+    for (; x + 8 <= width; x += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(pixels + x));
+        __m256i m = _mm256_cmpeq_epi32(v, vkey);
+        _mm256_storeu_si256((__m256i *)(pixels + x), _mm256_andnot_si256(m, v));
+        vfound = _mm256_or_si256(vfound, m);
+    }
+    
+    if (_mm256_movemask_epi8(vfound) != 0) {
+        *dFound = DXTRUE;
+    }
+    
+    return x;
+}
+#endif
+
+static int s_ColorKeyRow(Uint32 *pixels, int width, Uint32 key, int level) {
+    int found = DXFALSE;
+    int x = 0;
+
+#if defined(SURFACE_USE_AVX2)
+    if (level >= PL_SURFACE_SIMD_AVX2) {
+        x = s_ColorKeyBlocksAVX2(pixels, width, key, &found);
+    }
+#endif
+
+#if defined(SURFACE_USE_SSE2)
+    if (level >= PL_SURFACE_SIMD_BASE) {
+        __m128i vkey = _mm_set1_epi32((int)key);
+        __m128i vfound = _mm_setzero_si128();
+        
+        for (; x + 4 <= width; x += 4) {
+            __m128i v = _mm_loadu_si128((const __m128i *)(pixels + x));
+            __m128i m = _mm_cmpeq_epi32(v, vkey);
+            _mm_storeu_si128((__m128i *)(pixels + x), _mm_andnot_si128(m, v));
+            vfound = _mm_or_si128(vfound, m);
+        }
+        
+        if (_mm_movemask_epi8(vfound) != 0) {
+            found = DXTRUE;
+        }
+    }
+#elif defined(SURFACE_USE_NEON)
+    if (level >= PL_SURFACE_SIMD_BASE) {
+        uint32x4_t vkey = vdupq_n_u32(key);
+        uint32x4_t vfound = vdupq_n_u32(0);
+        uint32x2_t f;
+        
+        for (; x + 4 <= width; x += 4) {
+            uint32x4_t v = vld1q_u32(pixels + x);
+            uint32x4_t m = vceqq_u32(v, vkey);
+            vst1q_u32(pixels + x, vbicq_u32(v, m));
+            vfound = vorrq_u32(vfound, m);
+        }
+        
+        f = vorr_u32(vget_low_u32(vfound), vget_high_u32(vfound));
+        if ((vget_lane_u32(f, 0) | vget_lane_u32(f, 1)) != 0) {
+            found = DXTRUE;
+        }
+    }
+#endif
+    
+    /* Scalar version, also picks up whatever is left over. */
+    for (; x < width; ++x) {
+        if (pixels[x] == key) {
+            pixels[x] = 0;
+            found = DXTRUE;
+        }
+    }
+    
+    return found;
+}
+
+int PL_Surface_ApplyColorKey(SDL_Surface *surface, Uint32 key) {
+    Uint32 *pixels = (Uint32 *)surface->pixels;
+    int pitch = surface->pitch / 4;
+    int level = s_GetSIMDLevel();
+    int found = DXFALSE;
+    int y;
+    
+    for (y = 0; y < surface->h; ++y) {
+        if (s_ColorKeyRow(pixels, surface->w, key, level) == DXTRUE) {
+            found = DXTRUE;
+        }
+        
+        pixels += pitch;
+    }
+    
+    return found;
+}
+
+/* Horizontal flips.
+ *
+ * Rows are mirrored in place, by swapping pixels from both ends inwards.
+ * With SIMD, a block from each end is reversed and the two are swapped,
+ * until the blocks would overlap; the middle is done one pixel at a time.
+ * AVX2 starts with 32-byte blocks, and SSE2 finishes with 16-byte ones.
+ */
+#if defined(SURFACE_USE_AVX2)
+SURFACE_AVX2_FUNC
+static __m256i s_Reverse256(__m256i v, int size) {
+    if (size == 4) {
+        return _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+    }
+    
+    if (size == 1) {
+        v = _mm256_shuffle_epi8(v, _mm256_setr_epi8(
+            15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+            15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0));
+    } else {
+        v = _mm256_shuffle_epi8(v, _mm256_setr_epi8(
+            14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1,
+            14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1));
+    }
+    return _mm256_permute4x64_epi64(v, _MM_SHUFFLE(1, 0, 3, 2));
+}
+
+SURFACE_AVX2_FUNC
+static void s_FlipBlocksAVX2(Uint8 *row, int *l, int *r, int size) {
+    while (*l + 64 <= *r) {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(row + *l));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(row + *r - 32));
+        _mm256_storeu_si256((__m256i *)(row + *l), s_Reverse256(b, size));
+        _mm256_storeu_si256((__m256i *)(row + *r - 32), s_Reverse256(a, size));
+        *l += 32;
+        *r -= 32;
+    }
+}
+#endif
+
+#if defined(SURFACE_USE_SSE2)
+/* Reverses the order of the size-byte elements in v. */
+static __m128i s_Reverse(__m128i v, int size) {
+    if (size == 1) {
+        v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+    }
+    if (size <= 2) {
+        v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+        v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+        return _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+    }
+    return _mm_shuffle_epi32(v, _MM_SHUFFLE(0, 1, 2, 3));
+}
+#elif defined(SURFACE_USE_NEON)
+static uint8x16_t s_Reverse(uint8x16_t v, int size) {
+    if (size == 1) {
+        v = vrev64q_u8(v);
+    } else if (size == 2) {
+        v = vreinterpretq_u8_u16(vrev64q_u16(vreinterpretq_u16_u8(v)));
+    } else {
+        v = vreinterpretq_u8_u32(vrev64q_u32(vreinterpretq_u32_u8(v)));
+    }
+    return vcombine_u8(vget_high_u8(v), vget_low_u8(v));
+}
+#endif
+
+/* Swaps and reverses blocks from either end of a row of n elements,
+ * returning how many elements were done from each end. */
+static int s_FlipBlocks(Uint8 *row, int n, int size, int level) {
+#if defined(SURFACE_USE_SSE2) || defined(SURFACE_USE_NEON)
+    int l = 0;
+    int r = n * size;
+
+#if defined(SURFACE_USE_AVX2)
+    if (level >= PL_SURFACE_SIMD_AVX2) {
+        s_FlipBlocksAVX2(row, &l, &r, size);
+    }
+#endif
+
+#if defined(SURFACE_USE_SSE2)
+    if (level >= PL_SURFACE_SIMD_BASE) {
+        while (l + 32 <= r) {
+            __m128i a = _mm_loadu_si128((const __m128i *)(row + l));
+            __m128i b = _mm_loadu_si128((const __m128i *)(row + r - 16));
+            _mm_storeu_si128((__m128i *)(row + l), s_Reverse(b, size));
+            _mm_storeu_si128((__m128i *)(row + r - 16), s_Reverse(a, size));
+            l += 16;
+            r -= 16;
+        }
+    }
+#elif defined(SURFACE_USE_NEON)
+    if (level >= PL_SURFACE_SIMD_BASE) {
+        while (l + 32 <= r) {
+            uint8x16_t a = vld1q_u8(row + l);
+            uint8x16_t b = vld1q_u8(row + r - 16);
+            vst1q_u8(row + l, s_Reverse(b, size));
+            vst1q_u8(row + r - 16, s_Reverse(a, size));
+            l += 16;
+            r -= 16;
+        }
+    }
+#endif
+    
+    return l / size;
+#else
+    return 0;
+#endif
+}
+
+static void s_FlipRow8(Uint8 *p, int w, int level) {
+    int l = s_FlipBlocks(p, w, 1, level);
+    int r = w - 1 - l;
+    
+    for (; l < r; ++l, --r) {
+        Uint8 t = p[l]; p[l] = p[r]; p[r] = t;
+    }
+}
+
+static void s_FlipRow16(Uint16 *p, int w, int level) {
+    int l = s_FlipBlocks((Uint8 *)p, w, 2, level);
+    int r = w - 1 - l;
+    
+    for (; l < r; ++l, --r) {
+        Uint16 t = p[l]; p[l] = p[r]; p[r] = t;
+    }
+}
+
+static void s_FlipRow24(Uint8 *a, int w) {
+    Uint8 *b = a + (w - 1) * 3;
+    Uint8 t;
+    
+    for (; a < b; a += 3, b -= 3) {
+        t = a[0]; a[0] = b[0]; b[0] = t;
+        t = a[1]; a[1] = b[1]; b[1] = t;
+        t = a[2]; a[2] = b[2]; b[2] = t;
+    }
+}
+
+static void s_FlipRow32(Uint32 *p, int w, int level) {
+    int l = s_FlipBlocks((Uint8 *)p, w, 4, level);
+    int r = w - 1 - l;
+    
+    for (; l < r; ++l, --r) {
+        Uint32 t = p[l]; p[l] = p[r]; p[r] = t;
+    }
+}
+
+int PL_Surface_FlipHorizontal(SDL_Surface *surface) {
+    Uint8 *row = (Uint8 *)surface->pixels;
+    int level = s_GetSIMDLevel();
+    int y;
+    
+    for (y = 0; y < surface->h; ++y) {
+        switch (surface->format->BytesPerPixel) {
+            case 1:
+                s_FlipRow8(row, surface->w, level);
+                break;
+            case 2:
+                s_FlipRow16((Uint16 *)row, surface->w, level);
+                break;
+            case 3:
+                s_FlipRow24(row, surface->w);
+                break;
+            case 4:
+                s_FlipRow32((Uint32 *)row, surface->w, level);
+                break;
+            default:
+                return -1;
+        }
+        
+        row += surface->pitch;
+    }
+    
+    return 0;
+}
+
+/* Soft image rows.
+ *
+ * SoftImage works on whole ARGB8888 rows with these, four pixels at a
+ * time. Blits can start anywhere in a row, so nothing here counts on
+ * the rows being aligned.
+ */
+
+/* Exact x / 255, rounded, for x up to 255 * 255. */
+static unsigned int s_Div255(unsigned int x) {
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+void PL_Surface_FillRow(Uint32 *dest, int n, Uint32 color) {
+    int i = 0;
+
+#if defined(SURFACE_USE_SSE2)
+    if (s_GetSIMDLevel() >= PL_SURFACE_SIMD_BASE) {
+        __m128i v = _mm_set1_epi32((int)color);
+        for (; i + 4 <= n; i += 4) {
+            _mm_storeu_si128((__m128i *)(dest + i), v);
+        }
+    }
+#elif defined(SURFACE_USE_NEON)
+    if (s_GetSIMDLevel() >= PL_SURFACE_SIMD_BASE) {
+        uint32x4_t v = vdupq_n_u32(color);
+        for (; i + 4 <= n; i += 4) {
+            vst1q_u32(dest + i, v);
+        }
+    }
+#endif
+    
+    for (; i < n; ++i) {
+        dest[i] = color;
+    }
+}
+
+/* Copies src with its alpha forced to 255. dest may be src. */
+void PL_Surface_OpaqueRow(Uint32 *dest, const Uint32 *src, int n) {
+    int i = 0;
+
+#if defined(SURFACE_USE_SSE2)
+    if (s_GetSIMDLevel() >= PL_SURFACE_SIMD_BASE) {
+        __m128i alpha = _mm_set1_epi32((int)0xff000000);
+        for (; i + 4 <= n; i += 4) {
+            __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+            _mm_storeu_si128((__m128i *)(dest + i), _mm_or_si128(v, alpha));
+        }
+    }
+#elif defined(SURFACE_USE_NEON)
+    if (s_GetSIMDLevel() >= PL_SURFACE_SIMD_BASE) {
+        uint32x4_t alpha = vdupq_n_u32(0xff000000);
+        for (; i + 4 <= n; i += 4) {
+            vst1q_u32(dest + i, vorrq_u32(vld1q_u32(src + i), alpha));
+        }
+    }
+#endif
+    
+    for (; i < n; ++i) {
+        dest[i] = src[i] | 0xff000000;
+    }
+}
+
+/* ABGR8888 to ARGB8888, or back; it's the same swap. */
+void PL_Surface_SwapRedBlueRow(Uint32 *dest, const Uint32 *src, int n) {
+    int i = 0;
+
+#if defined(SURFACE_USE_SSE2)
+    if (s_GetSIMDLevel() >= PL_SURFACE_SIMD_BASE) {
+        __m128i agMask = _mm_set1_epi32((int)0xff00ff00);
+        __m128i rbMask = _mm_set1_epi32(0x00ff00ff);
+        for (; i + 4 <= n; i += 4) {
+            __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+            __m128i rb = _mm_and_si128(v, rbMask);
+            
+            rb = _mm_or_si128(_mm_slli_epi32(rb, 16), _mm_srli_epi32(rb, 16));
+            _mm_storeu_si128((__m128i *)(dest + i),
+                             _mm_or_si128(_mm_and_si128(v, agMask), rb));
+        }
+    }
+#elif defined(SURFACE_USE_NEON)
+    if (s_GetSIMDLevel() >= PL_SURFACE_SIMD_BASE) {
+        uint32x4_t agMask = vdupq_n_u32(0xff00ff00);
+        uint32x4_t rbMask = vdupq_n_u32(0x00ff00ff);
+        for (; i + 4 <= n; i += 4) {
+            uint32x4_t v = vld1q_u32(src + i);
+            uint32x4_t rb = vandq_u32(v, rbMask);
+            
+            rb = vorrq_u32(vshlq_n_u32(rb, 16), vshrq_n_u32(rb, 16));
+            vst1q_u32(dest + i, vorrq_u32(vandq_u32(v, agMask), rb));
+        }
+    }
+#endif
+    
+    for (; i < n; ++i) {
+        Uint32 v = src[i];
+        dest[i] = (v & 0xff00ff00) | ((v >> 16) & 0xff) | ((v & 0xff) << 16);
+    }
+}
+
+/* Draws src over dest, with src's alpha scaled by opacity (0-255).
+ * Every channel works out to (s * a + d * (255 - a)) / 255, with s
+ * taken as 255 for alpha, so an opaque dest stays opaque. */
+void PL_Surface_BlendRow(Uint32 *dest, const Uint32 *src, int n, unsigned int opacity) {
+    int i = 0;
+
+#if defined(SURFACE_USE_SSE2)
+    if (s_GetSIMDLevel() >= PL_SURFACE_SIMD_BASE) {
+        __m128i zero = _mm_setzero_si128();
+        __m128i alphaBits = _mm_set1_epi32((int)0xff000000);
+        __m128i v255 = _mm_set1_epi16(255);
+        __m128i v128 = _mm_set1_epi16(128);
+        __m128i vOpacity = _mm_set1_epi32((int)opacity);
+        
+        for (; i + 4 <= n; i += 4) {
+            __m128i s = _mm_loadu_si128((const __m128i *)(src + i));
+            __m128i d = _mm_loadu_si128((const __m128i *)(dest + i));
+            __m128i a = _mm_srli_epi32(s, 24);
+            __m128i aLo, aHi, lo, hi;
+            
+            if (opacity < 255) {
+                a = _mm_add_epi16(_mm_mullo_epi16(a, vOpacity), v128);
+                a = _mm_srli_epi16(_mm_add_epi16(a, _mm_srli_epi16(a, 8)), 8);
+            }
+            
+            /* Spread each pixel's alpha over its four channels. */
+            a = _mm_or_si128(a, _mm_slli_epi32(a, 16));
+            aLo = _mm_unpacklo_epi32(a, a);
+            aHi = _mm_unpackhi_epi32(a, a);
+            
+            s = _mm_or_si128(s, alphaBits);
+            
+            lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(s, zero), aLo),
+                               _mm_mullo_epi16(_mm_unpacklo_epi8(d, zero),
+                                               _mm_sub_epi16(v255, aLo)));
+            hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(s, zero), aHi),
+                               _mm_mullo_epi16(_mm_unpackhi_epi8(d, zero),
+                                               _mm_sub_epi16(v255, aHi)));
+            
+            lo = _mm_add_epi16(lo, v128);
+            lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+            hi = _mm_add_epi16(hi, v128);
+            hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+            
+            _mm_storeu_si128((__m128i *)(dest + i), _mm_packus_epi16(lo, hi));
+        }
+    }
+#elif defined(SURFACE_USE_NEON)
+    if (s_GetSIMDLevel() >= PL_SURFACE_SIMD_BASE) {
+        uint32x4_t alphaBits = vdupq_n_u32(0xff000000);
+        uint8x8_t v255 = vdup_n_u8(255);
+        
+        for (; i + 4 <= n; i += 4) {
+            uint32x4_t s = vld1q_u32(src + i);
+            uint8x16_t d = vreinterpretq_u8_u32(vld1q_u32(dest + i));
+            uint32x4_t a = vshrq_n_u32(s, 24);
+            uint8x16_t a8, s8;
+            uint16x8_t lo, hi;
+            
+            if (opacity < 255) {
+                a = vaddq_u32(vmulq_n_u32(a, opacity), vdupq_n_u32(128));
+                a = vshrq_n_u32(vaddq_u32(a, vshrq_n_u32(a, 8)), 8);
+            }
+            
+            /* Spread each pixel's alpha over its four channels. */
+            a8 = vreinterpretq_u8_u32(vmulq_n_u32(a, 0x01010101));
+            s8 = vreinterpretq_u8_u32(vorrq_u32(s, alphaBits));
+            
+            lo = vmull_u8(vget_low_u8(s8), vget_low_u8(a8));
+            lo = vmlal_u8(lo, vget_low_u8(d), vsub_u8(v255, vget_low_u8(a8)));
+            hi = vmull_u8(vget_high_u8(s8), vget_high_u8(a8));
+            hi = vmlal_u8(hi, vget_high_u8(d), vsub_u8(v255, vget_high_u8(a8)));
+            
+            lo = vaddq_u16(lo, vdupq_n_u16(128));
+            hi = vaddq_u16(hi, vdupq_n_u16(128));
+            vst1q_u32(dest + i, vreinterpretq_u32_u8(
+                vcombine_u8(vshrn_n_u16(vaddq_u16(lo, vshrq_n_u16(lo, 8)), 8),
+                            vshrn_n_u16(vaddq_u16(hi, vshrq_n_u16(hi, 8)), 8))));
+        }
+    }
+#endif
+    
+    for (; i < n; ++i) {
+        Uint32 s = src[i] | 0xff000000;
+        Uint32 d = dest[i];
+        unsigned int a = src[i] >> 24;
+        unsigned int ia;
+        Uint32 out = 0;
+        int shift;
+        
+        if (opacity < 255) {
+            a = s_Div255(a * opacity);
+        }
+        ia = 255 - a;
+        
+        for (shift = 0; shift < 32; shift += 8) {
+            out |= (Uint32)s_Div255(((s >> shift) & 0xff) * a
+                                    + ((d >> shift) & 0xff) * ia) << shift;
+        }
+        dest[i] = out;
+    }
+}
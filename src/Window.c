@@ -153,6 +153,11 @@ int PL_Window_End(void) {
     
     s_initialized = DXFALSE;
     
+#ifndef DX_NON_ASYNCLOAD
+    /* The upload thread may be using the loader context. */
+    PL_ASyncLoad_End();
+#endif /* #ifndef DX_NON_ASYNCLOAD */
+    
     PL_Draw_End();
     
     SDL_EnableScreenSaver();
@@ -211,6 +216,10 @@ int PL_Window_SetDimensions(int width, int height, int colorDepth, int refreshRa
     return 0;
 }
 
+int PL_Window_GetColorDepth() {
+    return s_windowDepth;
+}
+
 int PL_Window_SetTitle(const DXCHAR *titleString) {
     if (s_windowTitle != NULL) {
         DXFREE(s_windowTitle);
@@ -240,6 +249,10 @@ int PL_Window_ProcessMessages() {
         return -1;
     }
     
+#ifndef DX_NON_ASYNCLOAD
+    PL_ASyncLoad_Process();
+#endif /* #ifndef DX_NON_ASYNCLOAD */
+    
     do {
         while (SDL_PollEvent(&event)) {
             switch(event.type) {
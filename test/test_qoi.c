@@ -0,0 +1,220 @@
+/*
+  DxPortLib - A portability library for DxLib-based software.
+  Copyright (C) 2013 Patrick McCarthy <mauve@sandwich.net>
+  
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+  
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+ */
+
+/* Round-trips images through dxqoiconv's encoder and PL_QOI_Decode,
+ * then feeds the decoder broken files: truncated at every length, and
+ * with bad or oversized headers. Returns nonzero on any failure. */
+
+#include "DxInternal.h"
+#include "qoienc.h"
+
+#include "SDL_main.h"
+
+#include <stdio.h>
+
+static Uint32 s_seed = 1;
+
+static Uint32 s_Random() {
+    s_seed = s_seed * 1103515245 + 12345;
+    return (s_seed >> 16) | (s_seed << 16);
+}
+
+static int s_errors = 0;
+
+static void s_Fail(const char *name, int width, int height, int channels) {
+    printf("FAILED: %s, %dx%d, %d channels\n", name, width, height, channels);
+    s_errors += 1;
+}
+
+/* Mixes the cases each op is for: runs longer than one op can hold,
+ * small and larger steps, colours seen before, and noise. */
+static void s_MakeImage(Uint32 *pixels, int width, int height) {
+    Uint32 palette[5];
+    Uint32 pixel = 0xff000000;
+    int i, count = width * height;
+    
+    for (i = 0; i < 5; ++i) {
+        palette[i] = s_Random();
+    }
+    
+    for (i = 0; i < count; ++i) {
+        switch ((i / 97) % 5) {
+            case 0:
+                break;
+            case 1:
+                pixel += 0x00010101 * (s_Random() % 3) - 0x00010101;
+                break;
+            case 2:
+                pixel ^= s_Random() & 0x001f3f1f;
+                break;
+            case 3:
+                pixel = palette[s_Random() % 5];
+                break;
+            default:
+                pixel = s_Random();
+                break;
+        }
+        pixels[i] = pixel;
+    }
+}
+
+/* Decodes from a buffer of exactly size bytes, so reading past the end
+ * shows up under a memory checker. */
+static SDL_Surface *s_Decode(const unsigned char *data, unsigned int size,
+                             int *dHasAlphaChannel) {
+    unsigned char *copy = (unsigned char *)SDL_malloc(size > 0 ? size : 1);
+    SDL_Surface *surface;
+    
+    SDL_memcpy(copy, data, size);
+    surface = PL_QOI_Decode(copy, size, dHasAlphaChannel);
+    SDL_free(copy);
+    
+    return surface;
+}
+
+static int s_Matches(SDL_Surface *surface, const Uint32 *pixels,
+                     int width, int height, int channels) {
+    int x, y;
+    
+    if (surface->w != width || surface->h != height) {
+        return DXFALSE;
+    }
+    
+    for (y = 0; y < height; ++y) {
+        const Uint32 *row = (const Uint32 *)((Uint8 *)surface->pixels + y * surface->pitch);
+        
+        for (x = 0; x < width; ++x) {
+            Uint32 expected = pixels[y * width + x];
+            if (channels == 3) {
+                expected |= 0xff000000;
+            }
+            if (row[x] != expected) {
+                return DXFALSE;
+            }
+        }
+    }
+    
+    return DXTRUE;
+}
+
+static void s_CheckImage(int width, int height, int channels) {
+    Uint32 *pixels = (Uint32 *)SDL_malloc((size_t)width * height * 4);
+    unsigned char *data = (unsigned char *)SDL_malloc(QOI_ENCODED_SIZE_MAX(width, height));
+    SDL_Surface *surface;
+    SDL_RWops *file;
+    unsigned int size, cut;
+    int hasAlphaChannel = -1;
+    
+    s_MakeImage(pixels, width, height);
+    size = QOI_Encode(pixels, width, height, channels, data);
+    
+    surface = s_Decode(data, size, &hasAlphaChannel);
+    if (surface == NULL
+        || s_Matches(surface, pixels, width, height, channels) == DXFALSE
+        || hasAlphaChannel != (channels == 4 ? DXTRUE : DXFALSE)
+    ) {
+        s_Fail("round trip", width, height, channels);
+    }
+    if (surface != NULL) {
+        SDL_FreeSurface(surface);
+    }
+    
+    /* The same, the way LoadGraph reads them. */
+    file = SDL_RWFromConstMem(data, (int)size);
+    if (PL_QOI_IsQOI_RW(file) == DXFALSE || SDL_RWtell(file) != 0) {
+        s_Fail("IsQOI_RW", width, height, channels);
+    }
+    surface = PL_QOI_Load_RW(file, DXTRUE, &hasAlphaChannel);
+    if (surface == NULL
+        || s_Matches(surface, pixels, width, height, channels) == DXFALSE
+    ) {
+        s_Fail("Load_RW", width, height, channels);
+    }
+    if (surface != NULL) {
+        SDL_FreeSurface(surface);
+    }
+    
+    /* Cut short anywhere, a file either fails to decode, or decodes to
+     * the right size; it never reads past its end. */
+    for (cut = 0; cut < size; ++cut) {
+        surface = s_Decode(data, cut, &hasAlphaChannel);
+        if (surface != NULL) {
+            if (cut < QOI_HEADER_SIZE + QOI_PADDING_SIZE
+                || surface->w != width || surface->h != height
+            ) {
+                s_Fail("truncated", width, height, channels);
+            }
+            SDL_FreeSurface(surface);
+        }
+    }
+    
+    SDL_free(data);
+    SDL_free(pixels);
+}
+
+static void s_Write32BE(unsigned char *dest, Uint32 v) {
+    dest[0] = (unsigned char)(v >> 24);
+    dest[1] = (unsigned char)(v >> 16);
+    dest[2] = (unsigned char)(v >> 8);
+    dest[3] = (unsigned char)v;
+}
+
+/* A header followed by a single run and the end padding.
+ * Only the good header should decode. */
+static void s_CheckHeader(const char *name, const char *magic,
+                          Uint32 width, Uint32 height, int channels, int good) {
+    unsigned char data[QOI_HEADER_SIZE + 1 + QOI_PADDING_SIZE];
+    SDL_Surface *surface;
+    int hasAlphaChannel;
+    
+    SDL_memset(data, 0, sizeof(data));
+    SDL_memcpy(data, magic, 4);
+    s_Write32BE(data + 4, width);
+    s_Write32BE(data + 8, height);
+    data[12] = (unsigned char)channels;
+    data[QOI_HEADER_SIZE] = 0xc0;
+    data[sizeof(data) - 1] = 1;
+    
+    surface = s_Decode(data, sizeof(data), &hasAlphaChannel);
+    if ((surface != NULL) != good) {
+        s_Fail(name, (int)width, (int)height, channels);
+    }
+    if (surface != NULL) {
+        SDL_FreeSurface(surface);
+    }
+}
+
+int main(int argc, char **argv) {
+    static const int sizes[][2] = {
+        { 1, 1 }, { 2, 1 }, { 1, 7 }, { 7, 3 }, { 63, 2 }, { 64, 64 }, { 301, 5 }
+    };
+    int i;
+    
+    for (i = 0; i < (int)(sizeof(sizes) / sizeof(sizes[0])); ++i) {
+        s_CheckImage(sizes[i][0], sizes[i][1], 3);
+        s_CheckImage(sizes[i][0], sizes[i][1], 4);
+    }
+    
+    s_CheckHeader("good header", "qoif", 3, 2, 4, DXTRUE);
+    s_CheckHeader("bad magic", "qoiF", 1, 1, 4, DXFALSE);
+    s_CheckHeader("zero width", "qoif", 0, 1, 4, DXFALSE);
+    s_CheckHeader("zero height", "qoif", 1, 0, 4, DXFALSE);
+    s_CheckHeader("bad channels", "qoif", 1, 1, 5, DXFALSE);
+    s_CheckHeader("oversized", "qoif", 0x10000, 0x10000, 4, DXFALSE);
+    s_CheckHeader("oversized", "qoif", 0xffffffff, 0xffffffff, 3, DXFALSE);
+    s_CheckHeader("oversized", "qoif", 0xffffffff, 1, 4, DXFALSE);
+    
+    printf("%d failures\n", s_errors);
+    
+    return (s_errors == 0) ? 0 : 1;
+}
@@ -0,0 +1,162 @@
+/*
+  DxPortLib - A portability library for DxLib-based software.
+  Copyright (C) 2013 Patrick McCarthy <mauve@sandwich.net>
+  
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+  
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+ */
+
+/* Checks the soft image row kernels' SIMD code against their scalar
+ * code, over every alpha and opacity, and over widths and start
+ * offsets that aren't multiples of four. Returns nonzero on any
+ * difference. */
+
+#include "DxInternal.h"
+
+#include "SDL_main.h"
+
+#include <stdio.h>
+
+#define ROW_MAX 300
+
+static const int s_widths[] = {
+    1, 2, 3, 4, 5, 6, 7, 9, 13, 31, 33, 67, 256
+};
+
+static Uint32 s_seed = 1;
+
+static Uint32 s_Random() {
+    s_seed = s_seed * 1103515245 + 12345;
+    return (s_seed >> 16) | (s_seed << 16);
+}
+
+static int s_errors = 0;
+
+static void s_Compare(const char *name, const Uint32 *expected, const Uint32 *result,
+                      int n, int offset, int opacity) {
+    int i;
+    
+    for (i = 0; i < n; ++i) {
+        if (expected[i] != result[i]) {
+            printf("FAILED: %s, width %d, offset %d, opacity %d: "
+                   "pixel %d is %08x, not %08x\n",
+                   name, n, offset, opacity, i,
+                   (unsigned int)result[i], (unsigned int)expected[i]);
+            s_errors += 1;
+            return;
+        }
+    }
+}
+
+/* Rounded (s * a + d * (255 - a)) / 255, a channel at a time,
+ * to check the scalar code itself. */
+static Uint32 s_Blend(Uint32 s, Uint32 d, unsigned int opacity) {
+    unsigned int a = ((s >> 24) * opacity + 127) / 255;
+    Uint32 out = 0;
+    int shift;
+    
+    s |= 0xff000000;
+    for (shift = 0; shift < 32; shift += 8) {
+        unsigned int c = ((s >> shift) & 0xff) * a
+                         + ((d >> shift) & 0xff) * (255 - a);
+        out |= (Uint32)((c + 127) / 255) << shift;
+    }
+    
+    return out;
+}
+
+/* Every alpha is in src, and every opacity is tried,
+ * so all of their combinations are covered. */
+static void s_CheckBlend(int maxLevel) {
+    Uint32 src[ROW_MAX], dest[ROW_MAX], expected[ROW_MAX], result[ROW_MAX];
+    unsigned int opacity;
+    int level, i, w, offset;
+    
+    for (opacity = 0; opacity <= 255; ++opacity) {
+        for (i = 0; i < 256; ++i) {
+            src[i] = ((Uint32)i << 24) | (s_Random() & 0xffffff);
+            dest[i] = s_Random();
+        }
+        
+        PL_Surface_SetSIMDLevel(PL_SURFACE_SIMD_NONE);
+        SDL_memcpy(expected, dest, sizeof(dest));
+        PL_Surface_BlendRow(expected, src, 256, opacity);
+        
+        for (i = 0; i < 256; ++i) {
+            result[i] = s_Blend(src[i], dest[i], opacity);
+        }
+        s_Compare("BlendRow, scalar", result, expected, 256, 0, (int)opacity);
+        
+        for (level = PL_SURFACE_SIMD_BASE; level <= maxLevel; ++level) {
+            PL_Surface_SetSIMDLevel(level);
+            for (w = 0; w < (int)(sizeof(s_widths) / sizeof(s_widths[0])); ++w) {
+                int n = s_widths[w];
+                
+                for (offset = 0; offset < 4 && offset + n <= 256; ++offset) {
+                    SDL_memcpy(result, dest, sizeof(dest));
+                    PL_Surface_BlendRow(result + offset, src + offset, n, opacity);
+                    s_Compare("BlendRow", expected + offset, result + offset,
+                              n, offset, (int)opacity);
+                }
+            }
+        }
+    }
+}
+
+static void s_CheckRows(int maxLevel) {
+    Uint32 src[ROW_MAX], expected[ROW_MAX], result[ROW_MAX];
+    int level, i, w, offset;
+    
+    for (i = 0; i < ROW_MAX; ++i) {
+        src[i] = s_Random();
+    }
+    
+    for (level = PL_SURFACE_SIMD_BASE; level <= maxLevel; ++level) {
+        for (w = 0; w < (int)(sizeof(s_widths) / sizeof(s_widths[0])); ++w) {
+            int n = s_widths[w];
+            
+            for (offset = 0; offset < 4; ++offset) {
+                PL_Surface_SetSIMDLevel(PL_SURFACE_SIMD_NONE);
+                PL_Surface_OpaqueRow(expected, src + offset, n);
+                PL_Surface_SetSIMDLevel(level);
+                PL_Surface_OpaqueRow(result, src + offset, n);
+                s_Compare("OpaqueRow", expected, result, n, offset, -1);
+                
+                /* In place, as when an image loses its alpha channel. */
+                SDL_memcpy(result, src, sizeof(src));
+                PL_Surface_OpaqueRow(result + offset, result + offset, n);
+                s_Compare("OpaqueRow, in place", expected, result + offset, n, offset, -1);
+                
+                PL_Surface_SetSIMDLevel(PL_SURFACE_SIMD_NONE);
+                PL_Surface_SwapRedBlueRow(expected, src + offset, n);
+                PL_Surface_SetSIMDLevel(level);
+                PL_Surface_SwapRedBlueRow(result, src + offset, n);
+                s_Compare("SwapRedBlueRow", expected, result, n, offset, -1);
+                
+                PL_Surface_SetSIMDLevel(PL_SURFACE_SIMD_NONE);
+                SDL_memcpy(expected, src, sizeof(src));
+                PL_Surface_FillRow(expected + offset, n, 0x12345678);
+                PL_Surface_SetSIMDLevel(level);
+                SDL_memcpy(result, src, sizeof(src));
+                PL_Surface_FillRow(result + offset, n, 0x12345678);
+                s_Compare("FillRow", expected, result, ROW_MAX, offset, -1);
+            }
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    int maxLevel = PL_Surface_SetSIMDLevel(-1);
+    
+    s_CheckBlend(maxLevel);
+    s_CheckRows(maxLevel);
+    
+    printf("%d failures\n", s_errors);
+    
+    return (s_errors == 0) ? 0 : 1;
+}
@@ -0,0 +1,198 @@
+/*
+  DxPortLib - A portability library for DxLib-based software.
+  Copyright (C) 2013 Patrick McCarthy <mauve@sandwich.net>
+  
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+  
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+ */
+
+/* Checks Surface.c's SIMD kernels against its scalar code, then times
+ * them on a 2048x2048 surface. Returns nonzero if any output differs. */
+
+#include "DxInternal.h"
+
+#include "SDL_main.h"
+
+#include <stdio.h>
+
+#define BENCH_SIZE 2048
+#define BENCH_RUNS 20
+
+static const int s_widths[] = {
+    1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 32, 33, 63, 64, 65, 127, 129, 2047
+};
+
+static const char *s_levelNames[] = { "scalar", "SSE2/NEON", "AVX2" };
+
+static Uint32 s_seed = 1;
+
+static Uint32 s_Random() {
+    s_seed = s_seed * 1103515245 + 12345;
+    return s_seed >> 8;
+}
+
+static SDL_Surface *s_CreateSurface(int w, int h, int bytesPerPixel) {
+    switch (bytesPerPixel) {
+        case 1:
+            return SDL_CreateRGBSurface(SDL_SWSURFACE, w, h, 8, 0, 0, 0, 0);
+        case 2:
+            return SDL_CreateRGBSurface(SDL_SWSURFACE, w, h, 16,
+                                        0xf800, 0x07e0, 0x001f, 0);
+        case 3:
+            return SDL_CreateRGBSurface(SDL_SWSURFACE, w, h, 24,
+                                        0xff0000, 0x00ff00, 0x0000ff, 0);
+        default:
+            return SDL_CreateRGBSurface(SDL_SWSURFACE, w, h, 32,
+                                        0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000);
+    }
+}
+
+/* Fills the surface from a small set of colours, so colour keys match
+ * often, including runs of them. */
+static void s_Fill(SDL_Surface *surface) {
+    Uint8 *pixels = (Uint8 *)surface->pixels;
+    int size = surface->pitch * surface->h;
+    int i;
+    
+    for (i = 0; i < size; ++i) {
+        pixels[i] = (Uint8)((s_Random() & 3) * 0x55);
+    }
+}
+
+static SDL_Surface *s_Copy(SDL_Surface *surface) {
+    SDL_Surface *copy = s_CreateSurface(surface->w, surface->h,
+                                        surface->format->BytesPerPixel);
+    SDL_memcpy(copy->pixels, surface->pixels, (size_t)(surface->pitch * surface->h));
+    return copy;
+}
+
+static int s_Same(SDL_Surface *a, SDL_Surface *b) {
+    int rowSize = a->w * a->format->BytesPerPixel;
+    int y;
+    
+    for (y = 0; y < a->h; ++y) {
+        if (SDL_memcmp((Uint8 *)a->pixels + y * a->pitch,
+                       (Uint8 *)b->pixels + y * b->pitch, (size_t)rowSize) != 0) {
+            return DXFALSE;
+        }
+    }
+    
+    return DXTRUE;
+}
+
+/* Flips and colour keys a surface with each level's kernels,
+ * and compares them all with the scalar result. */
+static int s_Check(int w, int h, int bytesPerPixel, int maxLevel) {
+    SDL_Surface *src = s_CreateSurface(w, h, bytesPerPixel);
+    SDL_Surface *expected, *result;
+    Uint32 key = 0x55aaff00;
+    int expectedFound = DXFALSE;
+    int errors = 0;
+    int level;
+    
+    s_Fill(src);
+    
+    PL_Surface_SetSIMDLevel(PL_SURFACE_SIMD_NONE);
+    expected = s_Copy(src);
+    PL_Surface_FlipHorizontal(expected);
+    if (bytesPerPixel == 4) {
+        expectedFound = PL_Surface_ApplyColorKey(expected, key);
+    }
+    
+    for (level = PL_SURFACE_SIMD_BASE; level <= maxLevel; ++level) {
+        int found = DXFALSE;
+        
+        PL_Surface_SetSIMDLevel(level);
+        result = s_Copy(src);
+        PL_Surface_FlipHorizontal(result);
+        if (bytesPerPixel == 4) {
+            found = PL_Surface_ApplyColorKey(result, key);
+        }
+        
+        if (s_Same(expected, result) == DXFALSE || found != expectedFound) {
+            printf("FAILED: %s, %dx%d, %d bytes per pixel\n",
+                   s_levelNames[level], w, h, bytesPerPixel);
+            errors += 1;
+        }
+        
+        SDL_FreeSurface(result);
+        
+        /* Flipping twice has to give back the original. */
+        result = s_Copy(src);
+        PL_Surface_FlipHorizontal(result);
+        PL_Surface_FlipHorizontal(result);
+        if (s_Same(src, result) == DXFALSE) {
+            printf("FAILED: %s, %dx%d, %d bytes per pixel, flipped twice\n",
+                   s_levelNames[level], w, h, bytesPerPixel);
+            errors += 1;
+        }
+        SDL_FreeSurface(result);
+    }
+    
+    SDL_FreeSurface(expected);
+    SDL_FreeSurface(src);
+    
+    return errors;
+}
+
+static double s_Milliseconds(Uint64 start) {
+    return (double)(SDL_GetPerformanceCounter() - start) * 1000.0
+           / (double)SDL_GetPerformanceFrequency();
+}
+
+static void s_Benchmark(int maxLevel) {
+    SDL_Surface *surface = s_CreateSurface(BENCH_SIZE, BENCH_SIZE, 4);
+    int level, i;
+    
+    s_Fill(surface);
+    
+    printf("%dx%d, 32-bit, milliseconds per call:\n", BENCH_SIZE, BENCH_SIZE);
+    for (level = PL_SURFACE_SIMD_NONE; level <= maxLevel; ++level) {
+        double colorKeyTime, flipTime;
+        Uint64 start;
+        
+        PL_Surface_SetSIMDLevel(level);
+        
+        start = SDL_GetPerformanceCounter();
+        for (i = 0; i < BENCH_RUNS; ++i) {
+            PL_Surface_ApplyColorKey(surface, 0x55aaff00);
+        }
+        colorKeyTime = s_Milliseconds(start) / BENCH_RUNS;
+        
+        start = SDL_GetPerformanceCounter();
+        for (i = 0; i < BENCH_RUNS; ++i) {
+            PL_Surface_FlipHorizontal(surface);
+        }
+        flipTime = s_Milliseconds(start) / BENCH_RUNS;
+        
+        printf("  %-10s ApplyColorKey %8.3f  FlipHorizontal %8.3f\n",
+               s_levelNames[level], colorKeyTime, flipTime);
+    }
+    
+    SDL_FreeSurface(surface);
+}
+
+int main(int argc, char **argv) {
+    int maxLevel = PL_Surface_SetSIMDLevel(-1);
+    int errors = 0;
+    int bytesPerPixel, i, h;
+    
+    for (bytesPerPixel = 1; bytesPerPixel <= 4; ++bytesPerPixel) {
+        for (i = 0; i < (int)(sizeof(s_widths) / sizeof(s_widths[0])); ++i) {
+            for (h = 1; h <= 3; ++h) {
+                errors += s_Check(s_widths[i], h, bytesPerPixel, maxLevel);
+            }
+        }
+    }
+    
+    printf("Checked up to %s: %d failures\n", s_levelNames[maxLevel], errors);
+    
+    s_Benchmark(maxLevel);
+    
+    return (errors == 0) ? 0 : 1;
+}
@@ -0,0 +1,663 @@
+/*
+  DxPortLib - A portability library for DxLib-based software.
+  Copyright (C) 2013 Patrick McCarthy <mauve@sandwich.net>
+  
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+  
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+    
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required. 
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+ */
+
+/* dxatlaspack: packs a directory of PNGs into an atlas for EXT_LoadAtlas.
+ *
+ * usage: dxatlaspack [-s maxPageSize] [-p padding] [-z] output input_dir
+ *
+ * Each sprite is named after its PNG, without the extension.
+ * The file format is described in src/Atlas.c.
+ */
+
+/* This is a plain command line program, so SDL doesn't need to
+ * take over main. */
+#define SDL_MAIN_HANDLED
+
+#include "SDL.h"
+#include "SDL_image.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#  include <io.h>
+#else
+#  include <dirent.h>
+#endif
+
+#define ATLAS_HEADER_SIZE       16
+#define ATLAS_PAGE_SIZE         16
+#define ATLAS_SPRITE_SIZE       16
+#define ATLAS_VERSION           1
+
+#define ATLAS_FORMAT_ARGB8888   0
+
+#define ATLAS_COMPRESS_NONE     0
+#define ATLAS_COMPRESS_LZ       1
+
+#define ATLAS_FLAG_ALPHA        1
+
+#define MAX_PAGES               0xffff
+
+typedef struct Sprite {
+    char *name;
+    SDL_Surface *surface;
+    
+    int page;
+    int x;
+    int y;
+} Sprite;
+
+typedef struct Page {
+    int width;
+    int height;
+    int hasAlpha;
+    
+    unsigned char *data;
+    unsigned int dataSize;
+    int compression;
+} Page;
+
+static Sprite *s_sprites = NULL;
+static int s_spriteCount = 0;
+static int s_spriteCapacity = 0;
+
+static Page *s_pages = NULL;
+static int s_pageCount = 0;
+
+static int s_maxPageSize = 2048;
+static int s_padding = 1;
+static int s_compress = 0;
+
+/* ------------------------------------------------------------ LOADING */
+static int s_IsPNG(const char *filename) {
+    size_t len = strlen(filename);
+    
+    return len > 4 && SDL_strcasecmp(filename + len - 4, ".png") == 0;
+}
+
+static int s_AddSprite(const char *dir, const char *filename) {
+    Sprite *sprite;
+    SDL_Surface *surface, *converted;
+    char *path;
+    size_t len;
+    
+    len = strlen(dir) + strlen(filename) + 2;
+    path = (char *)malloc(len);
+    sprintf(path, "%s/%s", dir, filename);
+    
+    surface = IMG_Load(path);
+    if (surface == NULL) {
+        fprintf(stderr, "dxatlaspack: can't load %s: %s\n", path, IMG_GetError());
+        free(path);
+        return -1;
+    }
+    free(path);
+    
+    converted = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_ARGB8888, 0);
+    SDL_FreeSurface(surface);
+    if (converted == NULL) {
+        fprintf(stderr, "dxatlaspack: can't convert %s: %s\n", filename, SDL_GetError());
+        return -1;
+    }
+    
+    if (converted->w + s_padding > s_maxPageSize
+        || converted->h + s_padding > s_maxPageSize
+    ) {
+        fprintf(stderr, "dxatlaspack: %s is too big for a %dx%d page\n",
+                filename, s_maxPageSize, s_maxPageSize);
+        SDL_FreeSurface(converted);
+        return -1;
+    }
+    
+    if (s_spriteCount >= s_spriteCapacity) {
+        s_spriteCapacity = s_spriteCapacity ? s_spriteCapacity * 2 : 64;
+        s_sprites = (Sprite *)realloc(s_sprites, s_spriteCapacity * sizeof(Sprite));
+    }
+    
+    sprite = &s_sprites[s_spriteCount++];
+    len = strlen(filename) - 4;
+    sprite->name = (char *)malloc(len + 1);
+    memcpy(sprite->name, filename, len);
+    sprite->name[len] = '\0';
+    sprite->surface = converted;
+    sprite->page = -1;
+    sprite->x = 0;
+    sprite->y = 0;
+    
+    return 0;
+}
+
+static int s_LoadDirectory(const char *dir) {
+#ifdef _WIN32
+    struct _finddata_t info;
+    intptr_t find;
+    char *pattern = (char *)malloc(strlen(dir) + 3);
+    
+    sprintf(pattern, "%s/*", dir);
+    find = _findfirst(pattern, &info);
+    free(pattern);
+    if (find == -1) {
+        fprintf(stderr, "dxatlaspack: can't open directory %s\n", dir);
+        return -1;
+    }
+    
+    do {
+        if ((info.attrib & _A_SUBDIR) == 0 && s_IsPNG(info.name)) {
+            if (s_AddSprite(dir, info.name) < 0) {
+                _findclose(find);
+                return -1;
+            }
+        }
+    } while (_findnext(find, &info) == 0);
+    
+    _findclose(find);
+#else
+    DIR *d;
+    struct dirent *entry;
+    
+    d = opendir(dir);
+    if (d == NULL) {
+        fprintf(stderr, "dxatlaspack: can't open directory %s\n", dir);
+        return -1;
+    }
+    
+    while ((entry = readdir(d)) != NULL) {
+        if (entry->d_name[0] != '.' && s_IsPNG(entry->d_name)) {
+            if (s_AddSprite(dir, entry->d_name) < 0) {
+                closedir(d);
+                return -1;
+            }
+        }
+    }
+    
+    closedir(d);
+#endif
+    
+    return 0;
+}
+
+/* ------------------------------------------------------------ PACKING */
+static int s_CompareHeight(const void *a, const void *b) {
+    const Sprite *sa = (const Sprite *)a;
+    const Sprite *sb = (const Sprite *)b;
+    
+    if (sa->surface->h != sb->surface->h) {
+        return sb->surface->h - sa->surface->h;
+    }
+    return sb->surface->w - sa->surface->w;
+}
+
+static int s_CompareName(const void *a, const void *b) {
+    return strcmp(((const Sprite *)a)->name, ((const Sprite *)b)->name);
+}
+
+/* Simple shelf packing, tallest first. Good enough for sprite sheets,
+ * which are mostly made of similarly sized things. */
+static int s_Pack() {
+    int shelfX = 0, shelfY = 0, shelfHeight = 0;
+    int i;
+    
+    qsort(s_sprites, s_spriteCount, sizeof(Sprite), s_CompareHeight);
+    
+    s_pages = (Page *)calloc(1, sizeof(Page));
+    s_pageCount = 1;
+    
+    for (i = 0; i < s_spriteCount; ++i) {
+        Sprite *sprite = &s_sprites[i];
+        Page *page;
+        int w = sprite->surface->w + s_padding;
+        int h = sprite->surface->h + s_padding;
+        
+        if (shelfX + w > s_maxPageSize) {
+            shelfX = 0;
+            shelfY += shelfHeight;
+            shelfHeight = 0;
+        }
+        if (shelfY + h > s_maxPageSize) {
+            if (s_pageCount >= MAX_PAGES) {
+                fprintf(stderr, "dxatlaspack: too many pages\n");
+                return -1;
+            }
+            s_pages = (Page *)realloc(s_pages, (s_pageCount + 1) * sizeof(Page));
+            memset(&s_pages[s_pageCount], 0, sizeof(Page));
+            s_pageCount += 1;
+            shelfX = 0;
+            shelfY = 0;
+            shelfHeight = 0;
+        }
+        
+        sprite->page = s_pageCount - 1;
+        sprite->x = shelfX;
+        sprite->y = shelfY;
+        
+        page = &s_pages[sprite->page];
+        if (shelfX + sprite->surface->w > page->width) {
+            page->width = shelfX + sprite->surface->w;
+        }
+        if (shelfY + sprite->surface->h > page->height) {
+            page->height = shelfY + sprite->surface->h;
+        }
+        
+        shelfX += w;
+        if (h > shelfHeight) {
+            shelfHeight = h;
+        }
+    }
+    
+    return 0;
+}
+
+/* Copies the sprites onto their pages. Padding is left transparent. */
+static void s_RenderPages() {
+    int i, x, y;
+    
+    for (i = 0; i < s_pageCount; ++i) {
+        Page *page = &s_pages[i];
+        page->dataSize = (unsigned int)page->width * page->height * 4;
+        page->data = (unsigned char *)calloc(1, page->dataSize);
+        page->compression = ATLAS_COMPRESS_NONE;
+    }
+    
+    for (i = 0; i < s_spriteCount; ++i) {
+        Sprite *sprite = &s_sprites[i];
+        SDL_Surface *surface = sprite->surface;
+        Page *page = &s_pages[sprite->page];
+        
+        SDL_LockSurface(surface);
+        for (y = 0; y < surface->h; ++y) {
+            const Uint32 *src = (const Uint32 *)
+                ((const unsigned char *)surface->pixels + y * surface->pitch);
+            unsigned char *dest = page->data
+                + ((sprite->y + y) * page->width + sprite->x) * 4;
+            
+            for (x = 0; x < surface->w; ++x) {
+                Uint32 c = src[x];
+                
+                /* Always stored little-endian. */
+                dest[0] = (unsigned char)(c);
+                dest[1] = (unsigned char)(c >> 8);
+                dest[2] = (unsigned char)(c >> 16);
+                dest[3] = (unsigned char)(c >> 24);
+                dest += 4;
+                
+                if ((c >> 24) != 0xff) {
+                    page->hasAlpha = 1;
+                }
+            }
+        }
+        SDL_UnlockSurface(surface);
+    }
+}
+
+/* ------------------------------------------------------------ COMPRESSION */
+/* Compresses into DxLib's LZ format, which is what DXA_Decompress reads.
+ * Matches are found with hash chains over a 1MB window, and taken
+ * greedily, which is plenty for pixel data. */
+#define LZ_HASH_BITS            16
+#define LZ_WINDOW_BITS          20
+#define LZ_WINDOW_MASK          ((1 << LZ_WINDOW_BITS) - 1)
+#define LZ_MAX_CHAIN            32
+#define LZ_MIN_MATCH            4
+#define LZ_MAX_MATCH            (LZ_MIN_MATCH + 0x1fff)
+
+static unsigned int s_Hash(const unsigned char *p) {
+    Uint32 v = (Uint32)p[0] | ((Uint32)p[1] << 8)
+               | ((Uint32)p[2] << 16) | ((Uint32)p[3] << 24);
+    
+    return (v * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+static unsigned char *s_EmitMatch(unsigned char *dest, unsigned char code,
+                                  unsigned int length, unsigned int distance) {
+    unsigned int count = length - LZ_MIN_MATCH;
+    unsigned int index = distance - 1;
+    unsigned int control;
+    int indexBytes;
+    
+    control = (count & 0x1f) << 3;
+    if (count > 0x1f) {
+        control |= 4;
+    }
+    if (index <= 0xff) {
+        indexBytes = 1;
+    } else if (index <= 0xffff) {
+        control |= 1;
+        indexBytes = 2;
+    } else {
+        control |= 2;
+        indexBytes = 3;
+    }
+    
+    /* The code value itself is skipped over. */
+    *dest++ = code;
+    *dest++ = (unsigned char)(control >= code ? control + 1 : control);
+    if (count > 0x1f) {
+        *dest++ = (unsigned char)(count >> 5);
+    }
+    while (indexBytes-- > 0) {
+        *dest++ = (unsigned char)index;
+        index >>= 8;
+    }
+    
+    return dest;
+}
+
+/* Returns the compressed size, including the header.
+ * dest needs room for srcSize + srcSize / 128 + 16 bytes. */
+static unsigned int s_Compress(const unsigned char *src, unsigned int srcSize,
+                               unsigned char *dest) {
+    unsigned int counts[256];
+    int *head, *chain;
+    unsigned char *out = dest + 9;
+    unsigned char code;
+    unsigned int pos, i;
+    
+    /* The least used byte becomes the code, so it needs escaping
+     * the least often. */
+    memset(counts, 0, sizeof(counts));
+    for (i = 0; i < srcSize; ++i) {
+        counts[src[i]] += 1;
+    }
+    code = 0;
+    for (i = 1; i < 256; ++i) {
+        if (counts[i] < counts[code]) {
+            code = (unsigned char)i;
+        }
+    }
+    
+    head = (int *)malloc((1 << LZ_HASH_BITS) * sizeof(int));
+    chain = (int *)malloc((1 << LZ_WINDOW_BITS) * sizeof(int));
+    for (i = 0; i < (1 << LZ_HASH_BITS); ++i) {
+        head[i] = -1;
+    }
+    
+    pos = 0;
+    while (pos < srcSize) {
+        unsigned int bestLength = 0;
+        unsigned int bestDistance = 0;
+        unsigned int cost;
+        
+        if (pos + LZ_MIN_MATCH <= srcSize) {
+            unsigned int maxLength = srcSize - pos;
+            int candidate = head[s_Hash(src + pos)];
+            int tries = LZ_MAX_CHAIN;
+            
+            if (maxLength > LZ_MAX_MATCH) {
+                maxLength = LZ_MAX_MATCH;
+            }
+            
+            while (candidate >= 0 && tries-- > 0
+                   && pos - (unsigned int)candidate <= LZ_WINDOW_MASK) {
+                const unsigned char *a = src + candidate;
+                const unsigned char *b = src + pos;
+                unsigned int length = 0;
+                
+                while (length < maxLength && a[length] == b[length]) {
+                    length += 1;
+                }
+                if (length > bestLength) {
+                    bestLength = length;
+                    bestDistance = pos - (unsigned int)candidate;
+                    if (length == maxLength) {
+                        break;
+                    }
+                }
+                
+                candidate = chain[candidate & LZ_WINDOW_MASK];
+            }
+        }
+        
+        /* Only worth it if it's shorter than the literals. */
+        cost = 2 + (bestLength - LZ_MIN_MATCH > 0x1f ? 1 : 0)
+               + (bestDistance <= 0x100 ? 1 : (bestDistance <= 0x10000 ? 2 : 3));
+        if (bestLength < LZ_MIN_MATCH || bestLength <= cost) {
+            bestLength = 1;
+            if (src[pos] == code) {
+                *out++ = code;
+            }
+            *out++ = src[pos];
+        } else {
+            out = s_EmitMatch(out, code, bestLength, bestDistance);
+        }
+        
+        /* Add every position covered to the hash chains. */
+        for (i = 0; i < bestLength; ++i, ++pos) {
+            if (pos + LZ_MIN_MATCH <= srcSize) {
+                unsigned int hash = s_Hash(src + pos);
+                chain[pos & LZ_WINDOW_MASK] = head[hash];
+                head[hash] = (int)pos;
+            }
+        }
+    }
+    
+    free(head);
+    free(chain);
+    
+    /* Header: decompressed size, compressed size without the header,
+     * then the code. */
+    i = (unsigned int)(out - dest) - 9;
+    dest[0] = (unsigned char)(srcSize);
+    dest[1] = (unsigned char)(srcSize >> 8);
+    dest[2] = (unsigned char)(srcSize >> 16);
+    dest[3] = (unsigned char)(srcSize >> 24);
+    dest[4] = (unsigned char)(i);
+    dest[5] = (unsigned char)(i >> 8);
+    dest[6] = (unsigned char)(i >> 16);
+    dest[7] = (unsigned char)(i >> 24);
+    dest[8] = code;
+    
+    return i + 9;
+}
+
+static void s_CompressPages() {
+    int i;
+    
+    for (i = 0; i < s_pageCount; ++i) {
+        Page *page = &s_pages[i];
+        unsigned char *compressed;
+        unsigned int size;
+        
+        compressed = (unsigned char *)malloc(page->dataSize + page->dataSize / 128 + 16);
+        size = s_Compress(page->data, page->dataSize, compressed);
+        
+        /* Keep it raw if compression doesn't buy anything. */
+        if (size < page->dataSize) {
+            free(page->data);
+            page->data = compressed;
+            page->dataSize = size;
+            page->compression = ATLAS_COMPRESS_LZ;
+        } else {
+            free(compressed);
+        }
+    }
+}
+
+/* ------------------------------------------------------------ WRITING */
+static void s_Write16(FILE *f, unsigned int v) {
+    fputc((int)(v & 0xff), f);
+    fputc((int)((v >> 8) & 0xff), f);
+}
+static void s_Write32(FILE *f, unsigned int v) {
+    s_Write16(f, v & 0xffff);
+    s_Write16(f, (v >> 16) & 0xffff);
+}
+
+static int s_WriteAtlas(const char *filename) {
+    FILE *f;
+    unsigned int nameTableSize = 0;
+    unsigned int offset;
+    int i;
+    
+    for (i = 0; i < s_spriteCount; ++i) {
+        nameTableSize += (unsigned int)strlen(s_sprites[i].name) + 1;
+    }
+    
+    f = fopen(filename, "wb");
+    if (f == NULL) {
+        fprintf(stderr, "dxatlaspack: can't write %s\n", filename);
+        return -1;
+    }
+    
+    fwrite("DXAT", 1, 4, f);
+    s_Write16(f, ATLAS_VERSION);
+    s_Write16(f, (unsigned int)s_pageCount);
+    s_Write32(f, (unsigned int)s_spriteCount);
+    s_Write32(f, nameTableSize);
+    
+    /* Page data starts 16-byte aligned, so raw pages can be used
+     * right where they are after loading. */
+    offset = ATLAS_HEADER_SIZE + s_pageCount * ATLAS_PAGE_SIZE
+             + s_spriteCount * ATLAS_SPRITE_SIZE + nameTableSize;
+    offset = (offset + 15) & ~15u;
+    
+    for (i = 0; i < s_pageCount; ++i) {
+        Page *page = &s_pages[i];
+        
+        s_Write16(f, (unsigned int)page->width);
+        s_Write16(f, (unsigned int)page->height);
+        fputc(ATLAS_FORMAT_ARGB8888, f);
+        fputc(page->compression, f);
+        fputc(page->hasAlpha ? ATLAS_FLAG_ALPHA : 0, f);
+        fputc(0, f);
+        s_Write32(f, offset);
+        s_Write32(f, page->dataSize);
+        
+        offset = (offset + page->dataSize + 15) & ~15u;
+    }
+    
+    offset = 0;
+    for (i = 0; i < s_spriteCount; ++i) {
+        Sprite *sprite = &s_sprites[i];
+        
+        s_Write16(f, (unsigned int)sprite->page);
+        s_Write16(f, (unsigned int)sprite->x);
+        s_Write16(f, (unsigned int)sprite->y);
+        s_Write16(f, (unsigned int)sprite->surface->w);
+        s_Write16(f, (unsigned int)sprite->surface->h);
+        s_Write16(f, 0);
+        s_Write32(f, offset);
+        
+        offset += (unsigned int)strlen(sprite->name) + 1;
+    }
+    
+    for (i = 0; i < s_spriteCount; ++i) {
+        fwrite(s_sprites[i].name, 1, strlen(s_sprites[i].name) + 1, f);
+    }
+    
+    for (i = 0; i < s_pageCount; ++i) {
+        while (ftell(f) & 15) {
+            fputc(0, f);
+        }
+        fwrite(s_pages[i].data, 1, s_pages[i].dataSize, f);
+    }
+    
+    if (ferror(f)) {
+        fprintf(stderr, "dxatlaspack: error writing %s\n", filename);
+        fclose(f);
+        return -1;
+    }
+    
+    fclose(f);
+    
+    return 0;
+}
+
+/* ------------------------------------------------------------ MAIN */
+static void s_Usage() {
+    fprintf(stderr,
+            "usage: dxatlaspack [-s maxPageSize] [-p padding] [-z] output input_dir\n"
+            "  -s  largest page width and height, default 2048\n"
+            "  -p  empty pixels between sprites, default 1\n"
+            "  -z  compress pages\n");
+}
+
+int main(int argc, char **argv) {
+    const char *output = NULL;
+    const char *input = NULL;
+    int i;
+    
+    for (i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            s_maxPageSize = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+            s_padding = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-z") == 0) {
+            s_compress = 1;
+        } else if (argv[i][0] == '-') {
+            s_Usage();
+            return 1;
+        } else if (output == NULL) {
+            output = argv[i];
+        } else if (input == NULL) {
+            input = argv[i];
+        } else {
+            s_Usage();
+            return 1;
+        }
+    }
+    
+    if (output == NULL || input == NULL
+        || s_maxPageSize <= 0 || s_maxPageSize > 0xffff || s_padding < 0
+    ) {
+        s_Usage();
+        return 1;
+    }
+    
+    IMG_Init(IMG_INIT_PNG);
+    
+    if (s_LoadDirectory(input) < 0) {
+        return 1;
+    }
+    if (s_spriteCount == 0) {
+        fprintf(stderr, "dxatlaspack: no PNGs in %s\n", input);
+        return 1;
+    }
+    
+    if (s_Pack() < 0) {
+        return 1;
+    }
+    s_RenderPages();
+    if (s_compress) {
+        s_CompressPages();
+    }
+    
+    /* EXT_GetAtlasGraph binary searches by name. */
+    qsort(s_sprites, s_spriteCount, sizeof(Sprite), s_CompareName);
+    for (i = 1; i < s_spriteCount; ++i) {
+        if (strcmp(s_sprites[i - 1].name, s_sprites[i].name) == 0) {
+            fprintf(stderr, "dxatlaspack: more than one sprite named %s\n",
+                    s_sprites[i].name);
+            return 1;
+        }
+    }
+    
+    if (s_WriteAtlas(output) < 0) {
+        return 1;
+    }
+    
+    printf("dxatlaspack: %d sprites on %d pages\n", s_spriteCount, s_pageCount);
+    
+    IMG_Quit();
+    
+    return 0;
+}
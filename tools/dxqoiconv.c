@@ -0,0 +1,179 @@
+/*
+  DxPortLib - A portability library for DxLib-based software.
+  Copyright (C) 2013 Patrick McCarthy <mauve@sandwich.net>
+  
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+  
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+    
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required. 
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+ */
+
+/* dxqoiconv: converts images to QOI, which LoadGraph decodes itself,
+ * much faster than it can decode PNG.
+ *
+ * usage: dxqoiconv [-o output] input...
+ *
+ * Without -o, each input is written next to itself, with its
+ * extension changed to .qoi. -o only works with a single input.
+ * Anything SDL2_image can load can be converted. Images without
+ * alpha are written with 3 channels, so LoadGraph's transparent
+ * color still works on them.
+ */
+
+/* This is a plain command line program, so SDL doesn't need to
+ * take over main. */
+#define SDL_MAIN_HANDLED
+
+#include "SDL.h"
+#include "SDL_image.h"
+
+#include "qoienc.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int s_HasAlpha(SDL_Surface *surface) {
+    Uint32 colorKey;
+    
+    return (surface->format->Amask != 0
+            || SDL_GetColorKey(surface, &colorKey) == 0);
+}
+
+static int s_Convert(const char *input, const char *output) {
+    SDL_Surface *source, *surface;
+    unsigned char *data;
+    unsigned int size;
+    int channels;
+    FILE *f;
+    
+    source = IMG_Load(input);
+    if (source == NULL) {
+        fprintf(stderr, "dxqoiconv: could not load %s: %s\n", input, IMG_GetError());
+        return -1;
+    }
+    
+    channels = s_HasAlpha(source) ? 4 : 3;
+    
+    /* Blitting, rather than converting, turns a color key into alpha. */
+    surface = SDL_CreateRGBSurface(0, source->w, source->h, 32,
+                                   0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000);
+    if (surface == NULL) {
+        fprintf(stderr, "dxqoiconv: out of memory\n");
+        SDL_FreeSurface(source);
+        return -1;
+    }
+    SDL_FillRect(surface, NULL, 0);
+    SDL_SetSurfaceBlendMode(source, SDL_BLENDMODE_NONE);
+    SDL_BlitSurface(source, NULL, surface, NULL);
+    SDL_FreeSurface(source);
+    
+    data = (unsigned char *)malloc(QOI_ENCODED_SIZE_MAX(surface->w, surface->h));
+    if (data == NULL) {
+        fprintf(stderr, "dxqoiconv: out of memory\n");
+        SDL_FreeSurface(surface);
+        return -1;
+    }
+    
+    size = QOI_Encode((const Uint32 *)surface->pixels, surface->w, surface->h,
+                      channels, data);
+    SDL_FreeSurface(surface);
+    
+    f = fopen(output, "wb");
+    if (f == NULL || fwrite(data, size, 1, f) != 1) {
+        fprintf(stderr, "dxqoiconv: could not write %s\n", output);
+        if (f != NULL) {
+            fclose(f);
+        }
+        free(data);
+        return -1;
+    }
+    fclose(f);
+    free(data);
+    
+    printf("dxqoiconv: %s -> %s\n", input, output);
+    
+    return 0;
+}
+
+/* Swaps the extension for .qoi, or adds one if there isn't one. */
+static char *s_OutputName(const char *input) {
+    const char *dot = strrchr(input, '.');
+    const char *slash = strrchr(input, '/');
+    const char *backslash = strrchr(input, '\\');
+    size_t len = strlen(input);
+    char *output;
+    
+    if (backslash > slash) {
+        slash = backslash;
+    }
+    if (dot != NULL && (slash == NULL || dot > slash)) {
+        len = (size_t)(dot - input);
+    }
+    
+    output = (char *)malloc(len + 5);
+    if (output != NULL) {
+        memcpy(output, input, len);
+        memcpy(output + len, ".qoi", 5);
+    }
+    
+    return output;
+}
+
+static void s_Usage() {
+    fprintf(stderr, "usage: dxqoiconv [-o output] input...\n");
+}
+
+int main(int argc, char **argv) {
+    const char *output = NULL;
+    int firstInput = 0;
+    int failed = 0;
+    int i;
+    
+    for (i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            output = argv[++i];
+        } else if (argv[i][0] == '-') {
+            s_Usage();
+            return 1;
+        } else {
+            firstInput = i;
+            break;
+        }
+    }
+    
+    if (firstInput == 0 || (output != NULL && firstInput != argc - 1)) {
+        s_Usage();
+        return 1;
+    }
+    
+    IMG_Init(IMG_INIT_JPG | IMG_INIT_PNG | IMG_INIT_TIF | IMG_INIT_WEBP);
+    
+    if (output != NULL) {
+        failed = (s_Convert(argv[firstInput], output) < 0);
+    } else {
+        for (i = firstInput; i < argc; ++i) {
+            char *name = s_OutputName(argv[i]);
+            
+            if (name == NULL || s_Convert(argv[i], name) < 0) {
+                failed = 1;
+            }
+            free(name);
+        }
+    }
+    
+    IMG_Quit();
+    
+    return failed;
+}
@@ -0,0 +1,135 @@
+/*
+  DxPortLib - A portability library for DxLib-based software.
+  Copyright (C) 2013 Patrick McCarthy <mauve@sandwich.net>
+  
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+  
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+  
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required. 
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include "qoienc.h"
+
+#include <string.h>
+
+#define QOI_OP_INDEX            0x00
+#define QOI_OP_DIFF             0x40
+#define QOI_OP_LUMA             0x80
+#define QOI_OP_RUN              0xc0
+#define QOI_OP_RGB              0xfe
+#define QOI_OP_RGBA             0xff
+
+#define QOI_RUN_MAX             62
+
+static unsigned char *s_Write32BE(unsigned char *dest, Uint32 v) {
+    dest[0] = (unsigned char)(v >> 24);
+    dest[1] = (unsigned char)(v >> 16);
+    dest[2] = (unsigned char)(v >> 8);
+    dest[3] = (unsigned char)v;
+    return dest + 4;
+}
+
+static unsigned int s_Hash(Uint32 pixel) {
+    unsigned int a = pixel >> 24;
+    unsigned int r = (pixel >> 16) & 0xff;
+    unsigned int g = (pixel >> 8) & 0xff;
+    unsigned int b = pixel & 0xff;
+    
+    return (r * 3 + g * 5 + b * 7 + a * 11) & 63;
+}
+
+unsigned int QOI_Encode(const Uint32 *pixels, int width, int height,
+                        int channels, unsigned char *dest) {
+    unsigned char *p = dest;
+    Uint32 index[64];
+    Uint32 prev = 0xff000000;
+    unsigned int pixelCount = (unsigned int)width * (unsigned int)height;
+    unsigned int i;
+    int run = 0;
+    
+    memcpy(p, "qoif", 4);
+    p = s_Write32BE(p + 4, (Uint32)width);
+    p = s_Write32BE(p, (Uint32)height);
+    *p++ = (unsigned char)channels;
+    *p++ = 0; /* sRGB with linear alpha */
+    
+    memset(index, 0, sizeof(index));
+    
+    for (i = 0; i < pixelCount; ++i) {
+        Uint32 pixel = pixels[i];
+        unsigned int hash;
+        
+        if (channels == 3) {
+            pixel |= 0xff000000;
+        }
+        
+        if (pixel == prev) {
+            run += 1;
+            if (run == QOI_RUN_MAX || i == pixelCount - 1) {
+                *p++ = (unsigned char)(QOI_OP_RUN | (run - 1));
+                run = 0;
+            }
+            continue;
+        }
+        
+        if (run > 0) {
+            *p++ = (unsigned char)(QOI_OP_RUN | (run - 1));
+            run = 0;
+        }
+        
+        hash = s_Hash(pixel);
+        if (index[hash] == pixel) {
+            *p++ = (unsigned char)(QOI_OP_INDEX | hash);
+        } else if ((pixel >> 24) == (prev >> 24)) {
+            int vr = (signed char)(((pixel >> 16) & 0xff) - ((prev >> 16) & 0xff));
+            int vg = (signed char)(((pixel >> 8) & 0xff) - ((prev >> 8) & 0xff));
+            int vb = (signed char)((pixel & 0xff) - (prev & 0xff));
+            int vgr = vr - vg;
+            int vgb = vb - vg;
+            
+            index[hash] = pixel;
+            
+            if (vr > -3 && vr < 2 && vg > -3 && vg < 2 && vb > -3 && vb < 2) {
+                *p++ = (unsigned char)(QOI_OP_DIFF | (vr + 2) << 4
+                                       | (vg + 2) << 2 | (vb + 2));
+            } else if (vgr > -9 && vgr < 8 && vg > -33 && vg < 32
+                       && vgb > -9 && vgb < 8
+            ) {
+                *p++ = (unsigned char)(QOI_OP_LUMA | (vg + 32));
+                *p++ = (unsigned char)((vgr + 8) << 4 | (vgb + 8));
+            } else {
+                *p++ = QOI_OP_RGB;
+                *p++ = (unsigned char)(pixel >> 16);
+                *p++ = (unsigned char)(pixel >> 8);
+                *p++ = (unsigned char)pixel;
+            }
+        } else {
+            index[hash] = pixel;
+            
+            *p++ = QOI_OP_RGBA;
+            *p++ = (unsigned char)(pixel >> 16);
+            *p++ = (unsigned char)(pixel >> 8);
+            *p++ = (unsigned char)pixel;
+            *p++ = (unsigned char)(pixel >> 24);
+        }
+        
+        prev = pixel;
+    }
+    
+    memset(p, 0, QOI_PADDING_SIZE - 1);
+    p[QOI_PADDING_SIZE - 1] = 1;
+    p += QOI_PADDING_SIZE;
+    
+    return (unsigned int)(p - dest);
+}
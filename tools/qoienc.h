@@ -0,0 +1,42 @@
+/*
+  DxPortLib - A portability library for DxLib-based software.
+  Copyright (C) 2013 Patrick McCarthy <mauve@sandwich.net>
+  
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+  
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+  
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required. 
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+ */
+
+#ifndef DX_QOIENC_H_HEADER
+#define DX_QOIENC_H_HEADER
+
+#include "SDL.h"
+
+/* QOI encoder, shared by dxqoiconv and the QOI test. */
+
+#define QOI_HEADER_SIZE         14
+#define QOI_PADDING_SIZE        8
+
+/* The most an image can take up, encoded. */
+#define QOI_ENCODED_SIZE_MAX(width, height) \
+    ((size_t)(width) * (size_t)(height) * 5 + QOI_HEADER_SIZE + QOI_PADDING_SIZE)
+
+/* Encodes ARGB8888 pixels, with pitch width * 4, into dest, which must
+ * have room for QOI_ENCODED_SIZE_MAX bytes. Images with 3 channels have
+ * their alpha ignored. Returns the encoded size. */
+extern unsigned int QOI_Encode(const Uint32 *pixels, int width, int height,
+                               int channels, unsigned char *dest);
+
+#endif /* #ifndef DX_QOIENC_H_HEADER */